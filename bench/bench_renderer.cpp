@@ -0,0 +1,229 @@
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QGuiApplication>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QOffscreenSurface>
+#include <QOpenGLContext>
+#include <QOpenGLExtraFunctions>
+#include <QOpenGLFramebufferObject>
+#include <iostream>
+
+#include "FrameProfiler.hpp"
+#include "OpenGL3DViewport.hpp"
+
+// Headless renderer benchmark: drives OpenGL3DRenderer into an offscreen framebuffer object
+// and reports frame rate and per-pass timings as JSON. Unless QT_QPA_PLATFORM says
+// otherwise, it uses the offscreen platform (GL through GLX) when an X display is set, and
+// an EGL surfaceless context (eglfs with EGL_PLATFORM=surfaceless, Mesa) when none is.
+
+struct BenchConfig {
+    int shape;
+    QSize size;
+    int samples;
+    int markers;
+};
+
+static QList<int> parseIntList(const QString& value) {
+    QList<int> values;
+    for (const QString& item : value.split(',', Qt::SkipEmptyParts)) {
+        bool ok = false;
+        int number = item.trimmed().toInt(&ok);
+        if (ok) {
+            values.append(number);
+        }
+    }
+    return values;
+}
+
+static QList<QSize> parseSizeList(const QString& value) {
+    QList<QSize> sizes;
+    for (const QString& item : value.split(',', Qt::SkipEmptyParts)) {
+        QStringList parts = item.trimmed().split('x');
+        if (parts.size() == 2 && parts[0].toInt() > 0 && parts[1].toInt() > 0) {
+            sizes.append(QSize(parts[0].toInt(), parts[1].toInt()));
+        }
+    }
+    return sizes;
+}
+
+static QJsonObject runConfig(OpenGL3DRenderer& renderer, OpenGL3DViewport& viewport,
+                             QOpenGLContext& context, const BenchConfig& config, int warmupFrames,
+                             int frames) {
+    QOpenGLExtraFunctions* gl = context.extraFunctions();
+
+    // Same state path as the scene graph: scene properties reach the renderer through the
+    // published RenderState, render settings in synchronize()
+    viewport.setCurrentShape(config.shape);
+    viewport.setSampleCount(config.samples);
+    renderer.setSyntheticMarkerCount(config.markers);
+    renderer.synchronize(&viewport);
+
+    QOpenGLFramebufferObject* fbo = renderer.createFramebufferObject(config.size);
+
+    // Multisampled framebuffers are resolved for display every frame, as in the GUI
+    QOpenGLFramebufferObject* resolveFbo = nullptr;
+    if (config.samples > 0) {
+        resolveFbo = new QOpenGLFramebufferObject(config.size);
+    }
+
+    auto renderFrame = [&]() {
+        fbo->bind();
+        gl->glViewport(0, 0, config.size.width(), config.size.height());
+        renderer.render();
+        if (resolveFbo) {
+            QOpenGLFramebufferObject::blitFramebuffer(resolveFbo, fbo);
+        }
+        gl->glFlush();
+    };
+
+    for (int i = 0; i < warmupFrames; ++i) {
+        renderFrame();
+    }
+    renderer.takeFrameSamples(true);
+
+    FrameStatistics statistics(frames);
+    QElapsedTimer timer;
+    timer.start();
+    for (int i = 0; i < frames; ++i) {
+        renderFrame();
+        statistics.append(renderer.takeFrameSamples());
+    }
+    gl->glFinish();
+    double elapsedMs = timer.nsecsElapsed() / 1.0e6;
+    statistics.append(renderer.takeFrameSamples(true));
+
+    QOpenGLFramebufferObject::bindDefault();
+    delete resolveFbo;
+    delete fbo;
+
+    QJsonObject result;
+    result["shape"] = config.shape;
+    result["width"] = config.size.width();
+    result["height"] = config.size.height();
+    result["msaa"] = config.samples;
+    result["markers"] = config.markers;
+    result["frames"] = frames;
+    result["elapsedMs"] = elapsedMs;
+    result["framesPerSecond"] = elapsedMs > 0.0 ? frames * 1000.0 / elapsedMs : 0.0;
+    result["timings"] = QJsonObject::fromVariantMap(statistics.summary());
+    return result;
+}
+
+int main(int argc, char* argv[]) {
+    // Without an explicit platform, run without a window system. The offscreen platform
+    // only gets OpenGL through GLX, so display-less nodes use EGL without any surface.
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        if (!qEnvironmentVariableIsEmpty("DISPLAY")) {
+            qputenv("QT_QPA_PLATFORM", "offscreen");
+        } else {
+            qputenv("QT_QPA_PLATFORM", "eglfs");
+            if (qEnvironmentVariableIsEmpty("EGL_PLATFORM")) {
+                qputenv("EGL_PLATFORM", "surfaceless");
+            }
+            // Generic EGL integration instead of KMS, which needs a display controller
+            if (qEnvironmentVariableIsEmpty("QT_QPA_EGLFS_INTEGRATION")) {
+                qputenv("QT_QPA_EGLFS_INTEGRATION", "none");
+            }
+        }
+    }
+
+    QGuiApplication app(argc, argv);
+    app.setApplicationName("bench_renderer");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Headless OpenGL3DRenderer benchmark");
+    parser.addHelpOption();
+    QCommandLineOption framesOption("frames", "Measured frames per configuration.", "count",
+                                    "300");
+    QCommandLineOption warmupOption("warmup", "Unmeasured frames per configuration.", "count",
+                                    "30");
+    QCommandLineOption shapesOption("shapes", "Shapes to render (1-4).", "list", "1,2,3,4");
+    QCommandLineOption sizesOption("sizes", "Framebuffer sizes.", "WxH,...", "1280x720,1920x1080");
+    QCommandLineOption msaaOption("msaa", "MSAA sample counts.", "list", "0,4");
+    QCommandLineOption markersOption("markers", "Marker counts per model (0 = shape corners).",
+                                     "list", "0,1000");
+    QCommandLineOption outputOption("output", "Write the JSON report to a file.", "file");
+    parser.addOptions({framesOption, warmupOption, shapesOption, sizesOption, msaaOption,
+                       markersOption, outputOption});
+    parser.process(app);
+
+    const int frames = qMax(1, parser.value(framesOption).toInt());
+    const int warmupFrames = qMax(0, parser.value(warmupOption).toInt());
+    const QList<int> shapes = parseIntList(parser.value(shapesOption));
+    const QList<QSize> sizes = parseSizeList(parser.value(sizesOption));
+    const QList<int> sampleCounts = parseIntList(parser.value(msaaOption));
+    const QList<int> markerCounts = parseIntList(parser.value(markersOption));
+
+    // Core profile context matching the renderer's GLSL 330 shaders
+    QSurfaceFormat format;
+    format.setVersion(3, 3);
+    format.setProfile(QSurfaceFormat::CoreProfile);
+    format.setDepthBufferSize(24);
+    format.setStencilBufferSize(8);
+
+    QOpenGLContext context;
+    context.setFormat(format);
+    if (!context.create()) {
+        std::cerr << "Failed to create OpenGL context" << std::endl;
+        return 1;
+    }
+
+    QOffscreenSurface surface;
+    surface.setFormat(context.format());
+    surface.create();
+    if (!surface.isValid() || !context.makeCurrent(&surface)) {
+        std::cerr << "Failed to make offscreen OpenGL context current" << std::endl;
+        return 1;
+    }
+
+    QOpenGLFunctions* gl = context.functions();
+    QJsonObject report;
+    report["vendor"] = reinterpret_cast<const char*>(gl->glGetString(GL_VENDOR));
+    report["renderer"] = reinterpret_cast<const char*>(gl->glGetString(GL_RENDERER));
+    report["version"] = reinterpret_cast<const char*>(gl->glGetString(GL_VERSION));
+
+    QJsonArray results;
+    {
+        // The viewport item is only used as the synchronize() source, it is never shown
+        OpenGL3DViewport viewport;
+        OpenGL3DRenderer renderer;
+
+        for (int shape : shapes) {
+            for (const QSize& size : sizes) {
+                for (int samples : sampleCounts) {
+                    for (int markers : markerCounts) {
+                        BenchConfig config = {shape, size, samples, markers};
+                        QJsonObject result =
+                            runConfig(renderer, viewport, context, config, warmupFrames, frames);
+                        std::cerr << "shape " << shape << " " << size.width() << "x"
+                                  << size.height() << " msaa " << samples << " markers "
+                                  << markers << ": " << result["framesPerSecond"].toDouble()
+                                  << " fps" << std::endl;
+                        results.append(result);
+                    }
+                }
+            }
+        }
+
+        // Renderer resources are released while the context is still current
+    }
+    report["results"] = results;
+    context.doneCurrent();
+
+    QByteArray json = QJsonDocument(report).toJson();
+    if (parser.isSet(outputOption)) {
+        QFile file(parser.value(outputOption));
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            std::cerr << "Failed to open output file" << std::endl;
+            return 1;
+        }
+        file.write(json);
+    } else {
+        std::cout << json.constData();
+    }
+
+    return 0;
+}
@@ -0,0 +1,45 @@
+#include "Colormap.hpp"
+
+#include <QtGlobal>
+
+QVector<QVector3D> Colormap::sample(Name name, int count) {
+    QVector<QVector3D> colorStops = stops(name);
+    QVector<QVector3D> colors;
+    colors.reserve(count);
+
+    int segments = colorStops.size() - 1;
+    for (int i = 0; i < count; ++i) {
+        float t = count > 1 ? float(i) / float(count - 1) : 0.0f;
+        float position = t * segments;
+        int stop = qMin(int(position), segments - 1);
+        float fraction = position - stop;
+        colors.append(colorStops[stop] * (1.0f - fraction) + colorStops[stop + 1] * fraction);
+    }
+    return colors;
+}
+
+QVector<QVector3D> Colormap::stops(Name name) {
+    switch (name) {
+        case Inferno:
+            return {QVector3D(0.001f, 0.000f, 0.014f), QVector3D(0.087f, 0.044f, 0.224f),
+                    QVector3D(0.258f, 0.039f, 0.406f), QVector3D(0.416f, 0.090f, 0.433f),
+                    QVector3D(0.578f, 0.148f, 0.404f), QVector3D(0.735f, 0.216f, 0.330f),
+                    QVector3D(0.865f, 0.317f, 0.226f), QVector3D(0.955f, 0.459f, 0.100f),
+                    QVector3D(0.988f, 0.645f, 0.040f), QVector3D(0.964f, 0.843f, 0.273f),
+                    QVector3D(0.988f, 0.998f, 0.645f)};
+
+        case TrafficLight:
+            // Aligned green through yellow to red
+            return {QVector3D(0.10f, 0.75f, 0.25f), QVector3D(1.00f, 0.85f, 0.10f),
+                    QVector3D(0.90f, 0.15f, 0.10f)};
+
+        case Viridis:
+        default:
+            return {QVector3D(0.267f, 0.005f, 0.329f), QVector3D(0.283f, 0.141f, 0.458f),
+                    QVector3D(0.254f, 0.265f, 0.530f), QVector3D(0.207f, 0.372f, 0.553f),
+                    QVector3D(0.164f, 0.471f, 0.558f), QVector3D(0.128f, 0.567f, 0.551f),
+                    QVector3D(0.135f, 0.659f, 0.518f), QVector3D(0.267f, 0.749f, 0.441f),
+                    QVector3D(0.478f, 0.821f, 0.318f), QVector3D(0.741f, 0.873f, 0.150f),
+                    QVector3D(0.993f, 0.906f, 0.144f)};
+    }
+}
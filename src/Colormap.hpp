@@ -0,0 +1,25 @@
+#ifndef COLORMAP_HPP
+#define COLORMAP_HPP
+
+#include <QVector3D>
+#include <QVector>
+
+/**
+ * @brief Scalar-to-color maps for error visualization
+ *
+ * Each map is a short list of evenly spaced RGB stops (matplotlib's viridis and inferno at
+ * tenths, and a green-yellow-red ramp), sampled into a lookup table with linear
+ * interpolation between neighbouring stops.
+ */
+class Colormap {
+   public:
+    enum Name { Viridis = 0, Inferno, TrafficLight, NameCount };
+
+    // count evenly spaced colors from 0 to 1 inclusive
+    static QVector<QVector3D> sample(Name name, int count);
+
+   private:
+    static QVector<QVector3D> stops(Name name);
+};
+
+#endif  // COLORMAP_HPP
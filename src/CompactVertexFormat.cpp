@@ -0,0 +1,152 @@
+#include "CompactVertexFormat.hpp"
+
+#include <QFloat16>
+#include <cmath>
+#include <cstring>
+
+// Half positions are used while their rounding error stays below this fraction of the
+// average edge length, so no triangle visibly changes shape
+static const double kHalfEdgeTolerance = 1.0 / 64.0;
+// Largest finite half float
+static const float kHalfMax = 65504.0f;
+// Triangles the average edge length is measured on, spread over the mesh
+static const int kEdgeSamples = 1 << 16;
+
+static const float kShortScale = 32767.0f;
+
+CompactVertexFormat::Positions CompactVertexFormat::choosePositions(const float* positions,
+                                                                    int sourceStride,
+                                                                    int vertexCount,
+                                                                    const unsigned int* indices,
+                                                                    int indexCount) {
+    const int triangleCount = indexCount / 3;
+    if (vertexCount == 0 || triangleCount == 0) {
+        return FloatPositions;
+    }
+
+    float maxMagnitude = 0.0f;
+    for (int vertex = 0; vertex < vertexCount; ++vertex) {
+        const float* position = positions + qint64(vertex) * sourceStride;
+        for (int axis = 0; axis < 3; ++axis) {
+            maxMagnitude = qMax(maxMagnitude, std::fabs(position[axis]));
+        }
+    }
+    if (!(maxMagnitude < kHalfMax)) {
+        return FloatPositions;
+    }
+
+    double edgeSum = 0.0;
+    int edgeCount = 0;
+    const int step = qMax(1, triangleCount / kEdgeSamples);
+    for (int triangle = 0; triangle < triangleCount; triangle += step) {
+        for (int corner = 0; corner < 3; ++corner) {
+            const float* a = positions + qint64(indices[triangle * 3 + corner]) * sourceStride;
+            const float* b =
+                positions + qint64(indices[triangle * 3 + (corner + 1) % 3]) * sourceStride;
+            const float d[3] = {b[0] - a[0], b[1] - a[1], b[2] - a[2]};
+            edgeSum += std::sqrt(d[0] * d[0] + d[1] * d[1] + d[2] * d[2]);
+            ++edgeCount;
+        }
+    }
+
+    // Halves in [2^(e-1), 2^e) are 2^(e-11) apart, so they are off by up to 2^(e-12)
+    int exponent = 0;
+    std::frexp(maxMagnitude, &exponent);
+    const double roundingError = std::ldexp(1.0, exponent - 12);
+    return roundingError <= kHalfEdgeTolerance * edgeSum / edgeCount ? HalfPositions
+                                                                     : FloatPositions;
+}
+
+int CompactVertexFormat::stride(Positions positions) {
+    // Half positions are padded to keep the normal four-byte aligned
+    return positions == HalfPositions ? 12 : 16;
+}
+
+VertexLayout CompactVertexFormat::layout(Positions positions) {
+    const quint32 vertexStride = quint32(stride(positions));
+    if (positions == HalfPositions) {
+        return {{0, 3, GL_HALF_FLOAT, 0, 0, vertexStride, 0},
+                {1, 2, GL_SHORT, 1, 8, vertexStride, 0}};
+    }
+    return {{0, 3, GL_FLOAT, 0, 0, vertexStride, 0}, {1, 2, GL_SHORT, 1, 12, vertexStride, 0}};
+}
+
+void CompactVertexFormat::pack(Positions format, const float* positions, const float* normals,
+                               int sourceStride, int vertexCount, uchar* vertices) {
+    const int vertexStride = stride(format);
+    for (int vertex = 0; vertex < vertexCount; ++vertex) {
+        packVertex(format, positions + qint64(vertex) * sourceStride,
+                   normals + qint64(vertex) * sourceStride,
+                   vertices + qint64(vertex) * vertexStride);
+    }
+}
+
+void CompactVertexFormat::packVertex(Positions format, const float position[3],
+                                     const float normal[3], uchar* vertex) {
+    int normalOffset = 12;
+    if (format == HalfPositions) {
+        const qfloat16 half[4] = {qfloat16(position[0]), qfloat16(position[1]),
+                                  qfloat16(position[2]), qfloat16(0.0f)};
+        std::memcpy(vertex, half, sizeof(half));
+        normalOffset = 8;
+    } else {
+        std::memcpy(vertex, position, 3 * sizeof(float));
+    }
+
+    qint16 encoded[2];
+    encodeNormal(normal, encoded);
+    std::memcpy(vertex + normalOffset, encoded, sizeof(encoded));
+}
+
+void CompactVertexFormat::encodeNormal(const float normal[3], qint16 encoded[2]) {
+    // Onto the octahedron |x| + |y| + |z| = 1, with the lower half folded over the upper
+    float u = 0.0f;
+    float v = 0.0f;
+    const float sum = std::fabs(normal[0]) + std::fabs(normal[1]) + std::fabs(normal[2]);
+    if (sum > 0.0f) {
+        u = normal[0] / sum;
+        v = normal[1] / sum;
+        if (normal[2] < 0.0f) {
+            const float foldedU = (1.0f - std::fabs(v)) * (u >= 0.0f ? 1.0f : -1.0f);
+            const float foldedV = (1.0f - std::fabs(u)) * (v >= 0.0f ? 1.0f : -1.0f);
+            u = foldedU;
+            v = foldedV;
+        }
+    }
+    encoded[0] = qint16(std::lround(qBound(-1.0f, u, 1.0f) * kShortScale));
+    encoded[1] = qint16(std::lround(qBound(-1.0f, v, 1.0f) * kShortScale));
+}
+
+void CompactVertexFormat::decodeNormal(const qint16 encoded[2], float normal[3]) {
+    float u = qMax(encoded[0] / kShortScale, -1.0f);
+    float v = qMax(encoded[1] / kShortScale, -1.0f);
+    const float z = 1.0f - std::fabs(u) - std::fabs(v);
+    const float fold = qMax(-z, 0.0f);
+    u += u >= 0.0f ? -fold : fold;
+    v += v >= 0.0f ? -fold : fold;
+
+    const float length = std::sqrt(u * u + v * v + z * z);
+    normal[0] = u / length;
+    normal[1] = v / length;
+    normal[2] = z / length;
+}
+
+GLenum CompactVertexFormat::indexType(int vertexCount) {
+    return vertexCount <= MaxShortIndexVertices ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT;
+}
+
+int CompactVertexFormat::indexSize(GLenum type) {
+    return type == GL_UNSIGNED_SHORT ? int(sizeof(quint16)) : int(sizeof(quint32));
+}
+
+void CompactVertexFormat::packIndices(const unsigned int* indices, int indexCount, GLenum type,
+                                      uchar* packed) {
+    if (type != GL_UNSIGNED_SHORT) {
+        std::memcpy(packed, indices, qint64(indexCount) * sizeof(quint32));
+        return;
+    }
+    quint16* shorts = reinterpret_cast<quint16*>(packed);
+    for (int i = 0; i < indexCount; ++i) {
+        shorts[i] = quint16(indices[i]);
+    }
+}
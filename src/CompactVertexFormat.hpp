@@ -0,0 +1,56 @@
+#ifndef COMPACTVERTEXFORMAT_HPP
+#define COMPACTVERTEXFORMAT_HPP
+
+#include <QtGlobal>
+
+#include "VertexLayout.hpp"
+
+/**
+ * @brief Interleaved vertex and index formats of the atlas and model buffers
+ *
+ * A vertex is its position followed by its unit normal. Positions are three floats, or
+ * three half floats where their rounding error stays far below the mesh's edge lengths.
+ * Normals are projected onto the octahedron and stored as two normalized shorts, which
+ * the vertex shaders unfold again. That is 16 or 12 bytes per vertex instead of 24 for
+ * float positions and normals. Meshes with up to MaxShortIndexVertices vertices are
+ * indexed with unsigned shorts.
+ *
+ * The format is chosen per mesh when it is uploaded; layout() describes it to
+ * ModelMesh, the GeometryAtlas and mesh cache files.
+ */
+class CompactVertexFormat {
+   public:
+    enum Positions { FloatPositions, HalfPositions };
+
+    // Largest vertex count indexed with unsigned shorts
+    static const int MaxShortIndexVertices = 65536;
+
+    // Half positions if precise enough for the triangles. The position of vertex i starts
+    // at positions[i * sourceStride].
+    static Positions choosePositions(const float* positions, int sourceStride, int vertexCount,
+                                     const unsigned int* indices, int indexCount);
+    // Bytes per vertex
+    static int stride(Positions positions);
+    // Position at attribute location 0, normal at 1
+    static VertexLayout layout(Positions positions);
+
+    // Packs vertexCount vertices into stride() bytes each. The position and normal of
+    // vertex i start at positions[i * sourceStride] and normals[i * sourceStride].
+    static void pack(Positions format, const float* positions, const float* normals,
+                     int sourceStride, int vertexCount, uchar* vertices);
+    static void packVertex(Positions format, const float position[3], const float normal[3],
+                           uchar* vertex);
+
+    // Octahedral normal encoding, and the decoding the vertex shaders do
+    static void encodeNormal(const float normal[3], qint16 encoded[2]);
+    static void decodeNormal(const qint16 encoded[2], float normal[3]);
+
+    // GL_UNSIGNED_SHORT for meshes small enough, GL_UNSIGNED_INT otherwise
+    static GLenum indexType(int vertexCount);
+    static int indexSize(GLenum type);
+    // Copies indices into indexSize(type) bytes each
+    static void packIndices(const unsigned int* indices, int indexCount, GLenum type,
+                            uchar* packed);
+};
+
+#endif  // COMPACTVERTEXFORMAT_HPP
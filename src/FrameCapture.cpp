@@ -0,0 +1,240 @@
+#include "FrameCapture.hpp"
+
+#include <QDebug>
+#include <opencv2/core.hpp>
+
+#include "VideoEncoder.hpp"
+
+FrameCapture::FrameCapture()
+    : m_functionsInitialized(false),
+      m_encoder(nullptr),
+      m_framesPerSecond(30.0),
+      m_nextCaptureMs(0),
+      m_resolveFramebuffer(0),
+      m_resolveColorBuffer(0),
+      m_nextSlot(0),
+      m_capturedFrames(0),
+      m_droppedFrames(0),
+      m_encoderDroppedFrames(0) {
+    for (ReadbackSlot& slot : m_ring) {
+        slot.pixelBuffer = 0;
+        slot.fence = nullptr;
+        slot.timestampMs = 0;
+    }
+}
+
+FrameCapture::~FrameCapture() {
+    // The owning renderer is destroyed with its context current
+    stop();
+    releaseGL();
+}
+
+bool FrameCapture::start(const QString& path, double framesPerSecond) {
+    if (isActive() || path.isEmpty() || framesPerSecond <= 0.0) {
+        return false;
+    }
+
+    m_framesPerSecond = framesPerSecond;
+    m_capturedFrames = 0;
+    m_droppedFrames = 0;
+    m_encoderDroppedFrames = 0;
+    m_nextCaptureMs = 0;
+    m_sessionClock.start();
+
+    m_encoder = new VideoEncoder(path, framesPerSecond);
+    m_encoder->start();
+
+    qDebug() << "Frame capture started:" << path << "at" << framesPerSecond << "fps";
+    return true;
+}
+
+void FrameCapture::stop() {
+    if (!isActive()) {
+        return;
+    }
+
+    // Hand over the frames still in flight, oldest first
+    for (int i = 0; i < RingSize; ++i) {
+        retireSlot(m_ring[(m_nextSlot + i) % RingSize], true);
+    }
+
+    // Let the encoder drain its queue and close the output
+    m_encoder->finish();
+    m_encoder->wait();
+    m_encoderDroppedFrames = m_encoder->droppedFrames();
+    delete m_encoder;
+    m_encoder = nullptr;
+
+    qDebug() << "Frame capture stopped -" << m_capturedFrames << "frames captured,"
+             << droppedFrames() << "dropped";
+}
+
+int FrameCapture::droppedFrames() const {
+    int encoderDrops = m_encoder ? m_encoder->droppedFrames() : m_encoderDroppedFrames;
+    return m_droppedFrames + encoderDrops;
+}
+
+void FrameCapture::captureFrame(const QSize& size, const QPoint& origin) {
+    if (!isActive() || size.isEmpty()) {
+        return;
+    }
+
+    if (!m_functionsInitialized) {
+        initializeOpenGLFunctions();
+        m_functionsInitialized = true;
+    }
+
+    // Collect finished readbacks, oldest first, without waiting
+    for (int i = 0; i < RingSize; ++i) {
+        ReadbackSlot& slot = m_ring[(m_nextSlot + i) % RingSize];
+        if (slot.fence && !retireSlot(slot, false)) {
+            break;
+        }
+    }
+
+    // Fixed capture rate: the encoder repeats frames to fill longer gaps
+    qint64 nowMs = m_sessionClock.elapsed();
+    if (nowMs < m_nextCaptureMs) {
+        return;
+    }
+    const double intervalMs = 1000.0 / m_framesPerSecond;
+    m_nextCaptureMs = qMax(m_nextCaptureMs + qint64(intervalMs), nowMs);
+
+    // Still in flight after a full ring: the GPU is too far behind, drop that frame
+    ReadbackSlot& slot = m_ring[m_nextSlot];
+    if (slot.fence) {
+        glDeleteSync(slot.fence);
+        slot.fence = nullptr;
+        ++m_droppedFrames;
+    }
+
+    if (!ensureResolveTarget(size)) {
+        return;
+    }
+
+    // Resolve the bound (possibly multisampled) framebuffer, then read it asynchronously
+    GLint sourceFramebuffer = 0;
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &sourceFramebuffer);
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, sourceFramebuffer);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, m_resolveFramebuffer);
+    glBlitFramebuffer(origin.x(), origin.y(), origin.x() + size.width(),
+                      origin.y() + size.height(), 0, 0, size.width(), size.height(),
+                      GL_COLOR_BUFFER_BIT, GL_NEAREST);
+
+    if (!slot.pixelBuffer) {
+        glGenBuffers(1, &slot.pixelBuffer);
+    }
+    const GLsizeiptr byteCount = GLsizeiptr(size.width()) * size.height() * 4;
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, m_resolveFramebuffer);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pixelBuffer);
+    glBufferData(GL_PIXEL_PACK_BUFFER, byteCount, nullptr, GL_STREAM_READ);
+    glPixelStorei(GL_PACK_ALIGNMENT, 4);
+    glReadPixels(0, 0, size.width(), size.height(), GL_RGBA, GL_UNSIGNED_BYTE, nullptr);
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+
+    slot.fence = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+    slot.size = size;
+    slot.timestampMs = nowMs;
+    m_nextSlot = (m_nextSlot + 1) % RingSize;
+
+    glBindFramebuffer(GL_FRAMEBUFFER, sourceFramebuffer);
+}
+
+bool FrameCapture::ensureResolveTarget(const QSize& size) {
+    if (m_resolveFramebuffer && m_resolveSize == size) {
+        return true;
+    }
+
+    if (m_resolveFramebuffer) {
+        glDeleteFramebuffers(1, &m_resolveFramebuffer);
+        glDeleteRenderbuffers(1, &m_resolveColorBuffer);
+    }
+
+    GLint previousFramebuffer = 0;
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previousFramebuffer);
+
+    glGenRenderbuffers(1, &m_resolveColorBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, m_resolveColorBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_RGBA8, size.width(), size.height());
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &m_resolveFramebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, m_resolveFramebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER,
+                              m_resolveColorBuffer);
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindFramebuffer(GL_FRAMEBUFFER, previousFramebuffer);
+
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        qDebug() << "ERROR: Capture resolve framebuffer incomplete, status" << Qt::hex << status;
+        glDeleteFramebuffers(1, &m_resolveFramebuffer);
+        glDeleteRenderbuffers(1, &m_resolveColorBuffer);
+        m_resolveFramebuffer = 0;
+        m_resolveColorBuffer = 0;
+        return false;
+    }
+
+    m_resolveSize = size;
+    return true;
+}
+
+bool FrameCapture::retireSlot(ReadbackSlot& slot, bool wait) {
+    if (!slot.fence) {
+        return true;
+    }
+
+    // Map only once the readback has landed, unless the caller accepts waiting for it
+    GLuint64 timeoutNs = wait ? GLuint64(1000000000) : 0;
+    GLenum result = glClientWaitSync(slot.fence, GL_SYNC_FLUSH_COMMANDS_BIT, timeoutNs);
+    if (result == GL_TIMEOUT_EXPIRED) {
+        return false;
+    }
+    glDeleteSync(slot.fence);
+    slot.fence = nullptr;
+    if (result == GL_WAIT_FAILED) {
+        ++m_droppedFrames;
+        return true;
+    }
+
+    const int width = slot.size.width();
+    const int height = slot.size.height();
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, slot.pixelBuffer);
+    const void* pixels =
+        glMapBufferRange(GL_PIXEL_PACK_BUFFER, 0, GLsizeiptr(width) * height * 4, GL_MAP_READ_BIT);
+    if (pixels) {
+        // Only copied out of the mapping here; the encoder converts and flips it
+        cv::Mat rgba = cv::Mat(height, width, CV_8UC4, const_cast<void*>(pixels)).clone();
+        glUnmapBuffer(GL_PIXEL_PACK_BUFFER);
+
+        if (m_encoder->enqueue(rgba, slot.timestampMs)) {
+            ++m_capturedFrames;
+        }
+    } else {
+        ++m_droppedFrames;
+    }
+    glBindBuffer(GL_PIXEL_PACK_BUFFER, 0);
+    return true;
+}
+
+void FrameCapture::releaseGL() {
+    if (!m_functionsInitialized) {
+        return;
+    }
+
+    for (ReadbackSlot& slot : m_ring) {
+        if (slot.fence) {
+            glDeleteSync(slot.fence);
+            slot.fence = nullptr;
+        }
+        if (slot.pixelBuffer) {
+            glDeleteBuffers(1, &slot.pixelBuffer);
+            slot.pixelBuffer = 0;
+        }
+    }
+    if (m_resolveFramebuffer) {
+        glDeleteFramebuffers(1, &m_resolveFramebuffer);
+        glDeleteRenderbuffers(1, &m_resolveColorBuffer);
+        m_resolveFramebuffer = 0;
+        m_resolveColorBuffer = 0;
+    }
+}
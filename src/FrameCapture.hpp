@@ -0,0 +1,78 @@
+#ifndef FRAMECAPTURE_HPP
+#define FRAMECAPTURE_HPP
+
+#include <QElapsedTimer>
+#include <QOpenGLExtraFunctions>
+#include <QPoint>
+#include <QSize>
+#include <QString>
+
+class VideoEncoder;
+
+/**
+ * @brief Render-thread frame grabber using a ring of pixel buffer objects
+ *
+ * Each captured frame is resolved into a single-sample framebuffer and read into a PBO
+ * asynchronously. The PBO is mapped a frame or two later, once its fence has signalled, so
+ * the render thread never waits for the GPU. Mapped frames go to a VideoEncoder worker.
+ * Frames whose readback is still in flight when its PBO is needed again, or that the
+ * encoder has no room for, are counted as dropped.
+ */
+class FrameCapture : protected QOpenGLExtraFunctions {
+   public:
+    FrameCapture();
+    ~FrameCapture();
+
+    // Starts a session writing to path (video file or image directory) at a fixed rate
+    bool start(const QString& path, double framesPerSecond);
+
+    // Collects in-flight frames and waits for the encoder (requires a current context)
+    void stop();
+
+    bool isActive() const {
+        return m_encoder != nullptr;
+    }
+
+    // Reads the currently bound framebuffer (size in pixels, from origin) when the next
+    // frame is due
+    void captureFrame(const QSize& size, const QPoint& origin = QPoint());
+
+    int capturedFrames() const {
+        return m_capturedFrames;
+    }
+    int droppedFrames() const;
+
+   private:
+    static const int RingSize = 3;
+
+    struct ReadbackSlot {
+        GLuint pixelBuffer;
+        GLsync fence;
+        QSize size;
+        qint64 timestampMs;
+    };
+
+    bool ensureResolveTarget(const QSize& size);
+    void releaseGL();
+    bool retireSlot(ReadbackSlot& slot, bool wait);
+
+    bool m_functionsInitialized;
+    VideoEncoder* m_encoder;
+    double m_framesPerSecond;
+    QElapsedTimer m_sessionClock;
+    qint64 m_nextCaptureMs;
+
+    // Single-sample copy of the frame (also used when the source is not multisampled)
+    GLuint m_resolveFramebuffer;
+    GLuint m_resolveColorBuffer;
+    QSize m_resolveSize;
+
+    ReadbackSlot m_ring[RingSize];
+    int m_nextSlot;
+
+    int m_capturedFrames;
+    int m_droppedFrames;         // Readbacks not ready in time
+    int m_encoderDroppedFrames;  // Encoder drops of the last finished session
+};
+
+#endif  // FRAMECAPTURE_HPP
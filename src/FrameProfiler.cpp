@@ -0,0 +1,365 @@
+#include "FrameProfiler.hpp"
+
+#include <QDebug>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QOpenGLContext>
+#include <algorithm>
+#include <cmath>
+
+// Desktop timer query target (GL 3.3 / ARB_timer_query, EXT_disjoint_timer_query on ES)
+#ifndef GL_TIME_ELAPSED
+#define GL_TIME_ELAPSED 0x88BF
+#endif
+
+FrameSample::FrameSample()
+    : cpuFrameMs(0.0), gpuFrameMs(-1.0), glCalls(0), glCallsSkipped(0) {
+    for (int pass = 0; pass < PassCount; ++pass) {
+        cpuPassMs[pass] = 0.0;
+        gpuPassMs[pass] = -1.0;
+    }
+}
+
+const char* FrameSample::passName(int pass) {
+    switch (pass) {
+        case ReferencePass:
+            return "reference";
+        case MovablePass:
+            return "movable";
+        case MarkerPass:
+            return "markers";
+        case CompositePass:
+            return "composite";
+        case LabelPass:
+            return "labels";
+        case OverlapPass:
+            return "overlap";
+        default:
+            return "unknown";
+    }
+}
+
+// ===================================================================
+// FRAMEPROFILER IMPLEMENTATION
+// ===================================================================
+
+FrameProfiler::FrameProfiler()
+    : m_currentSlot(0),
+      m_initialized(false),
+      m_gpuTimersSupported(false),
+      m_inFrame(false),
+      m_frameStartNs(0) {
+    for (FrameSlot& slot : m_ring) {
+        for (int pass = 0; pass < FrameSample::PassCount; ++pass) {
+            slot.queries[pass] = 0;
+            slot.queryIssued[pass] = false;
+        }
+        slot.pending = false;
+    }
+    for (qint64& start : m_passStartNs) {
+        start = 0;
+    }
+}
+
+FrameProfiler::~FrameProfiler() {
+    // Query objects only exist when timer queries are supported
+    if (!m_gpuTimersSupported) {
+        return;
+    }
+
+    for (FrameSlot& slot : m_ring) {
+        glDeleteQueries(FrameSample::PassCount, slot.queries);
+    }
+}
+
+void FrameProfiler::initialize() {
+    if (m_initialized) {
+        return;
+    }
+
+    initializeOpenGLFunctions();
+    m_clock.start();
+    m_initialized = true;
+
+    // Timer queries need desktop GL 3.3 or one of the timer query extensions
+    QOpenGLContext* context = QOpenGLContext::currentContext();
+    if (context) {
+        QSurfaceFormat format = context->format();
+        bool desktop33 = !context->isOpenGLES() && format.version() >= qMakePair(3, 3);
+        m_gpuTimersSupported = desktop33 ||
+                               context->hasExtension("GL_ARB_timer_query") ||
+                               context->hasExtension("GL_EXT_disjoint_timer_query");
+    }
+
+    if (m_gpuTimersSupported) {
+        for (FrameSlot& slot : m_ring) {
+            glGenQueries(FrameSample::PassCount, slot.queries);
+        }
+    }
+
+    qDebug() << "Frame profiler initialized - GPU timer queries:"
+             << (m_gpuTimersSupported ? "available" : "unavailable");
+}
+
+void FrameProfiler::beginFrame() {
+    if (!m_initialized) {
+        return;
+    }
+
+    // Retire finished frames oldest first without blocking. The slot about to be reused is
+    // retired even if its queries are still in flight, dropping its GPU times.
+    for (int i = 0; i < RingSize; ++i) {
+        FrameSlot& pendingSlot = m_ring[(m_currentSlot + i) % RingSize];
+        if (pendingSlot.pending && !collectSlot(pendingSlot, i == 0)) {
+            break;
+        }
+    }
+
+    FrameSlot& slot = m_ring[m_currentSlot];
+    slot.sample = FrameSample();
+    for (bool& issued : slot.queryIssued) {
+        issued = false;
+    }
+
+    m_inFrame = true;
+    m_frameStartNs = m_clock.nsecsElapsed();
+}
+
+void FrameProfiler::endFrame() {
+    if (!m_inFrame) {
+        return;
+    }
+
+    FrameSlot& slot = m_ring[m_currentSlot];
+    slot.sample.cpuFrameMs = (m_clock.nsecsElapsed() - m_frameStartNs) / 1.0e6;
+    slot.pending = true;
+
+    m_inFrame = false;
+    m_currentSlot = (m_currentSlot + 1) % RingSize;
+}
+
+void FrameProfiler::beginPass(FrameSample::Pass pass) {
+    if (!m_inFrame) {
+        return;
+    }
+
+    m_passStartNs[pass] = m_clock.nsecsElapsed();
+
+    if (m_gpuTimersSupported) {
+        FrameSlot& slot = m_ring[m_currentSlot];
+        glBeginQuery(GL_TIME_ELAPSED, slot.queries[pass]);
+        slot.queryIssued[pass] = true;
+    }
+}
+
+void FrameProfiler::endPass(FrameSample::Pass pass) {
+    if (!m_inFrame) {
+        return;
+    }
+
+    FrameSlot& slot = m_ring[m_currentSlot];
+    if (m_gpuTimersSupported && slot.queryIssued[pass]) {
+        glEndQuery(GL_TIME_ELAPSED);
+    }
+
+    slot.sample.cpuPassMs[pass] += (m_clock.nsecsElapsed() - m_passStartNs[pass]) / 1.0e6;
+}
+
+void FrameProfiler::setCallCounts(int issued, int skipped) {
+    if (!m_inFrame) {
+        return;
+    }
+
+    FrameSlot& slot = m_ring[m_currentSlot];
+    slot.sample.glCalls = issued;
+    slot.sample.glCallsSkipped = skipped;
+}
+
+bool FrameProfiler::collectSlot(FrameSlot& slot, bool force) {
+    if (m_gpuTimersSupported) {
+        // Only read results that are already there
+        bool allAvailable = true;
+        for (int pass = 0; pass < FrameSample::PassCount && allAvailable; ++pass) {
+            if (slot.queryIssued[pass]) {
+                GLuint available = 0;
+                glGetQueryObjectuiv(slot.queries[pass], GL_QUERY_RESULT_AVAILABLE, &available);
+                allAvailable = available != 0;
+            }
+        }
+
+        if (!allAvailable && !force) {
+            return false;
+        }
+
+        if (allAvailable) {
+            double gpuFrameMs = 0.0;
+            for (int pass = 0; pass < FrameSample::PassCount; ++pass) {
+                if (slot.queryIssued[pass]) {
+                    GLuint elapsedNs = 0;
+                    glGetQueryObjectuiv(slot.queries[pass], GL_QUERY_RESULT, &elapsedNs);
+                    slot.sample.gpuPassMs[pass] = elapsedNs / 1.0e6;
+                    gpuFrameMs += slot.sample.gpuPassMs[pass];
+                }
+            }
+            slot.sample.gpuFrameMs = gpuFrameMs;
+        }
+    }
+
+    m_completed.append(slot.sample);
+    slot.pending = false;
+    return true;
+}
+
+void FrameProfiler::flush() {
+    if (!m_initialized) {
+        return;
+    }
+
+    // After glFinish() every issued query result is available
+    glFinish();
+    for (int i = 0; i < RingSize; ++i) {
+        FrameSlot& pendingSlot = m_ring[(m_currentSlot + i) % RingSize];
+        if (pendingSlot.pending) {
+            collectSlot(pendingSlot, true);
+        }
+    }
+}
+
+QVector<FrameSample> FrameProfiler::takeSamples() {
+    QVector<FrameSample> samples;
+    samples.swap(m_completed);
+    return samples;
+}
+
+// ===================================================================
+// FRAMESTATISTICS IMPLEMENTATION
+// ===================================================================
+
+// Nearest-rank percentile of an ascending sorted vector
+static double percentile(const QVector<double>& sorted, double fraction) {
+    if (sorted.isEmpty()) {
+        return 0.0;
+    }
+    int rank = qBound(0, int(std::ceil(fraction * sorted.size())) - 1, int(sorted.size()) - 1);
+    return sorted[rank];
+}
+
+static double mean(const QVector<double>& values) {
+    if (values.isEmpty()) {
+        return 0.0;
+    }
+    double sum = 0.0;
+    for (double value : values) {
+        sum += value;
+    }
+    return sum / values.size();
+}
+
+static void addDistribution(QVariantMap& map, const QString& prefix, QVector<double> values) {
+    std::sort(values.begin(), values.end());
+    map[prefix + "MeanMs"] = mean(values);
+    map[prefix + "P50Ms"] = percentile(values, 0.50);
+    map[prefix + "P95Ms"] = percentile(values, 0.95);
+    map[prefix + "P99Ms"] = percentile(values, 0.99);
+}
+
+FrameStatistics::FrameStatistics(int capacity) : m_capacity(capacity) {
+    m_samples.reserve(capacity);
+}
+
+void FrameStatistics::append(const QVector<FrameSample>& samples) {
+    m_samples += samples;
+
+    // Keep a rolling window of the most recent frames
+    if (m_samples.size() > m_capacity) {
+        m_samples.remove(0, m_samples.size() - m_capacity);
+    }
+}
+
+void FrameStatistics::clear() {
+    m_samples.clear();
+}
+
+QVariantMap FrameStatistics::summary() const {
+    QVariantMap map;
+    map["frameCount"] = m_samples.size();
+
+    QVector<double> cpuFrames;
+    QVector<double> gpuFrames;
+    QVector<double> glCalls;
+    QVector<double> glCallsSkipped;
+    cpuFrames.reserve(m_samples.size());
+    gpuFrames.reserve(m_samples.size());
+    for (const FrameSample& sample : m_samples) {
+        cpuFrames.append(sample.cpuFrameMs);
+        if (sample.gpuFrameMs >= 0.0) {
+            gpuFrames.append(sample.gpuFrameMs);
+        }
+        glCalls.append(sample.glCalls);
+        glCallsSkipped.append(sample.glCallsSkipped);
+    }
+    addDistribution(map, "cpu", cpuFrames);
+    addDistribution(map, "gpu", gpuFrames);
+    map["gpuSampleCount"] = gpuFrames.size();
+
+    // OpenGL calls per frame, and the redundant ones the state tracker dropped
+    map["glCallsMean"] = mean(glCalls);
+    map["glCallsSkippedMean"] = mean(glCallsSkipped);
+
+    // Per-pass means
+    QVariantMap passes;
+    for (int pass = 0; pass < FrameSample::PassCount; ++pass) {
+        QVector<double> cpuPass;
+        QVector<double> gpuPass;
+        for (const FrameSample& sample : m_samples) {
+            cpuPass.append(sample.cpuPassMs[pass]);
+            if (sample.gpuPassMs[pass] >= 0.0) {
+                gpuPass.append(sample.gpuPassMs[pass]);
+            }
+        }
+
+        QVariantMap passStats;
+        passStats["cpuMeanMs"] = mean(cpuPass);
+        passStats["gpuMeanMs"] = mean(gpuPass);
+        passes[FrameSample::passName(pass)] = passStats;
+    }
+    map["passes"] = passes;
+
+    return map;
+}
+
+bool FrameStatistics::writeToFile(const QString& filePath) const {
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qWarning() << "Failed to open frame statistics file:" << filePath;
+        return false;
+    }
+
+    QJsonArray frames;
+    for (const FrameSample& sample : m_samples) {
+        QJsonObject frame;
+        frame["cpuFrameMs"] = sample.cpuFrameMs;
+        frame["gpuFrameMs"] = sample.gpuFrameMs;
+        frame["glCalls"] = sample.glCalls;
+        frame["glCallsSkipped"] = sample.glCallsSkipped;
+
+        QJsonObject passes;
+        for (int pass = 0; pass < FrameSample::PassCount; ++pass) {
+            QJsonObject passTimes;
+            passTimes["cpuMs"] = sample.cpuPassMs[pass];
+            passTimes["gpuMs"] = sample.gpuPassMs[pass];
+            passes[FrameSample::passName(pass)] = passTimes;
+        }
+        frame["passes"] = passes;
+        frames.append(frame);
+    }
+
+    QJsonObject root;
+    root["summary"] = QJsonObject::fromVariantMap(summary());
+    root["frames"] = frames;
+
+    file.write(QJsonDocument(root).toJson());
+    return true;
+}
@@ -0,0 +1,117 @@
+#ifndef FRAMEPROFILER_HPP
+#define FRAMEPROFILER_HPP
+
+#include <QElapsedTimer>
+#include <QOpenGLExtraFunctions>
+#include <QString>
+#include <QVariantMap>
+#include <QVector>
+
+/**
+ * @brief Timing of one rendered frame, split into render passes
+ *
+ * GPU times are negative when no timer query result is available for that pass.
+ */
+struct FrameSample {
+    enum Pass {
+        ReferencePass = 0,
+        MovablePass,
+        MarkerPass,
+        CompositePass,
+        LabelPass,
+        OverlapPass,
+        PassCount
+    };
+
+    FrameSample();
+
+    double cpuFrameMs;
+    double gpuFrameMs;
+    double cpuPassMs[PassCount];
+    double gpuPassMs[PassCount];
+    int glCalls;         // State changes and draw calls issued through the GLStateTracker
+    int glCallsSkipped;  // Redundant state changes it filtered out
+
+    static const char* passName(int pass);
+};
+
+/**
+ * @brief Render-thread profiler: per-pass CPU timers and a ring of GL_TIME_ELAPSED queries
+ *
+ * Query results are only collected once GL_QUERY_RESULT_AVAILABLE reports them ready, a few
+ * frames later, so profiling never stalls the pipeline. When the ring is full the oldest
+ * unfinished frame is reported with CPU times only.
+ */
+class FrameProfiler : protected QOpenGLExtraFunctions {
+   public:
+    FrameProfiler();
+    ~FrameProfiler();
+
+    // Requires a current OpenGL context
+    void initialize();
+    bool hasGpuTimers() const {
+        return m_gpuTimersSupported;
+    }
+
+    void beginFrame();
+    void endFrame();
+    void beginPass(FrameSample::Pass pass);
+    void endPass(FrameSample::Pass pass);
+    void setCallCounts(int issued, int skipped);
+
+    // Completed samples since the last call, oldest first
+    QVector<FrameSample> takeSamples();
+
+    // Waits for the GPU and retires every pending frame (offline measurement only)
+    void flush();
+
+   private:
+    static const int RingSize = 4;
+
+    struct FrameSlot {
+        FrameSample sample;
+        GLuint queries[FrameSample::PassCount];
+        bool queryIssued[FrameSample::PassCount];
+        bool pending;
+    };
+
+    bool collectSlot(FrameSlot& slot, bool force);
+
+    FrameSlot m_ring[RingSize];
+    int m_currentSlot;
+    bool m_initialized;
+    bool m_gpuTimersSupported;
+    bool m_inFrame;
+
+    QElapsedTimer m_clock;
+    qint64 m_frameStartNs;
+    qint64 m_passStartNs[FrameSample::PassCount];
+
+    QVector<FrameSample> m_completed;
+};
+
+/**
+ * @brief GUI-side rolling window of frame samples with percentile summaries
+ */
+class FrameStatistics {
+   public:
+    explicit FrameStatistics(int capacity = 1000);
+
+    void append(const QVector<FrameSample>& samples);
+    void clear();
+    int count() const {
+        return m_samples.size();
+    }
+
+    // mean, p50, p95 and p99 of CPU and GPU frame times, plus per-pass means
+    QVariantMap summary() const;
+
+    // Writes the summary and every sample in the window as JSON
+    bool writeToFile(const QString& filePath) const;
+
+   private:
+    int m_capacity;
+    QVector<FrameSample> m_samples;
+};
+
+#endif  // FRAMEPROFILER_HPP
@@ -0,0 +1,147 @@
+#include "GLStateTracker.hpp"
+
+#include <algorithm>
+
+static const GLenum kCapabilityEnums[GLStateTracker::CapabilityCount] = {
+    GL_DEPTH_TEST, GL_BLEND, GL_SCISSOR_TEST, GL_STENCIL_TEST};
+
+GLStateTracker::GLStateTracker()
+    : m_functionsInitialized(false), m_issuedCalls(0), m_skippedCalls(0) {
+    invalidate();
+}
+
+void GLStateTracker::reset() {
+    if (!m_functionsInitialized) {
+        initializeOpenGLFunctions();
+        m_functionsInitialized = true;
+    }
+
+    invalidate();
+    m_issuedCalls = 0;
+    m_skippedCalls = 0;
+}
+
+void GLStateTracker::invalidate() {
+    for (int& capability : m_capabilities) {
+        capability = Unknown;
+    }
+    for (int& factor : m_blendFunc) {
+        factor = Unknown;
+    }
+    m_depthFunc = Unknown;
+    m_depthMask = Unknown;
+    m_colorMask = Unknown;
+    m_program = Unknown;
+    m_vertexArray = Unknown;
+    m_activeTexture = Unknown;
+    for (int& texture : m_textures) {
+        texture = Unknown;
+    }
+}
+
+bool GLStateTracker::changed(int& current, int value) {
+    if (current == value) {
+        ++m_skippedCalls;
+        return false;
+    }
+    current = value;
+    ++m_issuedCalls;
+    return true;
+}
+
+void GLStateTracker::setEnabled(Capability capability, bool enabled) {
+    if (!changed(m_capabilities[capability], enabled)) {
+        return;
+    }
+    if (enabled) {
+        glEnable(kCapabilityEnums[capability]);
+    } else {
+        glDisable(kCapabilityEnums[capability]);
+    }
+}
+
+void GLStateTracker::setBlendFunc(GLenum source, GLenum destination) {
+    setBlendFuncSeparate(source, destination, source, destination);
+}
+
+void GLStateTracker::setBlendFuncSeparate(GLenum sourceRgb, GLenum destinationRgb,
+                                          GLenum sourceAlpha, GLenum destinationAlpha) {
+    const int factors[4] = {int(sourceRgb), int(destinationRgb), int(sourceAlpha),
+                            int(destinationAlpha)};
+    if (std::equal(factors, factors + 4, m_blendFunc)) {
+        ++m_skippedCalls;
+        return;
+    }
+    std::copy(factors, factors + 4, m_blendFunc);
+    ++m_issuedCalls;
+    glBlendFuncSeparate(sourceRgb, destinationRgb, sourceAlpha, destinationAlpha);
+}
+
+void GLStateTracker::setDepthFunc(GLenum function) {
+    if (changed(m_depthFunc, int(function))) {
+        glDepthFunc(function);
+    }
+}
+
+void GLStateTracker::setDepthMask(bool enabled) {
+    if (changed(m_depthMask, enabled)) {
+        glDepthMask(enabled ? GL_TRUE : GL_FALSE);
+    }
+}
+
+void GLStateTracker::setColorMask(bool enabled) {
+    if (changed(m_colorMask, enabled)) {
+        const GLboolean mask = enabled ? GL_TRUE : GL_FALSE;
+        glColorMask(mask, mask, mask, mask);
+    }
+}
+
+void GLStateTracker::useProgram(QOpenGLShaderProgram* program) {
+    if (!changed(m_program, program ? int(program->programId()) : 0)) {
+        return;
+    }
+    if (program) {
+        program->bind();
+    } else {
+        glUseProgram(0);
+    }
+}
+
+void GLStateTracker::bindVertexArray(QOpenGLVertexArrayObject* vertexArray) {
+    if (!changed(m_vertexArray, vertexArray ? int(vertexArray->objectId()) : 0)) {
+        return;
+    }
+    if (vertexArray) {
+        vertexArray->bind();
+    } else {
+        glBindVertexArray(0);
+    }
+}
+
+void GLStateTracker::bindTexture(int unit, GLuint texture) {
+    if (m_textures[unit] == int(texture)) {
+        ++m_skippedCalls;
+        return;
+    }
+    activeTexture(unit);
+    m_textures[unit] = int(texture);
+    ++m_issuedCalls;
+    glBindTexture(GL_TEXTURE_2D, texture);
+}
+
+void GLStateTracker::activeTexture(int unit) {
+    if (changed(m_activeTexture, unit)) {
+        glActiveTexture(GL_TEXTURE0 + unit);
+    }
+}
+
+void GLStateTracker::restoreDefaults() {
+    useProgram(nullptr);
+    bindVertexArray(nullptr);
+    for (int unit = TextureUnits - 1; unit >= 0; --unit) {
+        if (m_textures[unit] != 0) {
+            bindTexture(unit, 0);
+        }
+    }
+    activeTexture(0);
+}
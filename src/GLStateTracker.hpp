@@ -0,0 +1,80 @@
+#ifndef GLSTATETRACKER_HPP
+#define GLSTATETRACKER_HPP
+
+#include <QOpenGLExtraFunctions>
+#include <QOpenGLShaderProgram>
+#include <QOpenGLVertexArrayObject>
+
+/**
+ * @brief Shadow copy of the OpenGL state the renderer changes, skipping redundant calls
+ *
+ * Covers capabilities, blend function, depth and color masks, the bound program, vertex
+ * array and 2D textures. Everything starts out unknown after reset(), so the first call
+ * of a frame is always issued; code that changes tracked state behind the tracker's back
+ * must call invalidate() afterwards.
+ *
+ * Every issued call and every skipped one is counted, including the draw calls reported
+ * with countDrawCall(). Uniform uploads are not tracked.
+ */
+class GLStateTracker : protected QOpenGLExtraFunctions {
+   public:
+    enum Capability { DepthTest = 0, Blend, ScissorTest, StencilTest, CapabilityCount };
+
+    GLStateTracker();
+
+    // Start of a frame: counters cleared, all state unknown (requires a current context)
+    void reset();
+    // Forget the shadow state, keep the counters
+    void invalidate();
+
+    void setEnabled(Capability capability, bool enabled);
+    void setBlendFunc(GLenum source, GLenum destination);
+    void setBlendFuncSeparate(GLenum sourceRgb, GLenum destinationRgb, GLenum sourceAlpha,
+                              GLenum destinationAlpha);
+    void setDepthFunc(GLenum function);
+    void setDepthMask(bool enabled);
+    void setColorMask(bool enabled);
+
+    // nullptr unbinds
+    void useProgram(QOpenGLShaderProgram* program);
+    void bindVertexArray(QOpenGLVertexArrayObject* vertexArray);
+    void bindTexture(int unit, GLuint texture);
+
+    // Draw calls are issued by their owners and only counted here
+    void countDrawCall(int count = 1) {
+        m_issuedCalls += count;
+    }
+
+    // Unbinds program, vertex array and textures, leaving the state Qt Quick expects
+    void restoreDefaults();
+
+    int issuedCalls() const {
+        return m_issuedCalls;
+    }
+    int skippedCalls() const {
+        return m_skippedCalls;
+    }
+
+   private:
+    static const int TextureUnits = 4;
+    static const int Unknown = -1;
+
+    bool changed(int& current, int value);
+    void activeTexture(int unit);
+
+    bool m_functionsInitialized;
+    int m_capabilities[CapabilityCount];
+    int m_blendFunc[4];
+    int m_depthFunc;
+    int m_depthMask;
+    int m_colorMask;
+    int m_program;
+    int m_vertexArray;
+    int m_activeTexture;
+    int m_textures[TextureUnits];
+
+    int m_issuedCalls;
+    int m_skippedCalls;
+};
+
+#endif  // GLSTATETRACKER_HPP
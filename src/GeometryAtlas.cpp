@@ -0,0 +1,450 @@
+#include "GeometryAtlas.hpp"
+
+#include <QByteArray>
+#include <QDebug>
+#include <QOpenGLVertexArrayObject>
+#include <QtMath>
+
+#include "CompactVertexFormat.hpp"
+#include "MeshOptimizer.hpp"
+
+// Tessellation levels of the parametric shapes, finest first (rows x columns)
+struct Tessellation {
+    int rows;
+    int columns;
+};
+static const Tessellation kSphereLevels[] = {{48, 64}, {24, 32}, {12, 16}};  // stacks x slices
+static const Tessellation kTorusLevels[] = {{64, 48}, {32, 24}, {16, 12}};  // major x minor
+static const Tessellation kMarkerLevels[] = {{16, 24}, {8, 12}, {4, 6}};  // stacks x slices
+static const int kLevelsPerShape = sizeof(kSphereLevels) / sizeof(kSphereLevels[0]);
+static_assert(sizeof(kTorusLevels) == sizeof(kSphereLevels) &&
+                  sizeof(kMarkerLevels) == sizeof(kSphereLevels),
+              "Every parametric shape needs the same number of levels");
+
+// Torus proportions (the bounding radius is their sum)
+static const float kTorusMajorRadius = 1.0f;
+static const float kTorusMinorRadius = 0.4f;
+
+// Level selection: allowed silhouette error in pixels, and the fraction of it a coarser
+// level must stay under before switching down (avoids popping back and forth)
+static const float kLodPixelTolerance = 1.0f;
+static const float kLodHysteresis = 0.75f;
+
+static int gridVertexCount(int rows, int columns) {
+    return (rows + 1) * (columns + 1);
+}
+
+static int gridIndexCount(int rows, int columns) {
+    return rows * columns * 6;
+}
+
+// Maximum distance between a circle and its polygon with the given number of segments
+static float chordError(float radius, int segments) {
+    return radius * (1.0f - qCos(M_PI / segments));
+}
+
+static float sphereRelativeError(const Tessellation& level) {
+    // Stacks only span half a circle
+    return chordError(1.0f, qMin(level.columns, 2 * level.rows));
+}
+
+static float torusRelativeError(const Tessellation& level) {
+    float majorError = chordError(kTorusMajorRadius + kTorusMinorRadius, level.rows);
+    float minorError = chordError(kTorusMinorRadius, level.columns);
+    return qMax(majorError, minorError) / (kTorusMajorRadius + kTorusMinorRadius);
+}
+
+GeometryAtlas::GeometryAtlas()
+    : m_vertexBuffer(QOpenGLBuffer::VertexBuffer),
+      m_indexBuffer(QOpenGLBuffer::IndexBuffer),
+      m_indexType(GL_UNSIGNED_INT),
+      m_indexSize(sizeof(unsigned int)),
+      m_baseVertex(0),
+      m_shadedBefore(0.0),
+      m_shadedAfter(0.0) {
+    static_assert(kLevelsPerShape <= MaxLevels, "Too many tessellation levels");
+
+    for (int mesh = 0; mesh < MeshCount; ++mesh) {
+        for (int level = 0; level < MaxLevels; ++level) {
+            m_levels[mesh][level] = {{0, 0}, 0.0f};
+        }
+        m_levelCounts[mesh] = 0;
+    }
+}
+
+GeometryAtlas::~GeometryAtlas() {
+    destroy();
+}
+
+bool GeometryAtlas::create() {
+    if (isCreated()) {
+        return true;
+    }
+
+    initializeOpenGLFunctions();
+
+    // Reserve the exact staging size up front so generation never reallocates
+    int vertexCount = 24 + 4;
+    int indexCount = 36 + 12;
+    for (int level = 0; level < kLevelsPerShape; ++level) {
+        vertexCount += gridVertexCount(kSphereLevels[level].rows, kSphereLevels[level].columns) +
+                       gridVertexCount(kTorusLevels[level].rows, kTorusLevels[level].columns) +
+                       gridVertexCount(kMarkerLevels[level].rows, kMarkerLevels[level].columns);
+        indexCount += gridIndexCount(kSphereLevels[level].rows, kSphereLevels[level].columns) +
+                      gridIndexCount(kTorusLevels[level].rows, kTorusLevels[level].columns) +
+                      gridIndexCount(kMarkerLevels[level].rows, kMarkerLevels[level].columns);
+    }
+    m_vertexData.reserve(vertexCount * FloatsPerVertex);
+    m_indexData.reserve(indexCount);
+    m_baseVertex = 0;
+    m_shadedBefore = 0.0;
+    m_shadedAfter = 0.0;
+
+    // Generate every mesh once into the shared staging arrays (flat shapes have one level)
+    beginMesh(Cube, 0);
+    appendCube();
+    endMesh(Cube, 0, 0.0f);
+
+    beginMesh(Tetrahedron, 0);
+    appendTetrahedron();
+    endMesh(Tetrahedron, 0, 0.0f);
+
+    for (int level = 0; level < kLevelsPerShape; ++level) {
+        beginMesh(Sphere, level);
+        appendSphere(kSphereLevels[level].rows, kSphereLevels[level].columns);
+        endMesh(Sphere, level, sphereRelativeError(kSphereLevels[level]));
+
+        beginMesh(Torus, level);
+        appendTorus(kTorusLevels[level].rows, kTorusLevels[level].columns);
+        endMesh(Torus, level, torusRelativeError(kTorusLevels[level]));
+
+        beginMesh(MarkerSphere, level);
+        appendSphere(kMarkerLevels[level].rows, kMarkerLevels[level].columns);
+        endMesh(MarkerSphere, level, sphereRelativeError(kMarkerLevels[level]));
+    }
+
+    // Upload into a single VBO/IBO pair. The element array binding is vertex array state,
+    // so a temporary VAO is bound while uploading.
+    QOpenGLVertexArrayObject uploadVao;
+    if (!uploadVao.create()) {
+        qDebug() << "ERROR: Failed to create geometry atlas upload VAO";
+        return false;
+    }
+    uploadVao.bind();
+
+    // Packed in the compact format of the whole atlas (all shapes share the layout)
+    const int totalVertices = m_vertexData.size() / FloatsPerVertex;
+    const CompactVertexFormat::Positions format = CompactVertexFormat::choosePositions(
+        m_vertexData.constData(), FloatsPerVertex, totalVertices, m_indexData.constData(),
+        m_indexData.size());
+    m_layout = CompactVertexFormat::layout(format);
+    QByteArray vertices(totalVertices * CompactVertexFormat::stride(format), Qt::Uninitialized);
+    CompactVertexFormat::pack(format, m_vertexData.constData(), m_vertexData.constData() + 3,
+                              FloatsPerVertex, totalVertices,
+                              reinterpret_cast<uchar*>(vertices.data()));
+    m_indexType = CompactVertexFormat::indexType(totalVertices);
+    m_indexSize = CompactVertexFormat::indexSize(m_indexType);
+    QByteArray indices(m_indexData.size() * m_indexSize, Qt::Uninitialized);
+    CompactVertexFormat::packIndices(m_indexData.constData(), m_indexData.size(), m_indexType,
+                                     reinterpret_cast<uchar*>(indices.data()));
+
+    m_vertexBuffer.create();
+    m_vertexBuffer.setUsagePattern(QOpenGLBuffer::StaticDraw);
+    m_vertexBuffer.bind();
+    m_vertexBuffer.allocate(vertices.constData(), vertices.size());
+    m_vertexBuffer.release();
+
+    m_indexBuffer.create();
+    m_indexBuffer.setUsagePattern(QOpenGLBuffer::StaticDraw);
+    m_indexBuffer.bind();
+    m_indexBuffer.allocate(indices.constData(), indices.size());
+    m_indexBuffer.release();
+    uploadVao.release();
+    uploadVao.destroy();
+
+    const int triangleCount = m_indexData.size() / 3;
+    qDebug() << "Geometry atlas created - Vertices:" << totalVertices
+             << "Triangles:" << triangleCount << "ACMR:" << m_shadedBefore / triangleCount
+             << "->" << m_shadedAfter / triangleCount << "Bytes:" << vertices.size() << "+"
+             << indices.size();
+
+    // Geometry lives on the GPU from now on
+    m_vertexData.clear();
+    m_vertexData.squeeze();
+    m_indexData.clear();
+    m_indexData.squeeze();
+
+    return true;
+}
+
+void GeometryAtlas::destroy() {
+    m_vertexBuffer.destroy();
+    m_indexBuffer.destroy();
+}
+
+void GeometryAtlas::draw(Mesh mesh, int level) {
+    // Expects a VAO set up with setupVertexAttributes() to be bound
+    const MeshRange& meshRange = m_levels[mesh][level].range;
+    glDrawElements(GL_TRIANGLES, meshRange.indexCount, m_indexType,
+                   reinterpret_cast<const void*>(qintptr(meshRange.firstIndex) * m_indexSize));
+}
+
+void GeometryAtlas::drawInstanced(Mesh mesh, int instanceCount, int level) {
+    // Expects a VAO set up with setupVertexAttributes() plus per-instance attributes
+    const MeshRange& meshRange = m_levels[mesh][level].range;
+    glDrawElementsInstanced(
+        GL_TRIANGLES, meshRange.indexCount, m_indexType,
+        reinterpret_cast<const void*>(qintptr(meshRange.firstIndex) * m_indexSize), instanceCount);
+}
+
+void GeometryAtlas::setupVertexAttributes() {
+    // The element array binding is recorded in the bound VAO, the array buffer is not
+    m_vertexBuffer.bind();
+    m_indexBuffer.bind();
+
+    for (const VertexAttribute& attribute : m_layout) {
+        glEnableVertexAttribArray(attribute.location);
+        glVertexAttribPointer(attribute.location, GLint(attribute.components),
+                              GLenum(attribute.type), attribute.normalized ? GL_TRUE : GL_FALSE,
+                              GLsizei(attribute.stride),
+                              reinterpret_cast<const void*>(qintptr(attribute.offset)));
+    }
+
+    m_vertexBuffer.release();
+}
+
+GeometryAtlas::Mesh GeometryAtlas::meshForShape(int shapeType) {
+    // Map research shape identifiers (1-4) to atlas meshes
+    switch (shapeType) {
+        case 1:
+            return Cube;
+        case 2:
+            return Sphere;
+        case 3:
+            return Torus;
+        case 4:
+        default:
+            return Tetrahedron;
+    }
+}
+
+float GeometryAtlas::boundingRadius(Mesh mesh) {
+    // Radius of the origin-centered sphere enclosing each mesh
+    switch (mesh) {
+        case Cube:
+            return 1.7321f;  // sqrt(3)
+        case Torus:
+            return kTorusMajorRadius + kTorusMinorRadius;
+        case Tetrahedron:
+            return 1.47f;  // base front corners
+        case Sphere:
+        case MarkerSphere:
+        default:
+            return 1.0f;
+    }
+}
+
+int GeometryAtlas::selectLevel(Mesh mesh, float screenRadius, int currentLevel) const {
+    const int levels = m_levelCounts[mesh];
+    if (levels <= 1) {
+        return 0;
+    }
+    currentLevel = qBound(0, currentLevel, levels - 1);
+
+    // Coarsest level whose silhouette error stays within the given pixel tolerance
+    auto coarsestWithin = [&](float tolerance) {
+        for (int level = levels - 1; level > 0; --level) {
+            if (screenRadius * m_levels[mesh][level].relativeError <= tolerance) {
+                return level;
+            }
+        }
+        return 0;
+    };
+
+    // Refine immediately when the current level becomes visibly faceted
+    if (screenRadius * m_levels[mesh][currentLevel].relativeError > kLodPixelTolerance) {
+        return coarsestWithin(kLodPixelTolerance);
+    }
+
+    // Coarsen only when the coarser level is comfortably within tolerance
+    return qMax(currentLevel, coarsestWithin(kLodPixelTolerance * kLodHysteresis));
+}
+
+// ===================================================================
+// GEOMETRY GENERATION METHODS
+// ===================================================================
+
+void GeometryAtlas::beginMesh(Mesh mesh, int level) {
+    m_levels[mesh][level].range.firstIndex = m_indexData.size();
+    m_baseVertex = m_vertexData.size() / FloatsPerVertex;
+}
+
+void GeometryAtlas::endMesh(Mesh mesh, int level, float relativeError) {
+    MeshRange& meshRange = m_levels[mesh][level].range;
+    meshRange.indexCount = m_indexData.size() - meshRange.firstIndex;
+    optimizeMesh(meshRange);
+    m_levels[mesh][level].relativeError = relativeError;
+    m_levelCounts[mesh] = level + 1;
+}
+
+void GeometryAtlas::optimizeMesh(const MeshRange& meshRange) {
+    // Generated row by row; reordered for the vertex caches in mesh-relative numbers
+    unsigned int* indices = m_indexData.data() + meshRange.firstIndex;
+    const int vertexCount = m_vertexData.size() / FloatsPerVertex - int(m_baseVertex);
+    for (int i = 0; i < meshRange.indexCount; ++i) {
+        indices[i] -= m_baseVertex;
+    }
+
+    const int triangleCount = meshRange.indexCount / 3;
+    m_shadedBefore +=
+        MeshOptimizer::acmr(indices, meshRange.indexCount, vertexCount) * triangleCount;
+    MeshOptimizer::optimizeVertexCache(indices, meshRange.indexCount, vertexCount);
+    QVector<unsigned int> remap =
+        MeshOptimizer::optimizeVertexFetch(indices, meshRange.indexCount, vertexCount);
+    MeshOptimizer::remapVertices(m_vertexData.data() + m_baseVertex * FloatsPerVertex,
+                                 FloatsPerVertex, vertexCount, remap);
+    m_shadedAfter +=
+        MeshOptimizer::acmr(indices, meshRange.indexCount, vertexCount) * triangleCount;
+
+    for (int i = 0; i < meshRange.indexCount; ++i) {
+        indices[i] += m_baseVertex;
+    }
+}
+
+void GeometryAtlas::appendVertex(float x, float y, float z, float nx, float ny, float nz) {
+    m_vertexData.append(x);
+    m_vertexData.append(y);
+    m_vertexData.append(z);
+    m_vertexData.append(nx);
+    m_vertexData.append(ny);
+    m_vertexData.append(nz);
+}
+
+void GeometryAtlas::appendCube() {
+    // Generate cube with unique vertices per face for proper lighting
+    static const float faces[6][4][3] = {
+        // Front face (z = 1.0)
+        {{-1.0f, -1.0f, 1.0f}, {1.0f, -1.0f, 1.0f}, {1.0f, 1.0f, 1.0f}, {-1.0f, 1.0f, 1.0f}},
+        // Back face (z = -1.0)
+        {{-1.0f, -1.0f, -1.0f}, {-1.0f, 1.0f, -1.0f}, {1.0f, 1.0f, -1.0f}, {1.0f, -1.0f, -1.0f}},
+        // Top face (y = 1.0)
+        {{-1.0f, 1.0f, -1.0f}, {-1.0f, 1.0f, 1.0f}, {1.0f, 1.0f, 1.0f}, {1.0f, 1.0f, -1.0f}},
+        // Bottom face (y = -1.0)
+        {{-1.0f, -1.0f, -1.0f}, {1.0f, -1.0f, -1.0f}, {1.0f, -1.0f, 1.0f}, {-1.0f, -1.0f, 1.0f}},
+        // Right face (x = 1.0)
+        {{1.0f, -1.0f, -1.0f}, {1.0f, 1.0f, -1.0f}, {1.0f, 1.0f, 1.0f}, {1.0f, -1.0f, 1.0f}},
+        // Left face (x = -1.0)
+        {{-1.0f, -1.0f, -1.0f}, {-1.0f, -1.0f, 1.0f}, {-1.0f, 1.0f, 1.0f}, {-1.0f, 1.0f, -1.0f}}};
+
+    // Face normals for proper lighting
+    static const float normals[6][3] = {{0.0f, 0.0f, 1.0f},  {0.0f, 0.0f, -1.0f},
+                                        {0.0f, 1.0f, 0.0f},  {0.0f, -1.0f, 0.0f},
+                                        {1.0f, 0.0f, 0.0f},  {-1.0f, 0.0f, 0.0f}};
+
+    for (int face = 0; face < 6; ++face) {
+        const unsigned int first = m_baseVertex + face * 4;
+        for (int corner = 0; corner < 4; ++corner) {
+            appendVertex(faces[face][corner][0], faces[face][corner][1], faces[face][corner][2],
+                         normals[face][0], normals[face][1], normals[face][2]);
+        }
+
+        // Two triangles per face
+        m_indexData.append(first);
+        m_indexData.append(first + 1);
+        m_indexData.append(first + 2);
+        m_indexData.append(first + 2);
+        m_indexData.append(first + 3);
+        m_indexData.append(first);
+    }
+}
+
+void GeometryAtlas::appendSphere(int stacks, int slices) {
+    // Generate unit sphere using latitude/longitude method
+    for (int i = 0; i <= stacks; ++i) {
+        float phi = M_PI * float(i) / float(stacks);  // 0 to PI
+        float cosPhi = cos(phi);
+        float sinPhi = sin(phi);
+
+        for (int j = 0; j <= slices; ++j) {
+            float theta = 2.0f * M_PI * float(j) / float(slices);  // 0 to 2*PI
+            float x = sinPhi * cos(theta);
+            float y = cosPhi;
+            float z = sinPhi * sin(theta);
+
+            // For a unit sphere the normal equals the position
+            appendVertex(x, y, z, x, y, z);
+        }
+    }
+
+    // Two triangles per quad
+    for (int i = 0; i < stacks; ++i) {
+        for (int j = 0; j < slices; ++j) {
+            unsigned int first = m_baseVertex + i * (slices + 1) + j;
+            unsigned int second = first + slices + 1;
+
+            m_indexData.append(first);
+            m_indexData.append(second);
+            m_indexData.append(first + 1);
+
+            m_indexData.append(second);
+            m_indexData.append(second + 1);
+            m_indexData.append(first + 1);
+        }
+    }
+}
+
+void GeometryAtlas::appendTorus(int majorSegments, int minorSegments) {
+    const float majorRadius = kTorusMajorRadius;
+    const float minorRadius = kTorusMinorRadius;
+
+    for (int i = 0; i <= majorSegments; ++i) {
+        float u = 2.0f * M_PI * float(i) / float(majorSegments);
+        float cosU = cos(u);
+        float sinU = sin(u);
+
+        for (int j = 0; j <= minorSegments; ++j) {
+            float v = 2.0f * M_PI * float(j) / float(minorSegments);
+            float cosV = cos(v);
+            float sinV = sin(v);
+
+            appendVertex((majorRadius + minorRadius * cosV) * cosU, minorRadius * sinV,
+                         (majorRadius + minorRadius * cosV) * sinU, cosV * cosU, sinV,
+                         cosV * sinU);
+        }
+    }
+
+    // Two triangles per quad
+    for (int i = 0; i < majorSegments; ++i) {
+        for (int j = 0; j < minorSegments; ++j) {
+            unsigned int first = m_baseVertex + i * (minorSegments + 1) + j;
+            unsigned int second = first + minorSegments + 1;
+
+            m_indexData.append(first);
+            m_indexData.append(second);
+            m_indexData.append(first + 1);
+
+            m_indexData.append(second);
+            m_indexData.append(second + 1);
+            m_indexData.append(first + 1);
+        }
+    }
+}
+
+void GeometryAtlas::appendTetrahedron() {
+    // Regular tetrahedron vertices with approximated vertex normals
+    appendVertex(0.0f, 1.2f, 0.0f, 0.0f, 1.0f, 0.0f);       // apex
+    appendVertex(-1.0f, -0.4f, 1.0f, -0.5f, -0.5f, 0.5f);   // base front-left
+    appendVertex(1.0f, -0.4f, 1.0f, 0.5f, -0.5f, 0.5f);     // base front-right
+    appendVertex(0.0f, -0.4f, -1.4f, 0.0f, -0.5f, -0.7f);   // base back
+
+    // Triangle indices (4 triangular faces)
+    static const unsigned int indices[12] = {
+        0, 1, 2,  // front face
+        0, 2, 3,  // right face
+        0, 3, 1,  // left face
+        1, 3, 2   // base face
+    };
+    for (unsigned int index : indices) {
+        m_indexData.append(m_baseVertex + index);
+    }
+}
@@ -0,0 +1,109 @@
+#ifndef GEOMETRYATLAS_HPP
+#define GEOMETRYATLAS_HPP
+
+#include <QOpenGLBuffer>
+#include <QOpenGLExtraFunctions>
+#include <QVector>
+
+#include "VertexLayout.hpp"
+
+/**
+ * @brief Persistent geometry atlas holding every built-in shape in one VBO/IBO pair
+ *
+ * All research shapes and the vertex marker sphere are generated once into a single
+ * interleaved vertex buffer (position + normal) and a single index buffer, each mesh
+ * reordered for the vertex caches (MeshOptimizer) as it is generated; the whole atlas is
+ * packed in the CompactVertexFormat on upload. Switching shape only selects a different
+ * draw range, so no geometry is rebuilt or reallocated on the render thread. The buffers
+ * are shared through the GpuResourceCache; vertex array objects are not shared between
+ * contexts, so each renderer describes them with its own (setupVertexAttributes()).
+ *
+ * Parametric meshes (spheres, torus) are stored at several tessellation levels. Level 0 is
+ * the finest; selectLevel() picks the coarsest level whose silhouette error stays below a
+ * pixel tolerance for a given projected radius.
+ */
+class GeometryAtlas : protected QOpenGLExtraFunctions {
+   public:
+    enum Mesh { Cube = 0, Sphere, Torus, Tetrahedron, MarkerSphere, MeshCount };
+
+    // Draw range of one mesh inside the shared index buffer
+    struct MeshRange {
+        int firstIndex;
+        int indexCount;
+    };
+
+    // Interleaved staging layout: 3 floats position + 3 floats normal
+    static const int FloatsPerVertex = 6;
+
+    // Maximum number of tessellation levels per mesh
+    static const int MaxLevels = 3;
+
+    GeometryAtlas();
+    ~GeometryAtlas();
+
+    // Build all meshes and upload them (requires a current OpenGL context)
+    bool create();
+    void destroy();
+    bool isCreated() const {
+        return m_vertexBuffer.isCreated();
+    }
+
+    // Drawing, with a vertex array object set up by setupVertexAttributes() bound
+    void draw(Mesh mesh, int level = 0);
+    void drawInstanced(Mesh mesh, int instanceCount, int level = 0);
+
+    // Points attributes 0/1 of the currently bound VAO at the atlas buffers
+    void setupVertexAttributes();
+
+    MeshRange range(Mesh mesh, int level = 0) const {
+        return m_levels[mesh][level].range;
+    }
+    static Mesh meshForShape(int shapeType);
+
+    // Level of detail
+    int levelCount(Mesh mesh) const {
+        return m_levelCounts[mesh];
+    }
+    static float boundingRadius(Mesh mesh);
+
+    // Level for a mesh whose bounding sphere projects to screenRadius pixels. Refines as
+    // soon as the current level exceeds the tolerance, coarsens only with some margin.
+    int selectLevel(Mesh mesh, float screenRadius, int currentLevel) const;
+
+   private:
+    // One tessellation level: draw range and silhouette error relative to the bounding radius
+    struct LevelInfo {
+        MeshRange range;
+        float relativeError;
+    };
+
+    // Mesh generation into the CPU-side staging arrays
+    void beginMesh(Mesh mesh, int level);
+    void endMesh(Mesh mesh, int level, float relativeError);
+    // Reorders the mesh's triangles and vertices for the GPU vertex caches (MeshOptimizer)
+    void optimizeMesh(const MeshRange& meshRange);
+    void appendVertex(float x, float y, float z, float nx, float ny, float nz);
+    void appendCube();
+    void appendSphere(int stacks, int slices);
+    void appendTorus(int majorSegments, int minorSegments);
+    void appendTetrahedron();
+
+    // OpenGL resources
+    QOpenGLBuffer m_vertexBuffer;
+    QOpenGLBuffer m_indexBuffer;
+    VertexLayout m_layout;
+    GLenum m_indexType;
+    int m_indexSize;  // Bytes per index
+
+    // Staging data (released once uploaded)
+    QVector<float> m_vertexData;
+    QVector<unsigned int> m_indexData;
+    unsigned int m_baseVertex;
+    double m_shadedBefore;  // Vertex shader runs for one draw of every mesh, by ACMR
+    double m_shadedAfter;
+
+    LevelInfo m_levels[MeshCount][MaxLevels];
+    int m_levelCounts[MeshCount];
+};
+
+#endif  // GEOMETRYATLAS_HPP
@@ -0,0 +1,200 @@
+#include "GlyphAtlas.hpp"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFont>
+#include <QFontMetricsF>
+#include <QImage>
+#include <QPainter>
+#include <algorithm>
+#include <cmath>
+
+// Characters in the atlas, in cell order
+static const char kGlyphCharacters[] = "0123456789'";
+static const int kGlyphCount = int(sizeof(kGlyphCharacters)) - 1;
+
+// Font size in atlas texels
+static const int kFontPixelSize = 32;
+
+// Squared distance standing in for "no feature pixel"
+static const float kFar = 1e20f;
+
+// Felzenszwalb-Huttenlocher distance transform of one line: d[q] = min over p of
+// (q - p)^2 + f[p], from the lower envelope of the parabolas rooted at every p
+static void distanceTransform1D(const float* f, float* d, int* v, float* z, int n) {
+    int k = 0;
+    v[0] = 0;
+    z[0] = -kFar;
+    z[1] = kFar;
+    for (int q = 1; q < n; ++q) {
+        float s = ((f[q] + q * q) - (f[v[k]] + v[k] * v[k])) / (2 * q - 2 * v[k]);
+        while (s <= z[k]) {
+            --k;
+            s = ((f[q] + q * q) - (f[v[k]] + v[k] * v[k])) / (2 * q - 2 * v[k]);
+        }
+        ++k;
+        v[k] = q;
+        z[k] = s;
+        z[k + 1] = kFar;
+    }
+
+    k = 0;
+    for (int q = 0; q < n; ++q) {
+        while (z[k + 1] < q) {
+            ++k;
+        }
+        d[q] = (q - v[k]) * (q - v[k]) + f[v[k]];
+    }
+}
+
+// Exact squared Euclidean distance to the nearest zero of grid, in place (separable:
+// columns, then rows of the column result)
+static void squaredDistanceTransform(QVector<float>& grid, int width, int height) {
+    const int n = qMax(width, height);
+    QVector<float> f(n);
+    QVector<float> d(n);
+    QVector<float> z(n + 1);
+    QVector<int> v(n);
+
+    for (int x = 0; x < width; ++x) {
+        for (int y = 0; y < height; ++y) {
+            f[y] = grid[y * width + x];
+        }
+        distanceTransform1D(f.constData(), d.data(), v.data(), z.data(), height);
+        for (int y = 0; y < height; ++y) {
+            grid[y * width + x] = d[y];
+        }
+    }
+
+    for (int y = 0; y < height; ++y) {
+        float* row = grid.data() + y * width;
+        distanceTransform1D(row, d.data(), v.data(), z.data(), width);
+        std::copy(d.constData(), d.constData() + width, row);
+    }
+}
+
+GlyphAtlas::GlyphAtlas() : m_functionsInitialized(false), m_texture(0) {}
+
+GlyphAtlas::~GlyphAtlas() {
+    destroy();
+}
+
+int GlyphAtlas::glyphIndex(QChar character) {
+    for (int glyph = 0; glyph < kGlyphCount; ++glyph) {
+        if (character == QLatin1Char(kGlyphCharacters[glyph])) {
+            return glyph;
+        }
+    }
+    return -1;
+}
+
+bool GlyphAtlas::create() {
+    if (isCreated()) {
+        return true;
+    }
+
+    if (!m_functionsInitialized) {
+        initializeOpenGLFunctions();
+        m_functionsInitialized = true;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    // Cells fit the widest glyph plus the distance range on every side
+    QFont font;
+    font.setStyleHint(QFont::SansSerif);
+    font.setBold(true);
+    font.setPixelSize(kFontPixelSize * Supersample);
+    QFontMetricsF metrics(font);
+
+    qreal maxAdvance = 0.0;
+    for (int glyph = 0; glyph < kGlyphCount; ++glyph) {
+        QChar character = QLatin1Char(kGlyphCharacters[glyph]);
+        maxAdvance = qMax(maxAdvance, metrics.horizontalAdvance(character));
+    }
+    m_cellSize = QSize(int(std::ceil(maxAdvance / Supersample)) + 2 * Spread,
+                       int(std::ceil(metrics.height() / Supersample)) + 2 * Spread);
+    const int cellWidth = m_cellSize.width() * Supersample;
+    const int cellHeight = m_cellSize.height() * Supersample;
+    const int padding = Spread * Supersample;
+
+    // Supersampled coverage, one glyph per cell on a shared baseline
+    QImage coverage(cellWidth * kGlyphCount, cellHeight, QImage::Format_RGB32);
+    coverage.fill(Qt::black);
+    QPainter painter(&coverage);
+    painter.setFont(font);
+    painter.setPen(Qt::white);
+    m_advances.resize(kGlyphCount);
+    for (int glyph = 0; glyph < kGlyphCount; ++glyph) {
+        QChar character = QLatin1Char(kGlyphCharacters[glyph]);
+        painter.drawText(QPointF(glyph * cellWidth + padding, padding + metrics.ascent()),
+                         QString(character));
+        m_advances[glyph] = float(metrics.horizontalAdvance(character) / cellWidth);
+    }
+    painter.end();
+
+    // Distances from every pixel to the nearest inside and the nearest outside pixel
+    const int width = coverage.width();
+    const int height = coverage.height();
+    QVector<float> toInside(width * height);
+    QVector<float> toOutside(width * height);
+    for (int y = 0; y < height; ++y) {
+        const QRgb* line = reinterpret_cast<const QRgb*>(coverage.constScanLine(y));
+        for (int x = 0; x < width; ++x) {
+            bool inside = qRed(line[x]) >= 128;
+            toInside[y * width + x] = inside ? 0.0f : kFar;
+            toOutside[y * width + x] = inside ? kFar : 0.0f;
+        }
+    }
+    squaredDistanceTransform(toInside, width, height);
+    squaredDistanceTransform(toOutside, width, height);
+
+    // Box-filtered down to atlas texels and mapped so that 0.5 lies on the outline
+    const int atlasWidth = m_cellSize.width() * kGlyphCount;
+    const int atlasHeight = m_cellSize.height();
+    QVector<uchar> field(atlasWidth * atlasHeight);
+    for (int y = 0; y < atlasHeight; ++y) {
+        for (int x = 0; x < atlasWidth; ++x) {
+            float sum = 0.0f;
+            for (int sy = 0; sy < Supersample; ++sy) {
+                for (int sx = 0; sx < Supersample; ++sx) {
+                    int i = (y * Supersample + sy) * width + x * Supersample + sx;
+                    sum += std::sqrt(toInside[i]) - std::sqrt(toOutside[i]);
+                }
+            }
+            // Positive outside the glyph, in atlas texels
+            float distance = sum / (Supersample * Supersample * Supersample);
+            float value = qBound(0.0f, 0.5f - distance / (2.0f * Spread), 1.0f);
+            field[y * atlasWidth + x] = uchar(value * 255.0f + 0.5f);
+        }
+    }
+
+    // Row 0 is the top of the glyphs
+    glGenTextures(1, &m_texture);
+    glBindTexture(GL_TEXTURE_2D, m_texture);
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_R8, atlasWidth, atlasHeight, 0, GL_RED, GL_UNSIGNED_BYTE,
+                 field.constData());
+    glPixelStorei(GL_UNPACK_ALIGNMENT, 4);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+
+    qDebug() << "Glyph atlas created:" << atlasWidth << "x" << atlasHeight << "texels in"
+             << timer.elapsed() << "ms";
+    return true;
+}
+
+void GlyphAtlas::destroy() {
+    if (!m_functionsInitialized) {
+        return;
+    }
+
+    if (m_texture) {
+        glDeleteTextures(1, &m_texture);
+        m_texture = 0;
+    }
+}
@@ -0,0 +1,58 @@
+#ifndef GLYPHATLAS_HPP
+#define GLYPHATLAS_HPP
+
+#include <QChar>
+#include <QOpenGLExtraFunctions>
+#include <QSize>
+#include <QVector>
+
+/**
+ * @brief Signed distance field atlas of the glyphs used in vertex labels
+ *
+ * The digits and the prime mark are rasterized once at several times the atlas
+ * resolution, turned into a distance field with an exact Euclidean distance transform and
+ * stored downsampled in a single row of equal cells of an R8 texture. 0.5 lies on the glyph
+ * outline, and the field extends Spread texels to either side of it, so the shader can
+ * antialias and outline labels at any size from one bilinear sample.
+ */
+class GlyphAtlas : protected QOpenGLExtraFunctions {
+   public:
+    GlyphAtlas();
+    ~GlyphAtlas();
+
+    // Rasterizes the glyphs and uploads the field (requires a current OpenGL context)
+    bool create();
+    void destroy();
+    bool isCreated() const {
+        return m_texture != 0;
+    }
+
+    GLuint texture() const {
+        return m_texture;
+    }
+    int glyphCount() const {
+        return m_advances.size();
+    }
+    // Cell width over cell height
+    float cellAspect() const {
+        return m_cellSize.isEmpty() ? 1.0f : float(m_cellSize.width()) / m_cellSize.height();
+    }
+
+    // Atlas cell of a character, -1 if the atlas has no glyph for it
+    static int glyphIndex(QChar character);
+    // Pen advance after a glyph, in cell widths
+    float advance(int glyph) const {
+        return m_advances[glyph];
+    }
+
+   private:
+    static const int Spread = 4;       // Distance range either side of the outline, in texels
+    static const int Supersample = 4;  // Rasterization resolution relative to the atlas
+
+    bool m_functionsInitialized;
+    GLuint m_texture;
+    QSize m_cellSize;  // In atlas texels, padding included
+    QVector<float> m_advances;
+};
+
+#endif  // GLYPHATLAS_HPP
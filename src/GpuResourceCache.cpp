@@ -0,0 +1,213 @@
+#include "GpuResourceCache.hpp"
+
+#include <QDebug>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QOpenGLContext>
+#include <QOpenGLFunctions>
+#include <QPair>
+#include <QThread>
+#include <QWaitCondition>
+#include <QWeakPointer>
+
+#include "GeometryAtlas.hpp"
+#include "GlyphAtlas.hpp"
+#include "MeshCacheFile.hpp"
+#include "MeshData.hpp"
+#include "ModelMesh.hpp"
+#include "StlFile.hpp"
+
+// Weakly referenced resource; creating is set while a render thread builds it without
+// holding s_mutex
+template <typename T>
+struct ResourceSlot {
+    QWeakPointer<T> resource;
+    bool creating = false;
+};
+
+// Uploaded model of a source; the weak source pointer tells a reused address from the
+// same source
+template <typename Source>
+struct ModelSlot {
+    QWeakPointer<const Source> source;
+    ResourceSlot<ModelMesh> model;
+};
+
+template <typename Source>
+using ModelSlots = QHash<const Source*, ModelSlot<Source>>;
+
+// Resources of one context group, weakly referenced so that their holders decide when
+// they are destroyed
+struct GroupResources {
+    ResourceSlot<GeometryAtlas> geometryAtlas;
+    ResourceSlot<GlyphAtlas> glyphAtlas;
+    QHash<QPair<QThread*, QByteArray>, ResourceSlot<QOpenGLShaderProgram>> programs;
+    ModelSlots<MeshData> meshModels;
+    ModelSlots<StlFile> stlModels;
+    ModelSlots<MeshCacheFile> cachedModels;
+};
+
+// Guards s_groups. It is held only to look up and publish slots: resources are created
+// without it, so an upload in one window does not block the other render threads, and
+// threads asking for a slot that is being created wait on s_slotReady.
+static QMutex s_mutex;
+static QWaitCondition s_slotReady;
+static QHash<QOpenGLContextGroup*, GroupResources> s_groups;
+
+// Entry of the current context's group (requires s_mutex), removed with the group
+static GroupResources* currentGroup() {
+    QOpenGLContext* context = QOpenGLContext::currentContext();
+    if (!context) {
+        qDebug() << "ERROR: GPU resource cache used without a current OpenGL context";
+        return nullptr;
+    }
+
+    QOpenGLContextGroup* group = context->shareGroup();
+    if (!s_groups.contains(group)) {
+        QObject::connect(group, &QObject::destroyed, [group]() {
+            QMutexLocker locker(&s_mutex);
+            s_groups.remove(group);
+        });
+    }
+    return &s_groups[group];
+}
+
+// Strong reference to the resource in the slot slotOf() finds in the current group,
+// created first if no holder is left. slotOf() runs with s_mutex held and is asked again
+// after every unlock, since the hashes may have moved the slot in the meantime.
+template <typename T>
+static QSharedPointer<T> acquire(const std::function<ResourceSlot<T>*(GroupResources*)>& slotOf,
+                                 const std::function<T*()>& create) {
+    QMutexLocker locker(&s_mutex);
+    GroupResources* group = currentGroup();
+    if (!group) {
+        return QSharedPointer<T>();
+    }
+
+    ResourceSlot<T>* slot = slotOf(group);
+    while (slot->creating) {
+        s_slotReady.wait(&s_mutex);
+        slot = slotOf(currentGroup());
+    }
+    QSharedPointer<T> resource = slot->resource.toStrongRef();
+    if (resource) {
+        return resource;
+    }
+
+    slot->creating = true;
+    locker.unlock();
+    T* created = create();
+    if (created) {
+        // Other contexts of the group only see the uploaded contents once the commands
+        // that wrote them have completed
+        QOpenGLContext::currentContext()->functions()->glFinish();
+        resource = QSharedPointer<T>(created);
+    }
+    locker.relock();
+
+    // Published even if creation failed, so that a waiting thread tries again
+    slot = slotOf(currentGroup());
+    slot->creating = false;
+    slot->resource = resource;
+    s_slotReady.wakeAll();
+    return resource;
+}
+
+QSharedPointer<GeometryAtlas> GpuResourceCache::geometryAtlas() {
+    return acquire<GeometryAtlas>(
+        [](GroupResources* group) { return &group->geometryAtlas; },
+        []() -> GeometryAtlas* {
+            GeometryAtlas* atlas = new GeometryAtlas();
+            if (!atlas->create()) {
+                delete atlas;
+                return nullptr;
+            }
+            return atlas;
+        });
+}
+
+QSharedPointer<GlyphAtlas> GpuResourceCache::glyphAtlas() {
+    return acquire<GlyphAtlas>(
+        [](GroupResources* group) { return &group->glyphAtlas; },
+        []() -> GlyphAtlas* {
+            GlyphAtlas* atlas = new GlyphAtlas();
+            if (!atlas->create()) {
+                delete atlas;
+                return nullptr;
+            }
+            return atlas;
+        });
+}
+
+// Model slot of source in models (requires s_mutex)
+template <typename Source>
+static ResourceSlot<ModelMesh>* modelSlot(ModelSlots<Source>& models,
+                                          const QSharedPointer<const Source>& source) {
+    // Forget models whose holders are all gone
+    for (auto it = models.begin(); it != models.end();) {
+        if (it.value().model.resource.isNull() && !it.value().model.creating) {
+            it = models.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    ModelSlot<Source>& entry = models[source.data()];
+    if (entry.source.toStrongRef() != source) {
+        entry = ModelSlot<Source>();
+        entry.source = source.toWeakRef();
+    }
+    return &entry.model;
+}
+
+// Model uploaded from source, shared by every renderer of the group
+template <typename Source>
+static QSharedPointer<ModelMesh> acquireModel(ModelSlots<Source> GroupResources::*models,
+                                              const QSharedPointer<const Source>& source) {
+    if (!source) {
+        return QSharedPointer<ModelMesh>();
+    }
+    return acquire<ModelMesh>(
+        [models, &source](GroupResources* group) { return modelSlot(group->*models, source); },
+        [&source]() -> ModelMesh* {
+            ModelMesh* model = new ModelMesh();
+            if (!model->create(*source)) {
+                delete model;
+                return nullptr;
+            }
+            return model;
+        });
+}
+
+QSharedPointer<ModelMesh> GpuResourceCache::modelMesh(const QSharedPointer<const MeshData>& mesh) {
+    return acquireModel(&GroupResources::meshModels, mesh);
+}
+
+QSharedPointer<ModelMesh> GpuResourceCache::modelMesh(const QSharedPointer<const StlFile>& file) {
+    return acquireModel(&GroupResources::stlModels, file);
+}
+
+QSharedPointer<ModelMesh> GpuResourceCache::modelMesh(
+    const QSharedPointer<const MeshCacheFile>& file) {
+    return acquireModel(&GroupResources::cachedModels, file);
+}
+
+QSharedPointer<QOpenGLShaderProgram> GpuResourceCache::program(const QByteArray& key,
+                                                               const ProgramFactory& create) {
+    return acquire<QOpenGLShaderProgram>(
+        [&key](GroupResources* group) {
+            // Forget programs whose holders are all gone
+            for (auto it = group->programs.begin(); it != group->programs.end();) {
+                if (it.value().resource.isNull() && !it.value().creating) {
+                    it = group->programs.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+
+            // Uniform values live in the program, so each render thread gets its own
+            return &group->programs[qMakePair(QThread::currentThread(), key)];
+        },
+        create);
+}
@@ -0,0 +1,51 @@
+#ifndef GPURESOURCECACHE_HPP
+#define GPURESOURCECACHE_HPP
+
+#include <QByteArray>
+#include <QOpenGLShaderProgram>
+#include <QSharedPointer>
+#include <functional>
+
+class GeometryAtlas;
+class GlyphAtlas;
+class MeshCacheFile;
+class ModelMesh;
+class StlFile;
+struct MeshData;
+
+/**
+ * @brief Registry of the GPU resources every renderer of an OpenGL context group shares
+ *
+ * Renderers hold resources through QSharedPointer. The first renderer that asks for one
+ * creates it, later ones get the same object (waiting if it is still being created), and
+ * it is destroyed when the last holder lets go. Entries are kept per QOpenGLContextGroup.
+ * With Qt::AA_ShareOpenGLContexts set, every Qt Quick window shares one group, so another
+ * viewport only adds its own framebuffers, vertex array objects (never shared between
+ * contexts) and per-view buffers.
+ *
+ * Buffers and textures are not modified after creation and are shared by the whole group.
+ * Programs carry uniform values that renderers set right before each draw, so they are
+ * only shared between renderers on the same render thread (the viewports of one window);
+ * other windows load the same linked binary from the ProgramBinaryCache instead.
+ *
+ * All calls require a current OpenGL context. The last release happens on whichever render
+ * thread drops the final reference, which must have a context of the group current.
+ */
+class GpuResourceCache {
+   public:
+    using ProgramFactory = std::function<QOpenGLShaderProgram*()>;
+
+    // Shapes and the marker sphere (nullptr if the atlas could not be created)
+    static QSharedPointer<GeometryAtlas> geometryAtlas();
+    // Label glyph distance field (nullptr if the atlas could not be created)
+    static QSharedPointer<GlyphAtlas> glyphAtlas();
+    // Uploaded copy of a loaded model, one per source (nullptr if the upload failed)
+    static QSharedPointer<ModelMesh> modelMesh(const QSharedPointer<const MeshData>& mesh);
+    static QSharedPointer<ModelMesh> modelMesh(const QSharedPointer<const StlFile>& file);
+    static QSharedPointer<ModelMesh> modelMesh(const QSharedPointer<const MeshCacheFile>& file);
+    // Linked program for a source key, built by create() on first use (which may fail)
+    static QSharedPointer<QOpenGLShaderProgram> program(const QByteArray& key,
+                                                        const ProgramFactory& create);
+};
+
+#endif  // GPURESOURCECACHE_HPP
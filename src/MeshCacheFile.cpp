@@ -0,0 +1,340 @@
+#include "MeshCacheFile.hpp"
+
+#include <QCryptographicHash>
+#include <QDateTime>
+#include <QDebug>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <climits>
+#include <cstring>
+
+#include "CompactVertexFormat.hpp"
+#include "MeshData.hpp"
+
+// Bumped when the file layout or the loaders' output changes
+static const quint32 kCacheFileMagic = 0x434D524D;  // "MRMC"
+static const quint32 kCacheFileVersion = 3;
+
+static const char kCacheFileSuffix[] = ".mrmesh";
+// Vertices or indices packed per write() block
+static const int kWriteBlock = 1 << 16;
+// Of the vertex and index data inside the file
+static const qint64 kDataAlignment = 64;
+// More attributes than any layout uses, to reject garbage counts early
+static const quint32 kMaxAttributes = 16;
+
+// Start of every cache file, followed by the vertex attributes and the aligned data
+struct MeshCacheHeader {
+    quint32 magic;
+    quint32 version;
+    char key[40];  // Hex SHA-1 from sourceKey()
+    float minimum[3];
+    float maximum[3];
+    quint32 vertexCount;
+    quint32 indexCount;
+    quint32 attributeCount;
+    quint32 indexType;     // GL_UNSIGNED_SHORT or GL_UNSIGNED_INT
+    quint64 vertexOffset;  // From the start of the file, in bytes
+    quint64 vertexSize;
+    quint64 indexOffset;
+    quint64 indexSize;
+};
+Q_STATIC_ASSERT(sizeof(MeshCacheHeader) == 120);
+
+static qint64 alignUp(qint64 offset) {
+    return (offset + kDataAlignment - 1) / kDataAlignment * kDataAlignment;
+}
+
+// Bytes per vertex of one attribute, 0 for formats the renderer does not read
+static qint64 attributeSize(const VertexAttribute& attribute) {
+    if (attribute.components < 1 || attribute.components > 4) {
+        return 0;
+    }
+    switch (attribute.type) {
+        case GL_FLOAT:
+            return attribute.components * qint64(sizeof(float));
+        case GL_HALF_FLOAT:
+        case GL_SHORT:
+            return attribute.components * qint64(sizeof(qint16));
+        default:
+            return 0;
+    }
+}
+
+// Largest of count indices of type
+template <typename Index>
+static quint32 maxIndex(const uchar* data, int count) {
+    const Index* indices = reinterpret_cast<const Index*>(data);
+    quint32 maximum = 0;
+    for (int i = 0; i < count; ++i) {
+        maximum = qMax(maximum, quint32(indices[i]));
+    }
+    return maximum;
+}
+
+MeshCacheFile::MeshCacheFile()
+    : m_mapping(nullptr),
+      m_vertexData(nullptr),
+      m_indexData(nullptr),
+      m_vertexDataSize(0),
+      m_vertexCount(0),
+      m_indexCount(0),
+      m_indexType(GL_UNSIGNED_INT) {
+    for (int axis = 0; axis < 3; ++axis) {
+        m_minimum[axis] = 0.0f;
+        m_maximum[axis] = 0.0f;
+    }
+}
+
+MeshCacheFile::~MeshCacheFile() {
+    close();
+}
+
+QString MeshCacheFile::cachePath(const QString& sourcePath) {
+    QFileInfo source(sourcePath);
+    if (QFileInfo(source.absolutePath()).isWritable()) {
+        return source.absoluteFilePath() + QLatin1String(kCacheFileSuffix);
+    }
+
+    // Read-only model directories (e.g. a shared data set) are cached per user
+    QByteArray name = QCryptographicHash::hash(source.absoluteFilePath().toUtf8(),
+                                               QCryptographicHash::Sha1)
+                          .toHex();
+    return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) +
+           QStringLiteral("/meshes/") + QString::fromLatin1(name) +
+           QLatin1String(kCacheFileSuffix);
+}
+
+QByteArray MeshCacheFile::sourceKey(const QString& sourcePath, const QByteArray& options) {
+    QFileInfo source(sourcePath);
+    if (!source.isFile()) {
+        return QByteArray();
+    }
+
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    hash.addData(source.absoluteFilePath().toUtf8());
+    hash.addData(QByteArray(1, '\0'));
+    hash.addData(QByteArray::number(source.size()));
+    hash.addData(QByteArray(1, '\0'));
+    hash.addData(QByteArray::number(source.lastModified().toMSecsSinceEpoch()));
+    hash.addData(QByteArray(1, '\0'));
+    hash.addData(options);
+    return hash.result().toHex();
+}
+
+bool MeshCacheFile::write(const QString& filePath, const QByteArray& key, const MeshData& mesh,
+                          QString* errorMessage, const ProgressCallback& progress) {
+    QElapsedTimer timer;
+    timer.start();
+
+    auto fail = [&](const QString& message) {
+        qDebug() << "WARNING:" << message;
+        if (errorMessage) {
+            *errorMessage = message;
+        }
+        return false;
+    };
+
+    if (key.size() != int(sizeof(MeshCacheHeader::key))) {
+        return fail(QStringLiteral("Invalid mesh cache key"));
+    }
+    if (mesh.isEmpty() || mesh.normals.size() != mesh.positions.size()) {
+        return fail(QStringLiteral("Mesh cache needs triangles and one normal per vertex"));
+    }
+
+    // Packed like ModelMesh::create(const MeshData&) does, so loads upload as stored
+    const int vertexCount = mesh.vertexCount();
+    const int indexCount = mesh.indices.size();
+    const CompactVertexFormat::Positions format = CompactVertexFormat::choosePositions(
+        mesh.positions.constData(), 3, vertexCount, mesh.indices.constData(), indexCount);
+    const VertexLayout layout = CompactVertexFormat::layout(format);
+    const int vertexStride = CompactVertexFormat::stride(format);
+    const GLenum indexType = CompactVertexFormat::indexType(vertexCount);
+    const int indexSize = CompactVertexFormat::indexSize(indexType);
+
+    MeshCacheHeader header;
+    std::memset(&header, 0, sizeof(header));
+    header.magic = kCacheFileMagic;
+    header.version = kCacheFileVersion;
+    std::memcpy(header.key, key.constData(), sizeof(header.key));
+    mesh.bounds(header.minimum, header.maximum);
+    header.vertexCount = quint32(vertexCount);
+    header.indexCount = quint32(indexCount);
+    header.attributeCount = quint32(layout.size());
+    header.indexType = indexType;
+    const qint64 attributesEnd = sizeof(header) + layout.size() * sizeof(VertexAttribute);
+    header.vertexOffset = alignUp(attributesEnd);
+    header.vertexSize = quint64(vertexCount) * vertexStride;
+    header.indexOffset = alignUp(header.vertexOffset + header.vertexSize);
+    header.indexSize = quint64(indexCount) * indexSize;
+
+    // Written atomically, so a load running at the same time never maps a partial file
+    QDir().mkpath(QFileInfo(filePath).absolutePath());
+    QSaveFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly)) {
+        return fail(QStringLiteral("Cannot write %1: %2").arg(filePath, file.errorString()));
+    }
+
+    bool written = true;
+    auto put = [&](const void* data, qint64 size) {
+        written = written && file.write(static_cast<const char*>(data), size) == size;
+    };
+    auto padTo = [&](qint64 offset) {
+        const QByteArray zeros(offset - file.pos(), '\0');
+        put(zeros.constData(), zeros.size());
+    };
+    put(&header, sizeof(header));
+    put(layout.constData(), layout.size() * sizeof(VertexAttribute));
+
+    // Packed a block at a time, so the mesh is never held twice
+    const qint64 totalBlocks = (qint64(vertexCount) + kWriteBlock - 1) / kWriteBlock +
+                               (qint64(indexCount) + kWriteBlock - 1) / kWriteBlock;
+    qint64 writtenBlocks = 0;
+    bool cancelled = false;
+    auto nextBlock = [&]() {
+        ++writtenBlocks;
+        if (progress && !progress(double(writtenBlocks) / double(totalBlocks))) {
+            cancelled = true;
+        }
+    };
+    QByteArray block(qint64(kWriteBlock) * qMax(vertexStride, indexSize), Qt::Uninitialized);
+    uchar* blockData = reinterpret_cast<uchar*>(block.data());
+
+    padTo(header.vertexOffset);
+    for (int first = 0; first < vertexCount && written && !cancelled; first += kWriteBlock) {
+        const int count = qMin(kWriteBlock, vertexCount - first);
+        CompactVertexFormat::pack(format, mesh.positions.constData() + qint64(first) * 3,
+                                  mesh.normals.constData() + qint64(first) * 3, 3, count,
+                                  blockData);
+        put(blockData, qint64(count) * vertexStride);
+        nextBlock();
+    }
+    padTo(header.indexOffset);
+    for (int first = 0; first < indexCount && written && !cancelled; first += kWriteBlock) {
+        const int count = qMin(kWriteBlock, indexCount - first);
+        CompactVertexFormat::packIndices(mesh.indices.constData() + first, count, indexType,
+                                         blockData);
+        put(blockData, qint64(count) * indexSize);
+        nextBlock();
+    }
+
+    if (cancelled) {
+        file.cancelWriting();
+        return fail(QStringLiteral("Mesh cache writing cancelled"));
+    }
+    if (!written || !file.commit()) {
+        return fail(QStringLiteral("Cannot write %1: %2").arg(filePath, file.errorString()));
+    }
+
+    qDebug() << "Mesh cache written:" << filePath << "-" << (header.indexOffset + header.indexSize)
+             << "bytes in" << timer.elapsed() << "ms";
+    return true;
+}
+
+bool MeshCacheFile::open(const QString& filePath, const QByteArray& key) {
+    close();
+
+    m_file.setFileName(filePath);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        // No cache yet
+        return false;
+    }
+    auto reject = [&](const char* reason) {
+        qDebug() << "Mesh cache" << reason << "-" << filePath;
+        close();
+        return false;
+    };
+
+    const qint64 size = m_file.size();
+    if (size < qint64(sizeof(MeshCacheHeader))) {
+        return reject("damaged");
+    }
+    m_mapping = m_file.map(0, size);
+    if (!m_mapping) {
+        return reject("not mappable");
+    }
+
+    MeshCacheHeader header;
+    std::memcpy(&header, m_mapping, sizeof(header));
+    if (header.magic != kCacheFileMagic || header.version != kCacheFileVersion ||
+        key.size() != int(sizeof(header.key)) ||
+        std::memcmp(header.key, key.constData(), sizeof(header.key)) != 0) {
+        return reject("stale");
+    }
+
+    // Everything the renderer will read must lie inside the file
+    const quint64 fileSize = quint64(size);
+    const quint64 indexSize =
+        header.indexType == GL_UNSIGNED_SHORT || header.indexType == GL_UNSIGNED_INT
+            ? quint64(CompactVertexFormat::indexSize(header.indexType))
+            : 0;
+    if (indexSize == 0 || header.vertexCount == 0 || header.vertexCount > INT_MAX ||
+        header.indexCount == 0 || header.indexCount > INT_MAX || header.indexCount % 3 != 0 ||
+        header.attributeCount == 0 || header.attributeCount > kMaxAttributes ||
+        sizeof(header) + header.attributeCount * sizeof(VertexAttribute) > fileSize ||
+        header.vertexOffset % sizeof(float) != 0 || header.vertexOffset > fileSize ||
+        header.vertexSize > fileSize - header.vertexOffset ||
+        header.indexOffset % indexSize != 0 || header.indexOffset > fileSize ||
+        header.indexSize != quint64(header.indexCount) * indexSize ||
+        header.indexSize > fileSize - header.indexOffset) {
+        return reject("damaged");
+    }
+
+    m_layout.resize(header.attributeCount);
+    std::memcpy(m_layout.data(), m_mapping + sizeof(header),
+                header.attributeCount * sizeof(VertexAttribute));
+    for (const VertexAttribute& attribute : m_layout) {
+        qint64 elementSize = attributeSize(attribute);
+        if (elementSize == 0 || attribute.offset > header.vertexSize ||
+            quint64(header.vertexCount - 1) * attribute.stride + elementSize >
+                header.vertexSize - attribute.offset) {
+            return reject("damaged");
+        }
+    }
+
+    // Out of range indices would make the GPU read outside the vertex buffer
+    const uchar* indices = m_mapping + header.indexOffset;
+    const int indexCount = int(header.indexCount);
+    if ((header.indexType == GL_UNSIGNED_SHORT ? maxIndex<quint16>(indices, indexCount)
+                                               : maxIndex<quint32>(indices, indexCount)) >=
+        header.vertexCount) {
+        return reject("damaged");
+    }
+
+    m_vertexData = m_mapping + header.vertexOffset;
+    m_vertexDataSize = qint64(header.vertexSize);
+    m_indexData = m_mapping + header.indexOffset;
+    m_vertexCount = int(header.vertexCount);
+    m_indexCount = int(header.indexCount);
+    m_indexType = header.indexType;
+    for (int axis = 0; axis < 3; ++axis) {
+        m_minimum[axis] = header.minimum[axis];
+        m_maximum[axis] = header.maximum[axis];
+    }
+    return true;
+}
+
+void MeshCacheFile::close() {
+    if (m_mapping) {
+        m_file.unmap(m_mapping);
+        m_mapping = nullptr;
+    }
+    m_file.close();
+    m_vertexData = nullptr;
+    m_indexData = nullptr;
+    m_vertexDataSize = 0;
+    m_vertexCount = 0;
+    m_indexCount = 0;
+    m_indexType = GL_UNSIGNED_INT;
+    m_layout.clear();
+}
+
+void MeshCacheFile::bounds(float minimum[3], float maximum[3]) const {
+    for (int axis = 0; axis < 3; ++axis) {
+        minimum[axis] = m_minimum[axis];
+        maximum[axis] = m_maximum[axis];
+    }
+}
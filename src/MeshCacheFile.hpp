@@ -0,0 +1,97 @@
+#ifndef MESHCACHEFILE_HPP
+#define MESHCACHEFILE_HPP
+
+#include <QByteArray>
+#include <QFile>
+#include <QString>
+#include <functional>
+
+#include "VertexLayout.hpp"
+
+struct MeshData;
+
+/**
+ * @brief Memory-mapped preprocessed model, uploaded to the GPU without parsing
+ *
+ * Parsing an OBJ file or welding an STL file takes seconds for large models, so the result
+ * is written once with write() to a cache file next to the source (cachePath()). The file
+ * holds a header with the source key, the bounds and the counts, the vertex layout, and
+ * the vertex and index data packed in the CompactVertexFormat as they go into the GPU
+ * buffers, each aligned for direct upload. Later loads open() and map it, check the key,
+ * and ModelMesh uploads straight from the mapping.
+ *
+ * Files are written in host byte order; on a host with the other one the magic does not
+ * match and the model is parsed again.
+ */
+class MeshCacheFile {
+   public:
+    MeshCacheFile();
+    ~MeshCacheFile();
+
+    // Cache file of a model: next to it, or in the user cache directory if that directory
+    // is not writable
+    static QString cachePath(const QString& sourcePath);
+    // Identifies the source version and the load options (the size and modification time
+    // stand in for the contents, so a hit never reads the source). Empty if it is missing.
+    static QByteArray sourceKey(const QString& sourcePath, const QByteArray& options);
+    // Receives the fraction written so far; returning false cancels the write
+    using ProgressCallback = std::function<bool(double)>;
+
+    // Stores a normalized mesh atomically (errorMessage, if given, receives the reason of
+    // a failure)
+    static bool write(const QString& filePath, const QByteArray& key, const MeshData& mesh,
+                      QString* errorMessage = nullptr,
+                      const ProgressCallback& progress = ProgressCallback());
+
+    // Maps a cache file written for key; false if it is missing, stale or damaged
+    bool open(const QString& filePath, const QByteArray& key);
+    void close();
+    bool isOpen() const {
+        return m_mapping != nullptr;
+    }
+
+    int vertexCount() const {
+        return m_vertexCount;
+    }
+    int indexCount() const {
+        return m_indexCount;
+    }
+    int triangleCount() const {
+        return m_indexCount / 3;
+    }
+    // Axis-aligned bounds of the stored positions
+    void bounds(float minimum[3], float maximum[3]) const;
+
+    // Vertex buffer contents, laid out as layout() describes
+    const VertexLayout& layout() const {
+        return m_layout;
+    }
+    const uchar* vertexData() const {
+        return m_vertexData;
+    }
+    qint64 vertexDataSize() const {
+        return m_vertexDataSize;
+    }
+    // Index buffer contents, of indexType()
+    const uchar* indexData() const {
+        return m_indexData;
+    }
+    GLenum indexType() const {
+        return m_indexType;
+    }
+
+   private:
+    QFile m_file;
+    uchar* m_mapping;
+    const uchar* m_vertexData;  // Inside the mapping
+    const uchar* m_indexData;
+    qint64 m_vertexDataSize;
+    int m_vertexCount;
+    int m_indexCount;
+    GLenum m_indexType;
+    float m_minimum[3];
+    float m_maximum[3];
+    VertexLayout m_layout;
+};
+
+#endif  // MESHCACHEFILE_HPP
@@ -0,0 +1,87 @@
+#include "MeshData.hpp"
+
+#include <cmath>
+
+void MeshData::bounds(float minimum[3], float maximum[3]) const {
+    for (int axis = 0; axis < 3; ++axis) {
+        minimum[axis] = positions.size() >= 3 ? positions[axis] : 0.0f;
+        maximum[axis] = minimum[axis];
+    }
+
+    const float* position = positions.constData();
+    for (int vertex = 0; vertex < vertexCount(); ++vertex, position += 3) {
+        for (int axis = 0; axis < 3; ++axis) {
+            minimum[axis] = qMin(minimum[axis], position[axis]);
+            maximum[axis] = qMax(maximum[axis], position[axis]);
+        }
+    }
+}
+
+void MeshData::computeNormals() {
+    normals.fill(0.0f, positions.size());
+
+    // The unnormalized cross product is twice the triangle area, which weights it
+    const float* p = positions.constData();
+    float* n = normals.data();
+    for (int triangle = 0; triangle < triangleCount(); ++triangle) {
+        const unsigned int a = indices[triangle * 3] * 3;
+        const unsigned int b = indices[triangle * 3 + 1] * 3;
+        const unsigned int c = indices[triangle * 3 + 2] * 3;
+
+        const float e1[3] = {p[b] - p[a], p[b + 1] - p[a + 1], p[b + 2] - p[a + 2]};
+        const float e2[3] = {p[c] - p[a], p[c + 1] - p[a + 1], p[c + 2] - p[a + 2]};
+        const float face[3] = {e1[1] * e2[2] - e1[2] * e2[1], e1[2] * e2[0] - e1[0] * e2[2],
+                               e1[0] * e2[1] - e1[1] * e2[0]};
+
+        for (int axis = 0; axis < 3; ++axis) {
+            n[a + axis] += face[axis];
+            n[b + axis] += face[axis];
+            n[c + axis] += face[axis];
+        }
+    }
+
+    for (int vertex = 0; vertex < vertexCount(); ++vertex, n += 3) {
+        float length = std::sqrt(n[0] * n[0] + n[1] * n[1] + n[2] * n[2]);
+        if (length > 0.0f) {
+            n[0] /= length;
+            n[1] /= length;
+            n[2] /= length;
+        } else {
+            // Vertices without any (non-degenerate) triangle
+            n[0] = 0.0f;
+            n[1] = 1.0f;
+            n[2] = 0.0f;
+        }
+    }
+}
+
+void MeshData::normalize(float radius) {
+    if (positions.isEmpty()) {
+        return;
+    }
+
+    float minimum[3];
+    float maximum[3];
+    bounds(minimum, maximum);
+    const float center[3] = {(minimum[0] + maximum[0]) * 0.5f, (minimum[1] + maximum[1]) * 0.5f,
+                             (minimum[2] + maximum[2]) * 0.5f};
+
+    float maxDistanceSquared = 0.0f;
+    float* position = positions.data();
+    for (int vertex = 0; vertex < vertexCount(); ++vertex, position += 3) {
+        position[0] -= center[0];
+        position[1] -= center[1];
+        position[2] -= center[2];
+        maxDistanceSquared =
+            qMax(maxDistanceSquared, position[0] * position[0] + position[1] * position[1] +
+                                         position[2] * position[2]);
+    }
+
+    if (maxDistanceSquared <= 0.0f) {
+        return;
+    }
+    const float scale = radius / std::sqrt(maxDistanceSquared);
+    for (float& coordinate : positions) {
+        coordinate *= scale;
+    }
+}
@@ -0,0 +1,38 @@
+#ifndef MESHDATA_HPP
+#define MESHDATA_HPP
+
+#include <QVector>
+
+/**
+ * @brief Indexed triangle mesh loaded from a model file, kept on the CPU
+ *
+ * Positions and normals are stored as packed xyz triples, one of each per vertex, and
+ * every three indices form a triangle. Loaders fill the arrays; normalize() then fits the
+ * mesh into the unit sphere the built-in research shapes are sized for.
+ */
+struct MeshData {
+    QVector<float> positions;
+    QVector<float> normals;
+    QVector<unsigned int> indices;
+
+    int vertexCount() const {
+        return positions.size() / 3;
+    }
+    int triangleCount() const {
+        return indices.size() / 3;
+    }
+    bool isEmpty() const {
+        return indices.isEmpty();
+    }
+
+    // Axis-aligned bounds of all positions (zero for an empty mesh)
+    void bounds(float minimum[3], float maximum[3]) const;
+
+    // Smooth normals from the area-weighted normals of the triangles around each vertex
+    void computeNormals();
+
+    // Centers the bounding box on the origin and scales the mesh into a sphere of radius
+    void normalize(float radius = 1.0f);
+};
+
+#endif  // MESHDATA_HPP
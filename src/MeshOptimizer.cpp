@@ -0,0 +1,246 @@
+#include "MeshOptimizer.hpp"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <algorithm>
+#include <climits>
+#include <cmath>
+#include <cstring>
+
+// Forsyth's scoring: recently used vertices score high (the last triangle's a little
+// less, so strips do not run on forever), and so do vertices with few triangles left,
+// which finishes them off before they are evicted
+static const float kCacheDecayPower = 1.5f;
+static const float kLastTriangleScore = 0.75f;
+static const float kValenceBoostScale = 2.0f;
+static const float kValenceBoostPower = 0.5f;
+// Remaining valences with a precomputed score, larger ones are rare
+static const int kMaxTableValence = 32;
+
+// Marks vertices optimizeVertexFetch() has not numbered yet
+static const unsigned int kUnnumbered = UINT_MAX;
+
+struct ForsythTables {
+    float cache[MeshOptimizer::CacheSize];
+    float valence[kMaxTableValence + 1];
+
+    ForsythTables() {
+        const int size = MeshOptimizer::CacheSize;
+        for (int position = 0; position < size; ++position) {
+            cache[position] = position < 3
+                                  ? kLastTriangleScore
+                                  : std::pow(1.0f - float(position - 3) / (size - 3),
+                                             kCacheDecayPower);
+        }
+        valence[0] = 0.0f;
+        for (int remaining = 1; remaining <= kMaxTableValence; ++remaining) {
+            valence[remaining] =
+                kValenceBoostScale * std::pow(float(remaining), -kValenceBoostPower);
+        }
+    }
+};
+
+// Score of a vertex at cachePosition (-1: not cached) with remaining triangles to emit
+static inline float vertexScore(const ForsythTables& tables, int cachePosition, int remaining) {
+    if (remaining == 0) {
+        return -1.0f;
+    }
+    float score = cachePosition >= 0 ? tables.cache[cachePosition] : 0.0f;
+    return score + (remaining <= kMaxTableValence
+                        ? tables.valence[remaining]
+                        : kValenceBoostScale * std::pow(float(remaining), -kValenceBoostPower));
+}
+
+double MeshOptimizer::acmr(const unsigned int* indices, int indexCount, int vertexCount,
+                           int cacheSize) {
+    if (indexCount < 3) {
+        return 0.0;
+    }
+
+    // The FIFO holds the last cacheSize vertices loaded, numbered by the miss that loaded them
+    QVector<int> loadedAt(vertexCount, -1);
+    int misses = 0;
+    for (int i = 0; i < indexCount; ++i) {
+        int& loaded = loadedAt[indices[i]];
+        if (loaded < 0 || misses - loaded > cacheSize) {
+            loaded = misses++;
+        }
+    }
+    return double(misses) / (indexCount / 3);
+}
+
+void MeshOptimizer::optimizeVertexCache(unsigned int* indices, int indexCount, int vertexCount) {
+    const int triangleCount = indexCount / 3;
+    if (triangleCount < 2 || vertexCount <= 0) {
+        return;
+    }
+    static const ForsythTables tables;
+
+    // Triangles around every vertex, in one array sliced by vertex. The first remaining[v]
+    // entries of a slice are the triangles of v not emitted yet.
+    QVector<int> remaining(vertexCount, 0);
+    for (int i = 0; i < triangleCount * 3; ++i) {
+        remaining[indices[i]]++;
+    }
+    QVector<int> offsets(vertexCount);
+    int offset = 0;
+    for (int vertex = 0; vertex < vertexCount; ++vertex) {
+        offsets[vertex] = offset;
+        offset += remaining[vertex];
+    }
+    QVector<int> adjacency(triangleCount * 3);
+    QVector<int> filled = offsets;
+    for (int triangle = 0; triangle < triangleCount; ++triangle) {
+        for (int corner = 0; corner < 3; ++corner) {
+            adjacency[filled[indices[triangle * 3 + corner]]++] = triangle;
+        }
+    }
+
+    QVector<int> cachePosition(vertexCount, -1);
+    QVector<float> score(vertexCount);
+    for (int vertex = 0; vertex < vertexCount; ++vertex) {
+        score[vertex] = vertexScore(tables, -1, remaining[vertex]);
+    }
+    auto triangleScore = [&](int triangle) {
+        const unsigned int* corners = indices + triangle * 3;
+        return score[corners[0]] + score[corners[1]] + score[corners[2]];
+    };
+
+    // Starts with the best triangle of all, lowest valences first
+    int best = 0;
+    float bestScore = triangleScore(0);
+    for (int triangle = 1; triangle < triangleCount; ++triangle) {
+        float candidate = triangleScore(triangle);
+        if (candidate > bestScore) {
+            best = triangle;
+            bestScore = candidate;
+        }
+    }
+
+    QVector<unsigned int> ordered(triangleCount * 3);
+    QVector<char> emitted(triangleCount, 0);
+    int cache[CacheSize + 3];
+    int nextCache[CacheSize + 3];
+    int cacheCount = 0;
+    int deadEndCursor = 0;  // Triangles before it are all emitted
+    for (int output = 0; output < triangleCount; ++output) {
+        if (best < 0) {
+            // No cached vertex has triangles left: continue in input order
+            while (emitted[deadEndCursor]) {
+                ++deadEndCursor;
+            }
+            best = deadEndCursor;
+        }
+
+        const unsigned int* corners = indices + best * 3;
+        std::memcpy(ordered.data() + output * 3, corners, 3 * sizeof(unsigned int));
+        emitted[best] = 1;
+
+        // Leaves the slices of its vertices
+        for (int corner = 0; corner < 3; ++corner) {
+            const unsigned int vertex = corners[corner];
+            int* slice = adjacency.data() + offsets[vertex];
+            int& count = remaining[vertex];
+            for (int i = 0; i < count; ++i) {
+                if (slice[i] == best) {
+                    slice[i] = slice[count - 1];
+                    --count;
+                    break;
+                }
+            }
+        }
+
+        // Its vertices move to the front of the LRU cache, the others shift back
+        int nextCount = 0;
+        for (int corner = 0; corner < 3; ++corner) {
+            const int vertex = int(corners[corner]);
+            if (std::find(nextCache, nextCache + nextCount, vertex) == nextCache + nextCount) {
+                nextCache[nextCount++] = vertex;
+            }
+        }
+        for (int i = 0; i < cacheCount; ++i) {
+            const int vertex = cache[i];
+            if (vertex != int(corners[0]) && vertex != int(corners[1]) &&
+                vertex != int(corners[2])) {
+                nextCache[nextCount++] = vertex;
+            }
+        }
+        // The ones pushed out lose their cache score
+        for (int i = 0; i < nextCount; ++i) {
+            const int vertex = nextCache[i];
+            cachePosition[vertex] = i < CacheSize ? i : -1;
+            score[vertex] = vertexScore(tables, cachePosition[vertex], remaining[vertex]);
+        }
+        cacheCount = qMin(nextCount, int(CacheSize));
+        std::memcpy(cache, nextCache, cacheCount * sizeof(int));
+
+        // Next is the best triangle left around the cached vertices
+        best = -1;
+        bestScore = 0.0f;
+        for (int i = 0; i < cacheCount; ++i) {
+            const int vertex = cache[i];
+            const int* slice = adjacency.constData() + offsets[vertex];
+            for (int j = 0; j < remaining[vertex]; ++j) {
+                float candidate = triangleScore(slice[j]);
+                if (candidate > bestScore) {
+                    best = slice[j];
+                    bestScore = candidate;
+                }
+            }
+        }
+    }
+
+    std::memcpy(indices, ordered.constData(), triangleCount * 3 * sizeof(unsigned int));
+}
+
+QVector<unsigned int> MeshOptimizer::optimizeVertexFetch(unsigned int* indices, int indexCount,
+                                                         int vertexCount) {
+    QVector<unsigned int> remap(vertexCount, kUnnumbered);
+    unsigned int next = 0;
+    for (int i = 0; i < indexCount; ++i) {
+        unsigned int& number = remap[indices[i]];
+        if (number == kUnnumbered) {
+            number = next++;
+        }
+        indices[i] = number;
+    }
+    for (unsigned int& number : remap) {
+        if (number == kUnnumbered) {
+            number = next++;
+        }
+    }
+    return remap;
+}
+
+void MeshOptimizer::remapVertices(float* vertices, int components, int vertexCount,
+                                  const QVector<unsigned int>& remap) {
+    const QVector<float> original(vertices, vertices + qint64(vertexCount) * components);
+    for (int vertex = 0; vertex < vertexCount; ++vertex) {
+        std::memcpy(vertices + qint64(remap[vertex]) * components,
+                    original.constData() + qint64(vertex) * components,
+                    components * sizeof(float));
+    }
+}
+
+void MeshOptimizer::optimize(MeshData& mesh) {
+    if (mesh.isEmpty()) {
+        return;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    const int vertexCount = mesh.vertexCount();
+    const double before = acmr(mesh.indices.constData(), mesh.indices.size(), vertexCount);
+    optimizeVertexCache(mesh.indices.data(), mesh.indices.size(), vertexCount);
+    QVector<unsigned int> remap =
+        optimizeVertexFetch(mesh.indices.data(), mesh.indices.size(), vertexCount);
+    remapVertices(mesh.positions.data(), 3, vertexCount, remap);
+    if (mesh.normals.size() == mesh.positions.size()) {
+        remapVertices(mesh.normals.data(), 3, vertexCount, remap);
+    }
+
+    qDebug() << "Mesh optimized - ACMR:" << before << "->"
+             << acmr(mesh.indices.constData(), mesh.indices.size(), vertexCount) << "in"
+             << timer.elapsed() << "ms";
+}
@@ -0,0 +1,48 @@
+#ifndef MESHOPTIMIZER_HPP
+#define MESHOPTIMIZER_HPP
+
+#include <QVector>
+
+#include "MeshData.hpp"
+
+/**
+ * @brief Reorders indexed triangle meshes for the GPU vertex caches
+ *
+ * Scanned and generated meshes come in an order that revisits the same vertices far apart,
+ * so the post-transform cache rarely hits and the vertex shader runs for most corners.
+ * optimizeVertexCache() reorders the triangles with Forsyth's linear-speed algorithm,
+ * which greedily emits the triangle whose vertices score best for a simulated LRU cache
+ * and low remaining valence. optimizeVertexFetch() then renumbers the vertices in the
+ * order the triangles first use them, so vertex fetches walk the buffers forward.
+ *
+ * Both keep every triangle with its winding; only orders and numbers change. Quality is
+ * measured as the ACMR (average cache miss ratio): shaded vertices per triangle for a
+ * FIFO cache of AcmrCacheSize entries, between 0.5 for ideal grids and 3 for no reuse.
+ */
+class MeshOptimizer {
+   public:
+    // Entries of the LRU cache optimizeVertexCache() plans for
+    static const int CacheSize = 32;
+    // Entries of the FIFO cache acmr() simulates, like common post-transform caches
+    static const int AcmrCacheSize = 16;
+
+    // Shaded vertices per triangle when drawing indices in order
+    static double acmr(const unsigned int* indices, int indexCount, int vertexCount,
+                       int cacheSize = AcmrCacheSize);
+
+    // Reorders the triangles in place (indices below vertexCount)
+    static void optimizeVertexCache(unsigned int* indices, int indexCount, int vertexCount);
+
+    // Renumbers vertices in first-use order, in place; unreferenced vertices go last.
+    // Returns the new number of every old vertex, for remapVertices().
+    static QVector<unsigned int> optimizeVertexFetch(unsigned int* indices, int indexCount,
+                                                     int vertexCount);
+    // Moves every vertex of components floats to its number from optimizeVertexFetch()
+    static void remapVertices(float* vertices, int components, int vertexCount,
+                              const QVector<unsigned int>& remap);
+
+    // Both orders applied to a mesh, with the ACMR before and after logged
+    static void optimize(MeshData& mesh);
+};
+
+#endif  // MESHOPTIMIZER_HPP
@@ -0,0 +1,225 @@
+#include "ModelMesh.hpp"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QOpenGLVertexArrayObject>
+#include <climits>
+#include <functional>
+
+#include "CompactVertexFormat.hpp"
+#include "MeshCacheFile.hpp"
+#include "MeshData.hpp"
+#include "StlFile.hpp"
+
+ModelMesh::ModelMesh()
+    : m_vertexBuffer(QOpenGLBuffer::VertexBuffer),
+      m_indexBuffer(QOpenGLBuffer::IndexBuffer),
+      m_vertexCount(0),
+      m_indexCount(0),
+      m_indexType(GL_UNSIGNED_INT) {}
+
+ModelMesh::~ModelMesh() {
+    destroy();
+}
+
+bool ModelMesh::allocateVertices(qint64 vertexCount, const VertexLayout& layout, qint64 bytes,
+                                 const void* data) {
+    // QOpenGLBuffer sizes are ints
+    if (bytes > INT_MAX) {
+        qDebug() << "ERROR: Model too large for one vertex buffer:" << vertexCount << "vertices";
+        return false;
+    }
+
+    initializeOpenGLFunctions();
+    if (!m_vertexBuffer.create()) {
+        qDebug() << "ERROR: Failed to create model vertex buffer";
+        return false;
+    }
+    m_vertexBuffer.setUsagePattern(QOpenGLBuffer::StaticDraw);
+    m_vertexBuffer.bind();
+    if (data) {
+        m_vertexBuffer.allocate(data, int(bytes));
+    } else {
+        m_vertexBuffer.allocate(int(bytes));
+    }
+    m_vertexCount = int(vertexCount);
+    m_layout = layout;
+    return true;
+}
+
+bool ModelMesh::fillVertices(const std::function<void(uchar*)>& fill) {
+    // Written straight into the buffer mapping, with no staging copy in between
+    uchar* vertices = static_cast<uchar*>(m_vertexBuffer.mapRange(
+        0, m_vertexBuffer.size(),
+        QOpenGLBuffer::RangeWrite | QOpenGLBuffer::RangeInvalidateBuffer));
+    if (!vertices) {
+        qDebug() << "ERROR: Failed to map model vertex buffer";
+        m_vertexBuffer.release();
+        return false;
+    }
+    fill(vertices);
+    bool intact = m_vertexBuffer.unmap();
+    m_vertexBuffer.release();
+    if (!intact) {
+        // The buffer store was lost while mapped (e.g. on a display mode change)
+        qDebug() << "ERROR: Model vertex buffer corrupted during upload";
+        return false;
+    }
+    return true;
+}
+
+bool ModelMesh::uploadIndices(const void* data, int indexCount, GLenum type) {
+    const qint64 bytes = qint64(indexCount) * CompactVertexFormat::indexSize(type);
+    if (bytes > INT_MAX) {
+        qDebug() << "ERROR: Model too large for one index buffer:" << indexCount << "indices";
+        return false;
+    }
+
+    // The element array binding is vertex array state, so a temporary VAO is bound
+    QOpenGLVertexArrayObject uploadVao;
+    if (!uploadVao.create()) {
+        qDebug() << "ERROR: Failed to create model upload VAO";
+        return false;
+    }
+    uploadVao.bind();
+    m_indexBuffer.create();
+    m_indexBuffer.setUsagePattern(QOpenGLBuffer::StaticDraw);
+    m_indexBuffer.bind();
+    m_indexBuffer.allocate(data, int(bytes));
+    m_indexBuffer.release();
+    uploadVao.release();
+    uploadVao.destroy();
+
+    m_indexCount = indexCount;
+    m_indexType = type;
+    return true;
+}
+
+bool ModelMesh::create(const MeshData& mesh) {
+    if (isCreated()) {
+        return true;
+    }
+    if (mesh.isEmpty() || mesh.normals.size() != mesh.positions.size()) {
+        qDebug() << "ERROR: Model mesh needs triangles and one normal per vertex";
+        return false;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    const int vertexCount = mesh.vertexCount();
+    const CompactVertexFormat::Positions format = CompactVertexFormat::choosePositions(
+        mesh.positions.constData(), 3, vertexCount, mesh.indices.constData(),
+        mesh.indices.size());
+    if (!allocateVertices(vertexCount, CompactVertexFormat::layout(format),
+                          qint64(vertexCount) * CompactVertexFormat::stride(format))) {
+        return false;
+    }
+    bool filled = fillVertices([&mesh, format, vertexCount](uchar* vertices) {
+        CompactVertexFormat::pack(format, mesh.positions.constData(), mesh.normals.constData(),
+                                  3, vertexCount, vertices);
+    });
+
+    const GLenum indexType = CompactVertexFormat::indexType(vertexCount);
+    QByteArray indices(qint64(mesh.indices.size()) * CompactVertexFormat::indexSize(indexType),
+                       Qt::Uninitialized);
+    CompactVertexFormat::packIndices(mesh.indices.constData(), mesh.indices.size(), indexType,
+                                     reinterpret_cast<uchar*>(indices.data()));
+    if (!filled || !uploadIndices(indices.constData(), mesh.indices.size(), indexType)) {
+        destroy();
+        return false;
+    }
+
+    qDebug() << "Model mesh uploaded - Vertices:" << vertexCount
+             << "Triangles:" << mesh.triangleCount() << "Vertex bytes:"
+             << CompactVertexFormat::stride(format) << "Index bytes:"
+             << CompactVertexFormat::indexSize(indexType) << "in" << timer.elapsed() << "ms";
+    return true;
+}
+
+bool ModelMesh::create(const StlFile& file) {
+    if (isCreated()) {
+        return true;
+    }
+    // Unindexed, so every corner is its own vertex and float positions are kept
+    const CompactVertexFormat::Positions format = CompactVertexFormat::FloatPositions;
+    if (!file.isOpen() ||
+        !allocateVertices(file.vertexCount(), CompactVertexFormat::layout(format),
+                          qint64(file.vertexCount()) * CompactVertexFormat::stride(format))) {
+        return false;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    // Expanded from the file mapping into the buffer mapping
+    if (!fillVertices([&file](uchar* vertices) { file.writeVertices(vertices); })) {
+        destroy();
+        return false;
+    }
+
+    m_indexCount = 0;
+    qDebug() << "Model mesh streamed - Triangles:" << file.triangleCount() << "in"
+             << timer.elapsed() << "ms";
+    return true;
+}
+
+bool ModelMesh::create(const MeshCacheFile& file) {
+    if (isCreated()) {
+        return true;
+    }
+    if (!file.isOpen()) {
+        return false;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    // Straight from the file mapping, as the loader left it
+    if (!allocateVertices(file.vertexCount(), file.layout(), file.vertexDataSize(),
+                          file.vertexData())) {
+        return false;
+    }
+    m_vertexBuffer.release();
+    if (!uploadIndices(file.indexData(), file.indexCount(), file.indexType())) {
+        destroy();
+        return false;
+    }
+
+    qDebug() << "Model mesh uploaded from cache - Vertices:" << file.vertexCount()
+             << "Triangles:" << file.triangleCount() << "in" << timer.elapsed() << "ms";
+    return true;
+}
+
+void ModelMesh::destroy() {
+    m_vertexBuffer.destroy();
+    m_indexBuffer.destroy();
+    m_vertexCount = 0;
+    m_indexCount = 0;
+    m_layout.clear();
+}
+
+void ModelMesh::setupVertexAttributes() {
+    // The element array binding is recorded in the bound VAO, the array buffer is not
+    if (m_indexBuffer.isCreated()) {
+        m_indexBuffer.bind();
+    }
+
+    m_vertexBuffer.bind();
+    for (const VertexAttribute& attribute : m_layout) {
+        glEnableVertexAttribArray(attribute.location);
+        glVertexAttribPointer(attribute.location, GLint(attribute.components),
+                              GLenum(attribute.type), attribute.normalized ? GL_TRUE : GL_FALSE,
+                              GLsizei(attribute.stride),
+                              reinterpret_cast<const void*>(qintptr(attribute.offset)));
+    }
+    m_vertexBuffer.release();
+}
+
+void ModelMesh::draw() {
+    if (m_indexCount > 0) {
+        glDrawElements(GL_TRIANGLES, m_indexCount, m_indexType, nullptr);
+    } else {
+        glDrawArrays(GL_TRIANGLES, 0, m_vertexCount);
+    }
+}
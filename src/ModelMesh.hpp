@@ -0,0 +1,67 @@
+#ifndef MODELMESH_HPP
+#define MODELMESH_HPP
+
+#include <QOpenGLBuffer>
+#include <QOpenGLExtraFunctions>
+#include <functional>
+
+#include "VertexLayout.hpp"
+
+class MeshCacheFile;
+struct MeshData;
+class StlFile;
+
+/**
+ * @brief GPU copy of a loaded model
+ *
+ * Vertices are interleaved in the CompactVertexFormat, chosen per mesh on upload.
+ * Indexed meshes (MeshData) are packed straight into the mapped vertex buffer and add an
+ * index buffer of 16-bit indices where the vertex count allows; binary STL files are
+ * expanded straight from their mapping and drawn without indices. Cached models
+ * (MeshCacheFile) are already packed and are uploaded from their mapping as stored, with
+ * the vertex layout and index type the file describes. Like the GeometryAtlas, the buffers
+ * are shared through the GpuResourceCache and each renderer points its own vertex array
+ * object at them with setupVertexAttributes(), using the same attribute locations as the
+ * atlas.
+ */
+class ModelMesh : protected QOpenGLExtraFunctions {
+   public:
+    ModelMesh();
+    ~ModelMesh();
+
+    // Uploads the mesh (requires a current OpenGL context)
+    bool create(const MeshData& mesh);
+    bool create(const StlFile& file);
+    bool create(const MeshCacheFile& file);
+    void destroy();
+    bool isCreated() const {
+        return m_vertexBuffer.isCreated();
+    }
+
+    int triangleCount() const {
+        return (m_indexCount > 0 ? m_indexCount : m_vertexCount) / 3;
+    }
+
+    // Points the layout's attributes of the currently bound VAO at the model buffers
+    void setupVertexAttributes();
+    // Drawing, with a vertex array object set up by setupVertexAttributes() bound
+    void draw();
+
+   private:
+    // Allocates the vertex buffer for vertexCount vertices of layout, left bound and
+    // filled from data if given
+    bool allocateVertices(qint64 vertexCount, const VertexLayout& layout, qint64 bytes,
+                          const void* data = nullptr);
+    // Maps the vertex buffer for fill() to write, then unmaps and releases it
+    bool fillVertices(const std::function<void(uchar*)>& fill);
+    bool uploadIndices(const void* data, int indexCount, GLenum type);
+
+    QOpenGLBuffer m_vertexBuffer;
+    QOpenGLBuffer m_indexBuffer;
+    int m_vertexCount;
+    int m_indexCount;  // 0: drawn without indices
+    GLenum m_indexType;
+    VertexLayout m_layout;
+};
+
+#endif  // MODELMESH_HPP
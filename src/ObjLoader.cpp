@@ -0,0 +1,521 @@
+#include "ObjLoader.hpp"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QHash>
+#include <QPair>
+#include <QVarLengthArray>
+#include <QtConcurrent>
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cmath>
+#include <cstring>
+
+// Share of the progress range spent parsing, the rest is merging
+static const double kParseShare = 0.9;
+
+// Normal index of a corner that has none
+static const int kNoNormal = INT_MIN;
+
+// One face corner. Relative indices are offsets from the first vertex of the chunk, which
+// is only known after every chunk has been parsed.
+struct ObjCorner {
+    enum Flags { RelativePosition = 1, RelativeNormal = 2 };
+
+    int position;
+    int normal;
+    int flags;
+};
+
+// One line-aligned slice of the file and what was parsed from it
+struct ObjChunk {
+    const char* begin = nullptr;
+    const char* end = nullptr;
+
+    QVector<float> positions;
+    QVector<float> normals;
+    QVector<ObjCorner> corners;  // Three per triangle
+
+    // Where the chunk's data goes in the merged arrays
+    int firstPosition = 0;
+    int firstNormal = 0;
+    int firstCorner = 0;
+
+    QString error;
+    const char* errorAt = nullptr;  // Start of the offending line, if known
+};
+
+static inline bool isDigit(char c) {
+    return c >= '0' && c <= '9';
+}
+
+static inline bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r';
+}
+
+static inline void skipSpaces(const char*& p, const char* end) {
+    while (p < end && isSpace(*p)) {
+        ++p;
+    }
+}
+
+static double scaleByPowerOfTen(double value, int exponent) {
+    // Exactly representable, so small exponents round once like strtod
+    static const double kPowers[] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,  1e6,  1e7,
+                                     1e8,  1e9,  1e10, 1e11, 1e12, 1e13, 1e14, 1e15,
+                                     1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+    if (exponent >= 0 && exponent <= 22) {
+        return value * kPowers[exponent];
+    }
+    if (exponent < 0 && exponent >= -22) {
+        return value / kPowers[-exponent];
+    }
+    return value * std::pow(10.0, exponent);
+}
+
+// Decimal number in fixed or exponent notation, followed by a space or the line end.
+// Much faster than strtod, which also honours the C locale.
+static bool parseFloat(const char*& p, const char* end, float& value) {
+    skipSpaces(p, end);
+
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = *p == '-';
+        ++p;
+    }
+
+    double mantissa = 0.0;
+    int exponent = 0;
+    int digits = 0;
+    while (p < end && isDigit(*p)) {
+        mantissa = mantissa * 10.0 + (*p - '0');
+        ++digits;
+        ++p;
+    }
+    if (p < end && *p == '.') {
+        ++p;
+        while (p < end && isDigit(*p)) {
+            mantissa = mantissa * 10.0 + (*p - '0');
+            --exponent;
+            ++digits;
+            ++p;
+        }
+    }
+    if (digits == 0) {
+        return false;
+    }
+
+    if (p < end && (*p == 'e' || *p == 'E')) {
+        const char* e = p + 1;
+        bool negativeExponent = false;
+        if (e < end && (*e == '-' || *e == '+')) {
+            negativeExponent = *e == '-';
+            ++e;
+        }
+        if (e < end && isDigit(*e)) {
+            int written = 0;
+            while (e < end && isDigit(*e)) {
+                // Anything beyond this over- or underflows a float anyway
+                if (written < 10000) {
+                    written = written * 10 + (*e - '0');
+                }
+                ++e;
+            }
+            exponent += negativeExponent ? -written : written;
+            p = e;
+        }
+    }
+
+    double result = scaleByPowerOfTen(mantissa, exponent);
+    value = float(negative ? -result : result);
+    return p == end || isSpace(*p);
+}
+
+// Signed face index as written in the file (1-based, negative counts back)
+static bool parseIndex(const char*& p, const char* end, int& value) {
+    bool negative = false;
+    if (p < end && (*p == '-' || *p == '+')) {
+        negative = *p == '-';
+        ++p;
+    }
+    if (p == end || !isDigit(*p)) {
+        return false;
+    }
+
+    qint64 magnitude = 0;
+    while (p < end && isDigit(*p)) {
+        magnitude = magnitude * 10 + (*p - '0');
+        if (magnitude > INT_MAX) {
+            return false;
+        }
+        ++p;
+    }
+    value = negative ? -int(magnitude) : int(magnitude);
+    return true;
+}
+
+// Converts a file index into an absolute 0-based one, or a chunk-relative offset for
+// negative indices (localCount: elements of that kind the chunk has read so far)
+static bool resolveIndex(int index, int localCount, int& resolved, bool& relative) {
+    if (index > 0) {
+        resolved = index - 1;
+        relative = false;
+        return true;
+    }
+    if (index < 0) {
+        resolved = localCount + index;
+        relative = true;
+        return true;
+    }
+    return false;
+}
+
+// One face corner: v, v/vt, v//vn or v/vt/vn
+static bool parseCorner(const char*& p, const char* end, const ObjChunk& chunk,
+                        ObjCorner& corner) {
+    int position;
+    if (!parseIndex(p, end, position)) {
+        return false;
+    }
+
+    int normal = 0;
+    bool hasNormal = false;
+    if (p < end && *p == '/') {
+        ++p;
+        int texCoord;
+        if (p < end && *p != '/' && !parseIndex(p, end, texCoord)) {
+            return false;
+        }
+        if (p < end && *p == '/') {
+            ++p;
+            if (!parseIndex(p, end, normal)) {
+                return false;
+            }
+            hasNormal = true;
+        }
+    }
+    if (p < end && !isSpace(*p)) {
+        return false;
+    }
+
+    bool relative;
+    corner.flags = 0;
+    if (!resolveIndex(position, chunk.positions.size() / 3, corner.position, relative)) {
+        return false;
+    }
+    if (relative) {
+        corner.flags |= ObjCorner::RelativePosition;
+    }
+
+    corner.normal = kNoNormal;
+    if (hasNormal) {
+        if (!resolveIndex(normal, chunk.normals.size() / 3, corner.normal, relative)) {
+            return false;
+        }
+        if (relative) {
+            corner.flags |= ObjCorner::RelativeNormal;
+        }
+    }
+    return true;
+}
+
+static void parseChunk(ObjChunk& chunk) {
+    QVarLengthArray<ObjCorner, 16> polygon;
+
+    const char* p = chunk.begin;
+    while (p < chunk.end) {
+        const char* lineStart = p;
+        const char* lineEnd = static_cast<const char*>(memchr(p, '\n', chunk.end - p));
+        if (!lineEnd) {
+            lineEnd = chunk.end;
+        }
+
+        skipSpaces(p, lineEnd);
+        const qint64 length = lineEnd - p;
+        if (length > 1 && p[0] == 'v' && isSpace(p[1])) {
+            // Position; an optional w or vertex color after xyz is ignored
+            ++p;
+            float xyz[3];
+            for (float& coordinate : xyz) {
+                if (!parseFloat(p, lineEnd, coordinate)) {
+                    chunk.error = QStringLiteral("Malformed vertex position");
+                    chunk.errorAt = lineStart;
+                    return;
+                }
+            }
+            chunk.positions.append(xyz[0]);
+            chunk.positions.append(xyz[1]);
+            chunk.positions.append(xyz[2]);
+        } else if (length > 2 && p[0] == 'v' && p[1] == 'n' && isSpace(p[2])) {
+            p += 2;
+            float xyz[3];
+            for (float& coordinate : xyz) {
+                if (!parseFloat(p, lineEnd, coordinate)) {
+                    chunk.error = QStringLiteral("Malformed vertex normal");
+                    chunk.errorAt = lineStart;
+                    return;
+                }
+            }
+            chunk.normals.append(xyz[0]);
+            chunk.normals.append(xyz[1]);
+            chunk.normals.append(xyz[2]);
+        } else if (length > 1 && p[0] == 'f' && isSpace(p[1])) {
+            ++p;
+            polygon.clear();
+            skipSpaces(p, lineEnd);
+            while (p < lineEnd) {
+                ObjCorner corner;
+                if (!parseCorner(p, lineEnd, chunk, corner)) {
+                    chunk.error = QStringLiteral("Malformed face");
+                    chunk.errorAt = lineStart;
+                    return;
+                }
+                polygon.append(corner);
+                skipSpaces(p, lineEnd);
+            }
+            if (polygon.size() < 3) {
+                chunk.error = QStringLiteral("Face with fewer than three vertices");
+                chunk.errorAt = lineStart;
+                return;
+            }
+
+            // Fan triangulation, exact for the convex polygons exporters write
+            for (int corner = 1; corner + 1 < polygon.size(); ++corner) {
+                chunk.corners.append(polygon[0]);
+                chunk.corners.append(polygon[corner]);
+                chunk.corners.append(polygon[corner + 1]);
+            }
+        }
+        // Texture coordinates, groups, materials, lines and comments are skipped
+
+        p = lineEnd < chunk.end ? lineEnd + 1 : chunk.end;
+    }
+}
+
+bool ObjLoader::load(const QString& filePath, MeshData& mesh, QString* errorMessage,
+                     const ProgressCallback& progress) {
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        QString message = QStringLiteral("Cannot open %1: %2").arg(filePath, file.errorString());
+        qDebug() << "ERROR:" << message;
+        if (errorMessage) {
+            *errorMessage = message;
+        }
+        return false;
+    }
+
+    // Mapped, so the page cache is parsed in place without copying the file
+    const qint64 size = file.size();
+    const char* data = nullptr;
+    QByteArray contents;
+    uchar* mapped = size > 0 ? file.map(0, size) : nullptr;
+    if (mapped) {
+        data = reinterpret_cast<const char*>(mapped);
+    } else {
+        if (size > 0) {
+            qDebug() << "WARNING: Could not map" << filePath << "- reading it instead";
+        }
+        contents = file.readAll();
+        data = contents.constData();
+    }
+
+    bool loaded = parse(data, contents.isNull() ? size : contents.size(), mesh, errorMessage,
+                        progress);
+    if (mapped) {
+        file.unmap(mapped);
+    }
+    return loaded;
+}
+
+bool ObjLoader::parse(const char* data, qint64 size, MeshData& mesh, QString* errorMessage,
+                      const ProgressCallback& progress, qint64 chunkSize) {
+    QElapsedTimer timer;
+    timer.start();
+
+    mesh = MeshData();
+    auto fail = [&](const QString& message) {
+        qDebug() << "ERROR: OBJ parsing failed:" << message;
+        if (errorMessage) {
+            *errorMessage = message;
+        }
+        mesh = MeshData();
+        return false;
+    };
+
+    // Line-aligned chunks, so no record is split between two workers
+    QVector<ObjChunk> chunks;
+    chunkSize = qMax<qint64>(chunkSize, 1);
+    const char* end = data + size;
+    for (const char* begin = data; begin < end;) {
+        const char* chunkEnd = begin + qMin(chunkSize, qint64(end - begin));
+        const char* newline =
+            static_cast<const char*>(memchr(chunkEnd - 1, '\n', end - (chunkEnd - 1)));
+        chunkEnd = newline ? newline + 1 : end;
+
+        ObjChunk chunk;
+        chunk.begin = begin;
+        chunk.end = chunkEnd;
+        chunks.append(chunk);
+        begin = chunkEnd;
+    }
+
+    std::atomic<qint64> bytesParsed(0);
+    std::atomic<bool> cancelled(false);
+    QtConcurrent::blockingMap(chunks, [&](ObjChunk& chunk) {
+        if (cancelled) {
+            return;
+        }
+        parseChunk(chunk);
+        qint64 parsed = bytesParsed += chunk.end - chunk.begin;
+        if (progress && !progress(kParseShare * double(parsed) / double(size))) {
+            cancelled = true;
+        }
+    });
+    if (cancelled) {
+        return fail(QStringLiteral("Loading cancelled"));
+    }
+
+    // Chunks are in file order, so the first error is the first one in the file
+    for (const ObjChunk& chunk : chunks) {
+        if (!chunk.error.isEmpty()) {
+            qint64 line = 1 + std::count(data, chunk.errorAt, '\n');
+            return fail(QStringLiteral("Line %1: %2").arg(line).arg(chunk.error));
+        }
+    }
+
+    // Offsets of every chunk in the merged arrays
+    int positionCount = 0;
+    int normalCount = 0;
+    int cornerCount = 0;
+    for (ObjChunk& chunk : chunks) {
+        chunk.firstPosition = positionCount;
+        chunk.firstNormal = normalCount;
+        chunk.firstCorner = cornerCount;
+        positionCount += chunk.positions.size() / 3;
+        normalCount += chunk.normals.size() / 3;
+        cornerCount += chunk.corners.size();
+    }
+    if (cornerCount == 0) {
+        return fail(QStringLiteral("No faces"));
+    }
+
+    // Each chunk writes its own ranges, so the copies need no synchronization
+    mesh.positions.resize(positionCount * 3);
+    mesh.indices.resize(cornerCount);
+    QVector<float> fileNormals(normalCount * 3);
+    float* positions = mesh.positions.data();
+    float* normals = fileNormals.data();
+    unsigned int* indices = mesh.indices.data();
+    QtConcurrent::blockingMap(chunks, [&](ObjChunk& chunk) {
+        std::copy(chunk.positions.constBegin(), chunk.positions.constEnd(),
+                  positions + chunk.firstPosition * 3);
+        std::copy(chunk.normals.constBegin(), chunk.normals.constEnd(),
+                  normals + chunk.firstNormal * 3);
+
+        for (int i = 0; i < chunk.corners.size(); ++i) {
+            const ObjCorner& corner = chunk.corners[i];
+            int position = corner.position;
+            if (corner.flags & ObjCorner::RelativePosition) {
+                position += chunk.firstPosition;
+            }
+            if (position < 0 || position >= positionCount) {
+                chunk.error = QStringLiteral("Face references a missing vertex");
+                return;
+            }
+            indices[chunk.firstCorner + i] = unsigned(position);
+        }
+    });
+    for (const ObjChunk& chunk : chunks) {
+        if (!chunk.error.isEmpty()) {
+            return fail(chunk.error);
+        }
+    }
+
+    // Each position becomes one vertex with the normal of the first corner that uses it.
+    // Corners giving the same position another normal (hard edges, flat shaded exports)
+    // are pointed at an extra vertex per distinct (position, normal) pair, appended after
+    // the file positions. Done in file order, so the result does not depend on the chunks.
+    bool normalsComplete = normalCount > 0;
+    if (normalsComplete) {
+        QVector<int> vertexNormals(positionCount, kNoNormal);
+        QHash<QPair<unsigned int, int>, unsigned int> splitVertices;
+        QVector<unsigned int> splitPositions;
+        QVector<int> splitNormals;
+        for (const ObjChunk& chunk : chunks) {
+            for (int i = 0; i < chunk.corners.size(); ++i) {
+                const ObjCorner& corner = chunk.corners[i];
+                if (corner.normal == kNoNormal) {
+                    continue;
+                }
+
+                int normal = corner.normal;
+                if (corner.flags & ObjCorner::RelativeNormal) {
+                    normal += chunk.firstNormal;
+                }
+                if (normal < 0 || normal >= normalCount) {
+                    return fail(QStringLiteral("Face references a missing normal"));
+                }
+
+                unsigned int& index = indices[chunk.firstCorner + i];
+                int& vertexNormal = vertexNormals[index];
+                if (vertexNormal == kNoNormal) {
+                    vertexNormal = normal;
+                    continue;
+                }
+                // Exporters often repeat the same normal under several indices
+                if (vertexNormal == normal ||
+                    std::equal(normals + normal * 3, normals + normal * 3 + 3,
+                               normals + vertexNormal * 3)) {
+                    continue;
+                }
+
+                const QPair<unsigned int, int> key(index, normal);
+                auto split = splitVertices.constFind(key);
+                if (split == splitVertices.constEnd()) {
+                    split = splitVertices.insert(key, positionCount + splitPositions.size());
+                    splitPositions.append(index);
+                    splitNormals.append(normal);
+                }
+                index = split.value();
+            }
+        }
+
+        const int vertexCount = positionCount + splitPositions.size();
+        mesh.positions.resize(vertexCount * 3);
+        mesh.normals.fill(0.0f, vertexCount * 3);
+        for (int vertex = 0; vertex < vertexCount; ++vertex) {
+            const int normal = vertex < positionCount ? vertexNormals[vertex]
+                                                      : splitNormals[vertex - positionCount];
+            if (vertex >= positionCount) {
+                const unsigned int position = splitPositions[vertex - positionCount];
+                std::copy(mesh.positions.constData() + position * 3,
+                          mesh.positions.constData() + position * 3 + 3,
+                          mesh.positions.data() + vertex * 3);
+            }
+            if (normal != kNoNormal) {
+                std::copy(normals + normal * 3, normals + normal * 3 + 3,
+                          mesh.normals.data() + vertex * 3);
+            }
+        }
+        for (unsigned int vertex : mesh.indices) {
+            if (vertex < unsigned(positionCount) && vertexNormals[vertex] == kNoNormal) {
+                normalsComplete = false;
+                break;
+            }
+        }
+    }
+    if (!normalsComplete) {
+        // No normals in the file, or faces without them
+        mesh.computeNormals();
+    }
+
+    if (progress) {
+        progress(1.0);
+    }
+    qDebug() << "OBJ parsed - Vertices:" << mesh.vertexCount()
+             << "Triangles:" << mesh.triangleCount() << "Chunks:" << chunks.size() << "in"
+             << timer.elapsed() << "ms";
+    return true;
+}
@@ -0,0 +1,44 @@
+#ifndef OBJLOADER_HPP
+#define OBJLOADER_HPP
+
+#include <QString>
+#include <functional>
+
+#include "MeshData.hpp"
+
+/**
+ * @brief Wavefront OBJ reader that parses large files on all cores
+ *
+ * The file is memory-mapped and split into chunks of about ChunkSize bytes, each ending on
+ * a line break. Worker threads parse the chunks independently: positions and normals are
+ * kept in chunk-local arrays and relative (negative) indices are stored relative to the
+ * chunk, since the chunk cannot know how many vertices precede it. Once every chunk is
+ * parsed, a prefix sum over the per-chunk counts gives each chunk its place in the output
+ * and the chunks are copied and their indices resolved in parallel.
+ *
+ * Only v, vn and f records are read; polygons are fanned into triangles. Each position
+ * becomes one vertex with the normal of the first face corner that references it, plus
+ * one more vertex for every other normal the faces give it (hard edges); if the file has
+ * no normals they are computed from the faces.
+ */
+class ObjLoader {
+   public:
+    // Receives the fraction of the file processed so far from worker threads. Returning
+    // false cancels the load.
+    using ProgressCallback = std::function<bool(double)>;
+
+    // Target chunk size in bytes
+    static const int ChunkSize = 4 << 20;
+
+    // Reads a file (errorMessage, if given, receives the reason of a failure)
+    static bool load(const QString& filePath, MeshData& mesh, QString* errorMessage = nullptr,
+                     const ProgressCallback& progress = ProgressCallback());
+
+    // Parses OBJ text held in memory, split into chunks of about chunkSize bytes
+    static bool parse(const char* data, qint64 size, MeshData& mesh,
+                      QString* errorMessage = nullptr,
+                      const ProgressCallback& progress = ProgressCallback(),
+                      qint64 chunkSize = ChunkSize);
+};
+
+#endif  // OBJLOADER_HPP
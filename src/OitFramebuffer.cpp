@@ -0,0 +1,119 @@
+#include "OitFramebuffer.hpp"
+
+#include <QDebug>
+
+OitFramebuffer::OitFramebuffer()
+    : m_functionsInitialized(false),
+      m_framebuffer(0),
+      m_accumulationTexture(0),
+      m_weightTexture(0),
+      m_depthBuffer(0) {}
+
+OitFramebuffer::~OitFramebuffer() {
+    destroy();
+}
+
+bool OitFramebuffer::resize(const QSize& size) {
+    if (isValid() && m_size == size) {
+        return true;
+    }
+
+    if (!m_functionsInitialized) {
+        initializeOpenGLFunctions();
+        m_functionsInitialized = true;
+    }
+
+    destroy();
+    if (size.isEmpty()) {
+        return false;
+    }
+    m_size = size;
+
+    // Keep the caller's framebuffer binding
+    GLint previousFramebuffer = 0;
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previousFramebuffer);
+
+    m_accumulationTexture = createTexture(GL_RGBA16F, GL_RGBA);
+    m_weightTexture = createTexture(GL_R16F, GL_RED);
+
+    glGenRenderbuffers(1, &m_depthBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, m_depthBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH_COMPONENT24, size.width(), size.height());
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &m_framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
+                           m_accumulationTexture, 0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, m_weightTexture,
+                           0);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_RENDERBUFFER,
+                              m_depthBuffer);
+
+    const GLenum drawBuffers[2] = {GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1};
+    glDrawBuffers(2, drawBuffers);
+
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindFramebuffer(GL_FRAMEBUFFER, previousFramebuffer);
+
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        qDebug() << "ERROR: Transparency framebuffer incomplete, status" << Qt::hex << status;
+        destroy();
+        return false;
+    }
+
+    qDebug() << "Transparency targets created:" << size;
+    return true;
+}
+
+void OitFramebuffer::destroy() {
+    if (!m_functionsInitialized) {
+        return;
+    }
+
+    if (m_framebuffer) {
+        glDeleteFramebuffers(1, &m_framebuffer);
+    }
+    if (m_accumulationTexture) {
+        glDeleteTextures(1, &m_accumulationTexture);
+    }
+    if (m_weightTexture) {
+        glDeleteTextures(1, &m_weightTexture);
+    }
+    if (m_depthBuffer) {
+        glDeleteRenderbuffers(1, &m_depthBuffer);
+    }
+
+    m_framebuffer = 0;
+    m_accumulationTexture = 0;
+    m_weightTexture = 0;
+    m_depthBuffer = 0;
+    m_size = QSize();
+}
+
+void OitFramebuffer::bindAndClear() {
+    glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+
+    // Nothing accumulated, everything behind fully revealed
+    const GLfloat accumulationClear[4] = {0.0f, 0.0f, 0.0f, 1.0f};
+    const GLfloat weightClear[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    const GLfloat depthClear = 1.0f;
+    glClearBufferfv(GL_COLOR, 0, accumulationClear);
+    glClearBufferfv(GL_COLOR, 1, weightClear);
+    glClearBufferfv(GL_DEPTH, 0, &depthClear);
+}
+
+GLuint OitFramebuffer::createTexture(GLenum internalFormat, GLenum format) {
+    // Sampled with texelFetch only, no filtering or mipmaps
+    GLuint texture = 0;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, m_size.width(), m_size.height(), 0, format,
+                 GL_FLOAT, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return texture;
+}
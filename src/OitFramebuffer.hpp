@@ -0,0 +1,52 @@
+#ifndef OITFRAMEBUFFER_HPP
+#define OITFRAMEBUFFER_HPP
+
+#include <QOpenGLExtraFunctions>
+#include <QSize>
+
+/**
+ * @brief Render targets for weighted blended order-independent transparency
+ *
+ * Attachment 0 (RGBA16F) accumulates weighted premultiplied color in RGB and the
+ * revealage product in alpha, attachment 1 (R16F) accumulates the weights. Both are
+ * written in one pass with glBlendFuncSeparate(ONE, ONE, ZERO, ONE_MINUS_SRC_ALPHA), so
+ * no per-attachment blend state is needed. A private depth buffer holds the opaque depth
+ * the transparent surfaces are tested against.
+ */
+class OitFramebuffer : protected QOpenGLExtraFunctions {
+   public:
+    OitFramebuffer();
+    ~OitFramebuffer();
+
+    // (Re)creates the targets when the size changes (requires a current OpenGL context)
+    bool resize(const QSize& size);
+    void destroy();
+    bool isValid() const {
+        return m_framebuffer != 0;
+    }
+    QSize size() const {
+        return m_size;
+    }
+
+    // Binds the framebuffer and resets accumulation, revealage, weights and depth
+    void bindAndClear();
+
+    GLuint accumulationTexture() const {
+        return m_accumulationTexture;
+    }
+    GLuint weightTexture() const {
+        return m_weightTexture;
+    }
+
+   private:
+    GLuint createTexture(GLenum internalFormat, GLenum format);
+
+    bool m_functionsInitialized;
+    QSize m_size;
+    GLuint m_framebuffer;
+    GLuint m_accumulationTexture;
+    GLuint m_weightTexture;
+    GLuint m_depthBuffer;
+};
+
+#endif  // OITFRAMEBUFFER_HPP
@@ -0,0 +1,155 @@
+#include "OpenGL3DDirectViewport.hpp"
+
+#include <QDebug>
+#include <QOpenGLContext>
+#include <QRunnable>
+
+// Deletes an underlay on the render thread, where its OpenGL context is current
+class UnderlayCleanupJob : public QRunnable {
+   public:
+    explicit UnderlayCleanupJob(DirectViewportUnderlay* underlay) : m_underlay(underlay) {}
+
+    void run() override {
+        delete m_underlay;
+    }
+
+   private:
+    DirectViewportUnderlay* m_underlay;
+};
+
+DirectViewportUnderlay::DirectViewportUnderlay(QQuickWindow* window,
+                                               const QSharedPointer<std::atomic<bool>>& shown)
+    : m_window(window), m_renderer(nullptr), m_shown(shown) {
+    // Called on the render thread: inside the render pass, after the window is cleared and
+    // before any item is drawn
+    connect(m_window, &QQuickWindow::beforeRenderPassRecording, this,
+            &DirectViewportUnderlay::render, Qt::DirectConnection);
+    connect(m_window, &QQuickWindow::sceneGraphInvalidated, this,
+            &DirectViewportUnderlay::invalidate, Qt::DirectConnection);
+}
+
+DirectViewportUnderlay::~DirectViewportUnderlay() {
+    delete m_renderer;
+}
+
+void DirectViewportUnderlay::synchronize(OpenGL3DViewport* viewport, const QRect& targetRect,
+                                         int samples) {
+    if (!m_renderer) {
+        m_renderer = new OpenGL3DRenderer();
+    }
+    m_targetRect = targetRect;
+    m_renderer->synchronize(viewport);
+    m_renderer->setDirectTarget(m_targetRect, samples);
+}
+
+void DirectViewportUnderlay::render() {
+    if (!m_renderer || !m_shown->load() || m_targetRect.isEmpty()) {
+        return;
+    }
+
+    // Qt Quick has begun the window's render pass; hand it back with its state reset
+    m_window->beginExternalCommands();
+    m_renderer->render();
+    m_window->endExternalCommands();
+}
+
+void DirectViewportUnderlay::invalidate() {
+    // The scene graph and its context are going away (context still current); the next
+    // synchronization creates a new renderer
+    delete m_renderer;
+    m_renderer = nullptr;
+}
+
+OpenGL3DDirectViewport::OpenGL3DDirectViewport(QQuickItem* parent)
+    : OpenGL3DViewport(parent), m_underlay(nullptr), m_shown(new std::atomic<bool>(true)) {
+    qDebug() << "OpenGL3DDirectViewport created - Rendering underneath the scene graph";
+}
+
+OpenGL3DDirectViewport::~OpenGL3DDirectViewport() {
+    scheduleUnderlayCleanup();
+    connectWindow(nullptr);
+}
+
+QSGNode* OpenGL3DDirectViewport::updatePaintNode(QSGNode* oldNode, UpdatePaintNodeData* data) {
+    Q_UNUSED(oldNode)
+    Q_UNUSED(data)
+
+    // Everything the render thread needs later is copied into the underlay here
+    if (!m_underlay) {
+        m_underlay = new DirectViewportUnderlay(window(), m_shown);
+    }
+
+    // Multisampling is whatever the window's render target was created with
+    QOpenGLContext* context = QOpenGLContext::currentContext();
+    int samples = context ? qMax(0, context->format().samples()) : 0;
+    m_underlay->synchronize(this, targetRect(), samples);
+
+    // Nothing for Qt Quick to draw: the frame is already in the window
+    return nullptr;
+}
+
+void OpenGL3DDirectViewport::releaseResources() {
+    scheduleUnderlayCleanup();
+    OpenGL3DViewport::releaseResources();
+}
+
+void OpenGL3DDirectViewport::itemChange(ItemChange change, const ItemChangeData& value) {
+    if (change == ItemSceneChange) {
+        connectWindow(value.window);
+    } else if (change == ItemVisibleHasChanged) {
+        m_shown->store(value.boolValue);
+        update();
+    }
+
+    OpenGL3DViewport::itemChange(change, value);
+}
+
+void OpenGL3DDirectViewport::geometryChange(const QRectF& newGeometry,
+                                            const QRectF& oldGeometry) {
+    // Moving the item moves its target rectangle, not only resizing it
+    OpenGL3DViewport::geometryChange(newGeometry, oldGeometry);
+    update();
+}
+
+void OpenGL3DDirectViewport::connectWindow(QQuickWindow* window) {
+    if (m_window == window) {
+        return;
+    }
+
+    // The underlay draws in the window it was created for
+    scheduleUnderlayCleanup();
+    if (m_window) {
+        disconnect(m_window, nullptr, this, nullptr);
+    }
+    m_window = window;
+
+    if (!m_window) {
+        return;
+    }
+
+    // The target rectangle is measured from the bottom of the window
+    connect(m_window, &QQuickWindow::heightChanged, this, &QQuickItem::update);
+}
+
+void OpenGL3DDirectViewport::scheduleUnderlayCleanup() {
+    // OpenGL objects can only go on the render thread, before its next synchronization.
+    // Deleting the underlay there also disconnects it from the window's render signals.
+    if (m_underlay && m_window) {
+        m_window->scheduleRenderJob(new UnderlayCleanupJob(m_underlay),
+                                    QQuickWindow::BeforeSynchronizingStage);
+        m_underlay = nullptr;
+    }
+}
+
+QRect OpenGL3DDirectViewport::targetRect() const {
+    if (!window()) {
+        return QRect();
+    }
+
+    // OpenGL window coordinates: device pixels with the origin at the bottom left
+    const qreal dpr = window()->effectiveDevicePixelRatio();
+    QRectF sceneRect = mapRectToScene(boundingRect());
+    return QRectF(sceneRect.x() * dpr, (window()->height() - sceneRect.bottom()) * dpr,
+                  sceneRect.width() * dpr, sceneRect.height() * dpr)
+        .toRect();
+}
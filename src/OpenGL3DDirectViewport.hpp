@@ -0,0 +1,92 @@
+#ifndef OPENGL3DDIRECTVIEWPORT_HPP
+#define OPENGL3DDIRECTVIEWPORT_HPP
+
+#include <QObject>
+#include <QPointer>
+#include <QQuickWindow>
+#include <QRect>
+#include <QSharedPointer>
+#include <atomic>
+
+#include "OpenGL3DViewport.hpp"
+
+/**
+ * @brief Render-thread half of an OpenGL3DDirectViewport
+ *
+ * Created on the render thread and owned by it. The window's render signals are connected
+ * to this object rather than to the item, which the GUI thread may change or destroy while
+ * a frame is drawn; it only uses what synchronize() copied in while the GUI thread was
+ * blocked. The item deletes it through QQuickWindow::scheduleRenderJob().
+ */
+class DirectViewportUnderlay : public QObject {
+    Q_OBJECT
+
+   public:
+    DirectViewportUnderlay(QQuickWindow* window, const QSharedPointer<std::atomic<bool>>& shown);
+    ~DirectViewportUnderlay();
+
+    // Render thread, GUI thread blocked
+    void synchronize(OpenGL3DViewport* viewport, const QRect& targetRect, int samples);
+
+   private slots:
+    // Render thread
+    void render();
+    void invalidate();
+
+   private:
+    QQuickWindow* m_window;
+    OpenGL3DRenderer* m_renderer;  // Created on first sync, gone with the scene graph
+    QRect m_targetRect;            // Item rectangle in window pixels, bottom-left origin
+    QSharedPointer<std::atomic<bool>> m_shown;
+};
+
+/**
+ * @brief Viewport that renders straight into the window instead of a framebuffer object
+ *
+ * Same properties, input handling and OpenGL3DRenderer as OpenGL3DViewport, but the frame
+ * is drawn into the item's rectangle of the window's own render target from
+ * QQuickWindow::beforeRenderPassRecording, after the window is cleared and before Qt Quick
+ * draws its items (underlay). This saves the framebuffer object, its resolve and the
+ * textured quad Qt Quick composites it with, at the cost of two constraints:
+ *
+ * - Items stacked below the viewport must be transparent where it is, or they cover the
+ *   3D view.
+ * - The window's format decides multisampling, and the render scale of adaptive
+ *   resolution does not apply (the window is always drawn at full resolution).
+ */
+class OpenGL3DDirectViewport : public OpenGL3DViewport {
+    Q_OBJECT
+
+   public:
+    explicit OpenGL3DDirectViewport(QQuickItem* parent = nullptr);
+    ~OpenGL3DDirectViewport();
+
+    bool directRendering() const override {
+        return true;
+    }
+
+   protected:
+    // Synchronizes the renderer (render thread, GUI thread blocked) without a scene graph
+    // node of its own
+    QSGNode* updatePaintNode(QSGNode* oldNode, UpdatePaintNodeData* data) override;
+    void releaseResources() override;
+    void itemChange(ItemChange change, const ItemChangeData& value) override;
+    void geometryChange(const QRectF& newGeometry, const QRectF& oldGeometry) override;
+
+   private:
+    void connectWindow(QQuickWindow* window);
+    void scheduleUnderlayCleanup();
+    QRect targetRect() const;
+
+    QPointer<QQuickWindow> m_window;
+
+    // Created in updatePaintNode() and deleted by a render job of the window it draws in;
+    // the pointer is only handed over, never dereferenced, outside updatePaintNode()
+    DirectViewportUnderlay* m_underlay;
+
+    // Written on the GUI thread, read by the render thread (hidden items get no paint node
+    // updates, so the underlay checks this itself)
+    QSharedPointer<std::atomic<bool>> m_shown;
+};
+
+#endif  // OPENGL3DDIRECTVIEWPORT_HPP
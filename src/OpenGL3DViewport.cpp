@@ -1,102 +1,513 @@
 #include "OpenGL3DViewport.hpp"
 
+#include <QDateTime>
 #include <QDebug>
+#include <QDir>
+#include <QFileInfo>
 #include <QKeyEvent>
 #include <QOpenGLShaderProgram>
 #include <QRandomGenerator>
+#include <QtConcurrent>
 #include <QtMath>
-
+#include <cstring>
+
+#include "Colormap.hpp"
+#include "FrameCapture.hpp"
+#include "FrameProfiler.hpp"
+#include "GLStateTracker.hpp"
+#include "GeometryAtlas.hpp"
+#include "GlyphAtlas.hpp"
+#include "GpuResourceCache.hpp"
+#include "MeshCacheFile.hpp"
+#include "MeshData.hpp"
+#include "MeshOptimizer.hpp"
+#include "ModelMesh.hpp"
+#include "ObjLoader.hpp"
+#include "OitFramebuffer.hpp"
+#include "ProgramBinaryCache.hpp"
+#include "ReferenceLayer.hpp"
+#include "RenderScheduler.hpp"
+#include "SilhouetteOverlap.hpp"
 #include "SpaceMouseManager.hpp"
+#include "StlFile.hpp"
 
 // ===================================================================
 // SHADER SOURCES
 // ===================================================================
 
+// Per-frame camera and light data, written once per frame into a uniform buffer
+#define FRAME_DATA_BLOCK                  \
+    "layout (std140) uniform FrameData\n" \
+    "{\n"                                 \
+    "   mat4 viewProjectionMatrix;\n"     \
+    "   vec4 lightPos;\n"                 \
+    "   vec4 viewPos;\n"                  \
+    "};\n"
+
+// Unit normal from its octahedral encoding in the compact vertex format (CompactVertexFormat)
+#define OCTAHEDRAL_NORMAL                                                 \
+    "vec3 octahedralNormal(vec2 encoded)\n"                               \
+    "{\n"                                                                 \
+    "   vec3 n = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));\n" \
+    "   // Unfold the lower hemisphere\n"                                 \
+    "   float fold = max(-n.z, 0.0);\n"                                   \
+    "   n.x += n.x >= 0.0 ? -fold : fold;\n"                              \
+    "   n.y += n.y >= 0.0 ? -fold : fold;\n"                              \
+    "   return normalize(n);\n"                                           \
+    "}\n"
+
 // Enhanced vertex shader with lighting support for dual-model rendering
 static const char* vertexShaderSource =
     "#version 330 core\n"
     "layout (location = 0) in vec3 aPos;\n"
-    "layout (location = 1) in vec3 aNormal;\n"
-    "uniform mat4 mvpMatrix;\n"
+    "layout (location = 1) in vec2 aNormal;\n"
+    FRAME_DATA_BLOCK
+    OCTAHEDRAL_NORMAL
     "uniform mat4 modelMatrix;\n"
     "uniform mat3 normalMatrix;\n"
+    "uniform vec3 color;\n"
+    "uniform mat4 referenceMatrix;\n"
+    "uniform vec3 alignmentOffset;\n"
+    "out vec3 FragPos;\n"
+    "out vec3 Normal;\n"
+    "out vec3 Color;\n"
+    "out vec3 Displacement;\n"
+    "void main()\n"
+    "{\n"
+    "   vec4 worldPos = modelMatrix * vec4(aPos, 1.0);\n"
+    "   FragPos = worldPos.xyz;\n"
+    "   Normal = normalMatrix * octahedralNormal(aNormal);\n"
+    "   Color = color;\n"
+    "   \n"
+    "   // Offset from the same point on the reference model (linear, so exact per fragment)\n"
+    "   Displacement = worldPos.xyz - alignmentOffset - (referenceMatrix * vec4(aPos, 1.0)).xyz;\n"
+    "   gl_Position = viewProjectionMatrix * worldPos;\n"
+    "}\n";
+
+// Instanced vertex shader for vertex markers (per-instance center, scale and color)
+static const char* markerVertexShaderSource =
+    "#version 330 core\n"
+    "layout (location = 0) in vec3 aPos;\n"
+    "layout (location = 1) in vec2 aNormal;\n"
+    "layout (location = 2) in vec4 aInstance;\n"
+    "layout (location = 3) in vec3 aInstanceColor;\n"
+    FRAME_DATA_BLOCK
+    OCTAHEDRAL_NORMAL
     "out vec3 FragPos;\n"
     "out vec3 Normal;\n"
+    "out vec3 Color;\n"
+    "out vec3 Displacement;\n"
     "void main()\n"
     "{\n"
-    "   FragPos = vec3(modelMatrix * vec4(aPos, 1.0));\n"
-    "   Normal = normalMatrix * aNormal;\n"
-    "   gl_Position = mvpMatrix * vec4(aPos, 1.0);\n"
+    "   // Uniform scale around the marker center keeps the unit sphere normal valid\n"
+    "   FragPos = aInstance.xyz + aInstance.w * aPos;\n"
+    "   Normal = octahedralNormal(aNormal);\n"
+    "   Color = aInstanceColor;\n"
+    "   Displacement = vec3(0.0);\n"
+    "   gl_Position = viewProjectionMatrix * vec4(FragPos, 1.0);\n"
     "}\n";
 
+// Phong lighting shared by every fragment stage
+#define PHONG_LIGHTING                                                    \
+    "vec3 shade(vec3 color, vec3 normal, vec3 fragPos)\n"                 \
+    "{\n"                                                                 \
+    "   // Ambient lighting\n"                                            \
+    "   float ambientStrength = 0.3;\n"                                   \
+    "   vec3 ambient = ambientStrength * color;\n"                        \
+    "   \n"                                                               \
+    "   // Diffuse lighting\n"                                            \
+    "   vec3 norm = normalize(normal);\n"                                 \
+    "   vec3 lightDir = normalize(lightPos.xyz - fragPos);\n"             \
+    "   float diff = max(dot(norm, lightDir), 0.0);\n"                    \
+    "   vec3 diffuse = diff * color;\n"                                   \
+    "   \n"                                                               \
+    "   // Specular lighting\n"                                           \
+    "   float specularStrength = 0.5;\n"                                  \
+    "   vec3 viewDir = normalize(viewPos.xyz - fragPos);\n"               \
+    "   vec3 reflectDir = reflect(-lightDir, norm);\n"                    \
+    "   float spec = pow(max(dot(viewDir, reflectDir), 0.0), 32);\n"      \
+    "   vec3 specular = specularStrength * spec * vec3(1.0, 1.0, 1.0);\n" \
+    "   \n"                                                               \
+    "   return ambient + diffuse + specular;\n"                           \
+    "}\n"
+
+// Surface color: the model color, or the alignment error mapped through the colormap
+// lookup texture (error / heatmapRange from 0 to 1, centred on the first and last texels)
+#define ALIGNMENT_HEATMAP                                                      \
+    "uniform bool heatmap;\n"                                                  \
+    "uniform float heatmapRange;\n"                                            \
+    "uniform sampler2D colormapTexture;\n"                                     \
+    "vec3 surfaceColor(vec3 color, vec3 displacement)\n"                       \
+    "{\n"                                                                      \
+    "   if (!heatmap) {\n"                                                     \
+    "       return color;\n"                                                   \
+    "   }\n"                                                                   \
+    "   float error = clamp(length(displacement) / heatmapRange, 0.0, 1.0);\n" \
+    "   float texels = float(textureSize(colormapTexture, 0).x);\n"            \
+    "   float u = (error * (texels - 1.0) + 0.5) / texels;\n"                  \
+    "   return texture(colormapTexture, vec2(u, 0.5)).rgb;\n"                  \
+    "}\n"
+
+// Fragment output: plain blended color, or weighted blended transparency accumulation
+// (color * alpha * weight and revealage in target 0, alpha * weight in target 1)
+#define FRAGMENT_OUTPUT                                                           \
+    "#ifdef ORDER_INDEPENDENT\n"                                                  \
+    "layout (location = 0) out vec4 FragAccumulation;\n"                          \
+    "layout (location = 1) out float FragWeight;\n"                               \
+    "void writeColor(vec4 color)\n"                                               \
+    "{\n"                                                                         \
+    "   // Depth weight favouring closer and more opaque surfaces\n"              \
+    "   float weight = clamp(pow(min(1.0, color.a * 10.0) + 0.01, 3.0) * 1e8 *\n" \
+    "                        pow(1.0 - gl_FragCoord.z * 0.9, 3.0), 1e-2, 3e3);\n" \
+    "   FragAccumulation = vec4(color.rgb * color.a * weight, color.a);\n"        \
+    "   FragWeight = color.a * weight;\n"                                         \
+    "}\n"                                                                         \
+    "#else\n"                                                                     \
+    "out vec4 FragColor;\n"                                                       \
+    "void writeColor(vec4 color)\n"                                               \
+    "{\n"                                                                         \
+    "   FragColor = color;\n"                                                     \
+    "}\n"                                                                         \
+    "#endif\n"
+
 // Enhanced fragment shader with lighting and alpha transparency
 static const char* fragmentShaderSource =
     "#version 330 core\n"
     "in vec3 FragPos;\n"
     "in vec3 Normal;\n"
-    "out vec4 FragColor;\n"
-    "uniform vec3 color;\n"
-    "uniform vec3 lightPos;\n"
-    "uniform vec3 viewPos;\n"
+    "in vec3 Color;\n"
+    "in vec3 Displacement;\n"
+    FRAME_DATA_BLOCK
     "uniform float alpha;\n"
+    PHONG_LIGHTING
+    ALIGNMENT_HEATMAP
+    FRAGMENT_OUTPUT
+    "void main()\n"
+    "{\n"
+    "   vec3 color = surfaceColor(Color, Displacement);\n"
+    "   writeColor(vec4(shade(color, Normal, FragPos), alpha));\n"
+    "}\n";
+
+// Wireframe geometry shader: per-vertex distance to the opposite edge in window pixels
+static const char* wireframeGeometryShaderSource =
+    "#version 330 core\n"
+    "layout (triangles) in;\n"
+    "layout (triangle_strip, max_vertices = 3) out;\n"
+    "in vec3 FragPos[];\n"
+    "in vec3 Normal[];\n"
+    "in vec3 Color[];\n"
+    "in vec3 Displacement[];\n"
+    "out vec3 gFragPos;\n"
+    "out vec3 gNormal;\n"
+    "out vec3 gColor;\n"
+    "out vec3 gDisplacement;\n"
+    "noperspective out vec3 gEdgeDistance;\n"
+    "uniform vec2 viewportSize;\n"
+    "vec2 toWindow(vec4 clipPos)\n"
+    "{\n"
+    "   return 0.5 * viewportSize * clipPos.xy / max(clipPos.w, 1e-5);\n"
+    "}\n"
     "void main()\n"
     "{\n"
-    "   // Ambient lighting\n"
-    "   float ambientStrength = 0.3;\n"
-    "   vec3 ambient = ambientStrength * color;\n"
+    "   vec2 p0 = toWindow(gl_in[0].gl_Position);\n"
+    "   vec2 p1 = toWindow(gl_in[1].gl_Position);\n"
+    "   vec2 p2 = toWindow(gl_in[2].gl_Position);\n"
+    "   vec2 e0 = p2 - p1;\n"
+    "   vec2 e1 = p2 - p0;\n"
+    "   vec2 e2 = p1 - p0;\n"
     "   \n"
-    "   // Diffuse lighting\n"
-    "   vec3 norm = normalize(Normal);\n"
-    "   vec3 lightDir = normalize(lightPos - FragPos);\n"
-    "   float diff = max(dot(norm, lightDir), 0.0);\n"
-    "   vec3 diffuse = diff * color;\n"
+    "   // Triangle altitudes from twice the window-space area\n"
+    "   float area = abs(e1.x * e2.y - e1.y * e2.x);\n"
+    "   vec3 altitude = area / max(vec3(length(e0), length(e1), length(e2)), vec3(1e-5));\n"
     "   \n"
-    "   // Specular lighting\n"
-    "   float specularStrength = 0.5;\n"
-    "   vec3 viewDir = normalize(viewPos - FragPos);\n"
-    "   vec3 reflectDir = reflect(-lightDir, norm);\n"
-    "   float spec = pow(max(dot(viewDir, reflectDir), 0.0), 32);\n"
-    "   vec3 specular = specularStrength * spec * vec3(1.0, 1.0, 1.0);\n"
+    "   for (int i = 0; i < 3; ++i) {\n"
+    "       gFragPos = FragPos[i];\n"
+    "       gNormal = Normal[i];\n"
+    "       gColor = Color[i];\n"
+    "       gDisplacement = Displacement[i];\n"
+    "       gEdgeDistance = vec3(0.0);\n"
+    "       gEdgeDistance[i] = altitude[i];\n"
+    "       gl_Position = gl_in[i].gl_Position;\n"
+    "       EmitVertex();\n"
+    "   }\n"
+    "   EndPrimitive();\n"
+    "}\n";
+
+// Filled surface with anti-aliased edges of a fixed pixel width, in a single pass
+static const char* wireframeFragmentShaderSource =
+    "#version 330 core\n"
+    "in vec3 gFragPos;\n"
+    "in vec3 gNormal;\n"
+    "in vec3 gColor;\n"
+    "in vec3 gDisplacement;\n"
+    "noperspective in vec3 gEdgeDistance;\n"
+    FRAME_DATA_BLOCK
+    "uniform float alpha;\n"
+    "uniform float edgeAlpha;\n"
+    "uniform float edgeWidth;\n"
+    PHONG_LIGHTING
+    ALIGNMENT_HEATMAP
+    FRAGMENT_OUTPUT
+    "void main()\n"
+    "{\n"
+    "   // Distance to the closest triangle edge, smoothed over one pixel\n"
+    "   float edgeDistance = min(gEdgeDistance.x, min(gEdgeDistance.y, gEdgeDistance.z));\n"
+    "   float halfWidth = 0.5 * edgeWidth;\n"
+    "   float edge = 1.0 - smoothstep(halfWidth - 0.5, halfWidth + 0.5, edgeDistance);\n"
+    "   vec3 color = surfaceColor(gColor, gDisplacement);\n"
+    "   writeColor(vec4(shade(color, gNormal, gFragPos), mix(alpha, edgeAlpha, edge)));\n"
+    "}\n";
+
+// Fullscreen triangle generated from gl_VertexID (no vertex buffer)
+static const char* fullscreenVertexShaderSource =
+    "#version 330 core\n"
+    "void main()\n"
+    "{\n"
+    "   vec2 corner = vec2((gl_VertexID << 1) & 2, gl_VertexID & 2);\n"
+    "   gl_Position = vec4(corner * 2.0 - 1.0, 0.0, 1.0);\n"
+    "}\n";
+
+// Resolves the transparency targets over the opaque scene, blended with
+// (ONE_MINUS_SRC_ALPHA, SRC_ALPHA) so the revealage scales what is behind. The targets
+// start at the item's corner of the render target (targetOrigin).
+static const char* compositeFragmentShaderSource =
+    "#version 330 core\n"
+    "uniform sampler2D accumulationTexture;\n"
+    "uniform sampler2D weightTexture;\n"
+    "uniform vec2 targetOrigin;\n"
+    "out vec4 FragColor;\n"
+    "void main()\n"
+    "{\n"
+    "   ivec2 texel = ivec2(gl_FragCoord.xy - targetOrigin);\n"
+    "   vec4 accumulation = texelFetch(accumulationTexture, texel, 0);\n"
+    "   float revealage = accumulation.a;\n"
+    "   if (revealage >= 0.999) {\n"
+    "       discard;  // No transparent surface covers this pixel\n"
+    "   }\n"
+    "   float weight = texelFetch(weightTexture, texel, 0).r;\n"
+    "   FragColor = vec4(accumulation.rgb / max(weight, 1e-5), revealage);\n"
+    "}\n";
+
+// Seeds the transparency targets with the cached reference layer. The fragment depth is
+// the reference's nearest surface, so pixels where an opaque marker lies in front of it
+// fail the depth test and keep the cleared (unoccluded) values.
+static const char* referenceSeedFragmentShaderSource =
+    "#version 330 core\n"
+    "uniform sampler2D accumulationTexture;\n"
+    "uniform sampler2D weightTexture;\n"
+    "uniform sampler2D depthTexture;\n"
+    "layout (location = 0) out vec4 FragAccumulation;\n"
+    "layout (location = 1) out float FragWeight;\n"
+    "void main()\n"
+    "{\n"
+    "   ivec2 texel = ivec2(gl_FragCoord.xy);\n"
+    "   float depth = texelFetch(depthTexture, texel, 0).r;\n"
+    "   if (depth >= 1.0) {\n"
+    "       discard;  // Reference does not cover this pixel\n"
+    "   }\n"
+    "   gl_FragDepth = depth;\n"
+    "   FragAccumulation = texelFetch(accumulationTexture, texel, 0);\n"
+    "   FragWeight = texelFetch(weightTexture, texel, 0).r;\n"
+    "}\n";
+
+// Silhouette passes only mark the stencil buffer
+static const char* silhouetteFragmentShaderSource =
+    "#version 330 core\n"
+    "void main()\n"
+    "{\n"
+    "}\n";
+
+// Vertex label glyphs: a screen-aligned quad per glyph from gl_VertexID (triangle strip),
+// anchored at the projected marker center (aAnchor.xyz) and offset in window pixels by the
+// pen position (aAnchor.w, in cells). aGlyph holds the color and the atlas cell.
+static const char* labelVertexShaderSource =
+    "#version 330 core\n"
+    "layout (location = 0) in vec4 aAnchor;\n"
+    "layout (location = 1) in vec4 aGlyph;\n"
+    FRAME_DATA_BLOCK
+    "uniform vec2 viewportSize;\n"
+    "uniform vec2 glyphSize;\n"
+    "uniform vec2 labelOffset;\n"
+    "uniform float glyphCount;\n"
+    "out vec2 TexCoord;\n"
+    "out vec3 Color;\n"
+    "void main()\n"
+    "{\n"
+    "   vec2 corner = vec2(gl_VertexID & 1, (gl_VertexID >> 1) & 1);\n"
+    "   TexCoord = vec2((aGlyph.w + corner.x) / glyphCount, 1.0 - corner.y);\n"
+    "   Color = aGlyph.rgb;\n"
     "   \n"
-    "   vec3 result = ambient + diffuse + specular;\n"
-    "   FragColor = vec4(result, alpha);\n"
+    "   // Pixel offsets scaled by w survive the perspective divide unchanged\n"
+    "   vec4 clipPos = viewProjectionMatrix * vec4(aAnchor.xyz, 1.0);\n"
+    "   vec2 pixelOffset = labelOffset + vec2(aAnchor.w + corner.x, corner.y) * glyphSize;\n"
+    "   clipPos.xy += 2.0 * pixelOffset / viewportSize * clipPos.w;\n"
+    "   gl_Position = clipPos;\n"
+    "}\n";
+
+// Signed distance field glyphs (0.5 on the outline) with a dark outline for contrast on
+// either model, antialiased over one window pixel at any size
+static const char* labelFragmentShaderSource =
+    "#version 330 core\n"
+    "in vec2 TexCoord;\n"
+    "in vec3 Color;\n"
+    "uniform sampler2D glyphAtlas;\n"
+    "out vec4 FragColor;\n"
+    "void main()\n"
+    "{\n"
+    "   float distance = texture(glyphAtlas, TexCoord).r;\n"
+    "   float smoothing = max(fwidth(distance), 1e-4);\n"
+    "   float fill = smoothstep(0.5 - smoothing, 0.5 + smoothing, distance);\n"
+    "   float outline = smoothstep(0.3 - smoothing, 0.3 + smoothing, distance);\n"
+    "   if (outline <= 0.0) {\n"
+    "       discard;\n"
+    "   }\n"
+    "   FragColor = vec4(Color * fill, outline);\n"
     "}\n";
 
+// Inserts a preprocessor define right after the #version line of a shader source
+static QByteArray shaderVariant(const char* source, const char* define) {
+    QByteArray variant(source);
+    variant.insert(variant.indexOf('\n') + 1, QByteArray("#define ") + define + "\n");
+    return variant;
+}
+
+// Marker instance layout: vec4(center, scale) + vec3(color)
+static const int kFloatsPerMarkerInstance = 7;
+
+// Label glyph instance layout: vec4(marker center, pen position) + vec4(color, atlas cell)
+static const int kFloatsPerLabelInstance = 8;
+
+// Label glyph cell height and offset from the marker center, in item pixels
+static const float kLabelHeight = 18.0f;
+static const QPointF kLabelOffset(6.0f, 6.0f);
+
+// Uniform buffer binding point of the FrameData block
+static const GLuint kFrameDataBinding = 0;
+
+// std140 mirror of the FrameData block
+struct FrameDataBlock {
+    float viewProjectionMatrix[16];
+    float lightPos[4];
+    float viewPos[4];
+};
+
+// Alignment heatmap colormap lookup texture width
+static const int kColormapTexels = 256;
+
+// Output rate of session recordings
+static const double kCaptureFramesPerSecond = 30.0;
+
+// Progress reached by a model load after parsing and after reordering; the mesh cache
+// write takes the rest
+static const double kModelParseShare = 0.8;
+static const double kModelOptimizeShare = 0.9;
+
+// Fixed research scene lighting and camera
+static const QVector3D kLightPosition(5.0f, 5.0f, 5.0f);
+static const QVector3D kCameraPosition(4.0f, 3.0f, 6.0f);
+
+// Fixed pose of the reference model, also the movable model's starting orientation
+static const QQuaternion kReferenceRotation = QQuaternion::fromEulerAngles(15.0f, 25.0f, 0.0f);
+
+static QMatrix4x4 referenceModelMatrix() {
+    QMatrix4x4 matrix;
+    matrix.rotate(kReferenceRotation);
+    return matrix;
+}
+
 // ===================================================================
 // OPENGL3DRENDERER IMPLEMENTATION
 // ===================================================================
 
 OpenGL3DRenderer::OpenGL3DRenderer()
     : m_program(nullptr),
-      m_vertexBuffer(nullptr),
-      m_indexBuffer(nullptr),
-      m_normalBuffer(nullptr),
-      m_sphereVertexBuffer(nullptr),
-      m_sphereIndexBuffer(nullptr),
-      m_sphereNormalBuffer(nullptr),
+      m_markerProgram(nullptr),
+      m_wireframeProgram(nullptr),
+      m_oitProgram(nullptr),
+      m_oitWireframeProgram(nullptr),
+      m_compositeProgram(nullptr),
+      m_compositeOriginLocation(-1),
+      m_referenceSeedProgram(nullptr),
+      m_silhouetteProgram(nullptr),
+      m_fullscreenSilhouetteProgram(nullptr),
+      m_labelProgram(nullptr),
+      m_geometryVao(nullptr),
+      m_modelVao(nullptr),
+      m_programCache(nullptr),
+      m_frameCapture(new FrameCapture()),
+      m_captureSession(0),
+      m_oitFramebuffer(nullptr),
+      m_fullscreenVao(nullptr),
+      m_referenceLayer(new ReferenceLayer()),
+      m_silhouetteOverlap(new SilhouetteOverlap()),
+      m_markerVao(nullptr),
+      m_markerInstanceBuffer(nullptr),
+      m_labelVao(nullptr),
+      m_labelInstanceBuffer(nullptr),
+      m_labelCount(0),
+      m_frameUniformBuffer(0),
+      m_frameProfiler(nullptr),
+      m_glState(new GLStateTracker()),
+      m_renderQueue(new RenderQueue()),
       m_currentShape(4),                // Default: Tetrahedron
       m_translation(0.0f, 0.0f, 0.0f),  // Origin position
       m_scale(1.0f),                    // Unity scale
       m_initialized(false),             // Not initialized yet
       m_showReferenceModel(true),       // Show reference model
       m_showMovableModel(true),         // Show movable model
-      m_showVertexLabels(true)          // Show vertex markers
+      m_showVertexLabels(true),         // Show vertex markers
+      m_sampleCount(4),                 // 4x MSAA for smoother edges
+      m_renderScale(1.0f),              // Full item resolution
+      m_framebufferSamples(0),
+      m_directTarget(false),
+      m_edgeWidth(4.0f),                // Thick edges for research visibility
+      m_orderIndependentTransparency(true),
+      m_oitActive(false),
+      m_alignmentHeatmap(false),
+      m_heatmapColormap(Colormap::Viridis),
+      m_heatmapRange(0.5f),
+      m_colormapTexture(0),
+      m_colormapTextureName(-1)
 {
     // Set initial rotation for better 3D viewing angle
-    m_rotation = QQuaternion::fromEulerAngles(15.0f, 25.0f, 0.0f);
+    m_rotation = kReferenceRotation;
+
+    // Start at the finest tessellation and let selection coarsen from there
+    for (int& level : m_lodLevels) {
+        level = 0;
+    }
 
     qDebug() << "OpenGL3DRenderer created - Dual model research renderer initialized";
 }
 
 OpenGL3DRenderer::~OpenGL3DRenderer() {
-    // Clean up OpenGL resources
-    delete m_program;
-    delete m_vertexBuffer;
-    delete m_indexBuffer;
-    delete m_normalBuffer;
-    delete m_sphereVertexBuffer;
-    delete m_sphereIndexBuffer;
-    delete m_sphereNormalBuffer;
+    // Clean up OpenGL resources. Programs, meshes and glyphs are shared with the other
+    // renderers of the context group and destroyed with the last reference.
+    m_sharedPrograms.clear();
+    delete m_frameCapture;  // Flushes and closes a running recording
+    delete m_oitFramebuffer;
+    delete m_fullscreenVao;
+    delete m_referenceLayer;
+    delete m_silhouetteOverlap;
+    delete m_markerVao;
+    delete m_markerInstanceBuffer;
+    delete m_labelVao;
+    delete m_labelInstanceBuffer;
+    m_glyphAtlas.reset();
+    delete m_modelVao;
+    m_modelMesh.reset();
+    delete m_geometryVao;
+    m_geometryAtlas.reset();
+    delete m_programCache;
+    if (m_frameUniformBuffer) {
+        glDeleteBuffers(1, &m_frameUniformBuffer);
+    }
+    if (m_colormapTexture) {
+        glDeleteTextures(1, &m_colormapTexture);
+    }
+    delete m_frameProfiler;
+    delete m_renderQueue;
+    delete m_glState;
 
     qDebug() << "OpenGL3DRenderer destroyed - All resources cleaned up";
 }
@@ -108,46 +519,389 @@ void OpenGL3DRenderer::render() {
         m_initialized = true;
     }
 
-    // Clear framebuffer with dark background for research contrast
+    m_frameProfiler->beginFrame();
+    m_glState->reset();  // Whatever Qt Quick left bound is unknown
+    applyRenderState();
+
+    // The whole framebuffer object, or only the item's part of the window
+    setViewport(m_targetOrigin);
+    if (m_directTarget) {
+        m_glState->setEnabled(GLStateTracker::ScissorTest, true);
+        glScissor(m_targetOrigin.x(), m_targetOrigin.y(), m_viewportSize.width(),
+                  m_viewportSize.height());
+    }
+
+    // Clear framebuffer with dark background for research contrast (clears honour the
+    // depth and color masks)
+    m_glState->setDepthMask(true);
+    m_glState->setColorMask(true);
     glClearColor(0.15f, 0.15f, 0.2f, 1.0f);  // Dark blue-gray background
     glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+    m_glState->setEnabled(GLStateTracker::ScissorTest, false);
 
-    // Enable depth testing and blending for transparency
-    glEnable(GL_DEPTH_TEST);
-    glDepthFunc(GL_LESS);
-    glEnable(GL_BLEND);
-    glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+    // Enable depth testing
+    m_glState->setEnabled(GLStateTracker::DepthTest, true);
+    m_glState->setDepthFunc(GL_LESS);
 
     // Setup camera matrices (shared by both models)
     setupCameraMatrices();
 
+    // Colormap lookup for the alignment heatmap, uploaded when the map changes
+    if (m_alignmentHeatmap && m_colormapTextureName != m_heatmapColormap) {
+        updateColormapTexture();
+    }
+
+    // Weighted blended transparency when its targets exist at the framebuffer size
+    bool orderIndependent = m_orderIndependentTransparency && m_oitProgram &&
+                            m_compositeProgram && m_oitFramebuffer->resize(m_viewportSize);
+    if (orderIndependent) {
+        renderOrderIndependent();
+    } else {
+        renderBlended();
+    }
+
+    // Numbered labels over the finished scene, one instanced draw for both models
+    if (m_showVertexLabels) {
+        m_frameProfiler->beginPass(FrameSample::LabelPass);
+        renderLabelText();
+        flushDraws();
+        m_frameProfiler->endPass(FrameSample::LabelPass);
+    }
+
+    // Image-space alignment score, read back a frame or more later
+    m_frameProfiler->beginPass(FrameSample::OverlapPass);
+    measureSilhouetteOverlap();
+    m_frameProfiler->endPass(FrameSample::OverlapPass);
+
+    // Restore OpenGL state: writes on, blending off, nothing bound
+    m_glState->setEnabled(GLStateTracker::Blend, false);
+    m_glState->setEnabled(GLStateTracker::DepthTest, true);
+    m_glState->setDepthMask(true);
+    m_glState->setColorMask(true);
+    m_glState->restoreDefaults();
+
+    m_frameProfiler->setCallCounts(m_glState->issuedCalls(), m_glState->skippedCalls());
+    m_frameProfiler->endFrame();
+
+    // Queue a readback of the finished frame for the session recording
+    m_frameCapture->captureFrame(m_viewportSize, m_targetOrigin);
+
+    // Qt Quick draws the rest of the window into the same depth and stencil buffers
+    if (m_directTarget) {
+        m_glState->setEnabled(GLStateTracker::ScissorTest, true);
+        glScissor(m_targetOrigin.x(), m_targetOrigin.y(), m_viewportSize.width(),
+                  m_viewportSize.height());
+        glClear(GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+        m_glState->setEnabled(GLStateTracker::ScissorTest, false);
+    }
+}
+
+void OpenGL3DRenderer::applyRenderState() {
+    if (!m_renderStates || !m_renderStates->consume()) {
+        return;
+    }
+    const RenderState& state = m_renderStates->readBuffer();
+
+    // Shape switches only select a different draw range in the geometry atlas
+    if (m_currentShape != state.shape) {
+        m_currentShape = state.shape;
+        m_referenceLayer->invalidate();
+        m_silhouetteOverlap->invalidateReference();
+        qDebug() << "Shape changed to:" << state.shape;
+    }
+
+    // A newly loaded model is uploaded once, here where the context is current
+    if (m_modelData != state.model || m_stlModel != state.stlModel ||
+        m_cachedModel != state.cachedModel) {
+        m_modelData = state.model;
+        m_stlModel = state.stlModel;
+        m_cachedModel = state.cachedModel;
+        updateModelMesh();
+        if (m_currentShape == OpenGL3DViewport::MODEL) {
+            m_referenceLayer->invalidate();
+            m_silhouetteOverlap->invalidateReference();
+        }
+    }
+
+    m_translation = state.translation;
+    m_rotation = state.rotation;
+    m_scale = state.scale;
+
+    m_showReferenceModel = state.showReferenceModel;
+    m_showMovableModel = state.showMovableModel;
+    m_showVertexLabels = state.showVertexLabels;
+    m_edgeWidth = state.edgeWidth;
+    m_orderIndependentTransparency = state.orderIndependentTransparency;
+    m_alignmentHeatmap = state.alignmentHeatmap;
+    m_heatmapColormap = state.heatmapColormap;
+    m_heatmapRange = state.heatmapRange;
+}
+
+void OpenGL3DRenderer::setViewport(const QPoint& origin) {
+    glViewport(origin.x(), origin.y(), m_viewportSize.width(), m_viewportSize.height());
+}
+
+void OpenGL3DRenderer::setDirectTarget(const QRect& rect, int samples) {
+    // The window target is always drawn at full resolution, so the render scale is fixed
+    m_directTarget = true;
+    m_targetOrigin = rect.topLeft();
+    m_viewportSize = rect.size();
+    m_framebufferSize = rect.size();
+    m_framebufferSamples = samples;
+    m_renderScale = 1.0f;
+}
+
+void OpenGL3DRenderer::renderBlended() {
+    // Classic alpha blending in fixed draw order (depends on which model is drawn first)
+    m_drawState = DrawState();
+    m_drawState.blending = DrawState::AlphaBlend;
+
     // Render dual models for research alignment task
     if (m_showReferenceModel) {
-        renderReferenceModel();  // Semi-transparent reference model
+        m_frameProfiler->beginPass(FrameSample::ReferencePass);
+        renderReferenceLayer();  // Semi-transparent reference model
+        flushDraws();
+        m_frameProfiler->endPass(FrameSample::ReferencePass);
     }
 
     if (m_showMovableModel) {
+        m_frameProfiler->beginPass(FrameSample::MovablePass);
         renderMovableModel();  // User-controlled colored model
+        flushDraws();
+        m_frameProfiler->endPass(FrameSample::MovablePass);
+    }
+
+    // Render solid vertex markers on top for alignment feedback
+    if (m_showVertexLabels) {
+        m_drawState.blending = DrawState::Opaque;
+        m_frameProfiler->beginPass(FrameSample::MarkerPass);
+        renderVertexLabels();
+        flushDraws();
+        m_frameProfiler->endPass(FrameSample::MarkerPass);
     }
+}
 
-    // Render vertex markers on top for alignment feedback
+void OpenGL3DRenderer::renderOrderIndependent() {
+    // The framebuffer Qt Quick bound for this item receives the composited result
+    GLint targetFramebuffer = 0;
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &targetFramebuffer);
+
+    // Opaque markers first, then their depth into the transparency targets so they
+    // occlude the transparent surfaces behind them
+    m_drawState = DrawState();
+    m_frameProfiler->beginPass(FrameSample::MarkerPass);
     if (m_showVertexLabels) {
         renderVertexLabels();
+        flushDraws();
+    }
+    m_glState->setDepthMask(true);
+    m_glState->setColorMask(true);
+    m_oitFramebuffer->bindAndClear();
+    setViewport(QPoint());
+    if (m_showVertexLabels) {
+        m_drawState.colorWrite = false;
+        drawMarkerBatches();
+        flushDraws();
+    }
+    m_frameProfiler->endPass(FrameSample::MarkerPass);
+
+    // Transparent surfaces accumulate in any order, depth-tested but not written
+    m_drawState = DrawState();
+    m_drawState.blending = DrawState::Accumulate;
+    m_drawState.depthWrite = false;
+    m_oitActive = true;
+
+    if (m_showReferenceModel) {
+        m_frameProfiler->beginPass(FrameSample::ReferencePass);
+        renderReferenceLayer();
+        flushDraws();
+        m_frameProfiler->endPass(FrameSample::ReferencePass);
+    }
+
+    if (m_showMovableModel) {
+        m_frameProfiler->beginPass(FrameSample::MovablePass);
+        renderMovableModel();
+        flushDraws();
+        m_frameProfiler->endPass(FrameSample::MovablePass);
+    }
+
+    m_oitActive = false;
+
+    // Resolve over the opaque scene in the item's framebuffer
+    glBindFramebuffer(GL_FRAMEBUFFER, targetFramebuffer);
+    setViewport(m_targetOrigin);
+    m_frameProfiler->beginPass(FrameSample::CompositePass);
+    compositeTransparency();
+    m_frameProfiler->endPass(FrameSample::CompositePass);
+}
+
+void OpenGL3DRenderer::compositeTransparency() {
+    m_glState->setEnabled(GLStateTracker::DepthTest, false);
+    m_glState->setEnabled(GLStateTracker::Blend, true);
+    m_glState->setBlendFunc(GL_ONE_MINUS_SRC_ALPHA, GL_SRC_ALPHA);
+    m_glState->setColorMask(true);
+
+    m_glState->bindTexture(0, m_oitFramebuffer->accumulationTexture());
+    m_glState->bindTexture(1, m_oitFramebuffer->weightTexture());
+
+    m_glState->useProgram(m_compositeProgram);
+    m_compositeProgram->setUniformValue(m_compositeOriginLocation, QPointF(m_targetOrigin));
+    m_glState->bindVertexArray(m_fullscreenVao);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    m_glState->countDrawCall();
+
+    // Leave depth testing as the scene graph expects it
+    m_glState->setEnabled(GLStateTracker::DepthTest, true);
+}
+
+void OpenGL3DRenderer::renderReferenceLayer() {
+    // Blended mode copies into the item framebuffer, which must match the layer exactly.
+    // Window targets have formats of their own, so there it only serves transparency.
+    ReferenceLayer::Mode mode =
+        m_oitActive ? ReferenceLayer::OrderIndependent : ReferenceLayer::Blended;
+    bool layerReady = (m_oitActive || !m_directTarget) &&
+                      m_referenceLayer->resize(mode, m_viewportSize, m_framebufferSamples) &&
+                      (!m_oitActive || m_referenceSeedProgram);
+    if (!layerReady) {
+        renderReferenceModel();
+        return;
+    }
+
+    GLint targetFramebuffer = 0;
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &targetFramebuffer);
+
+    // Shade the reference only when its shape or the render target changed
+    if (!m_referenceLayer->isCurrent()) {
+        updateReferenceLayer();
+        glBindFramebuffer(GL_FRAMEBUFFER, targetFramebuffer);
+    }
+
+    if (m_oitActive) {
+        seedReferenceLayer();
+    } else {
+        m_referenceLayer->blitTo(targetFramebuffer);
+    }
+}
+
+void OpenGL3DRenderer::updateReferenceLayer() {
+    // Clearing honours the depth mask, which the transparency pass has turned off
+    m_glState->setDepthMask(true);
+    m_glState->setColorMask(true);
+    m_referenceLayer->bindAndClear();
+
+    // Drawn before the caller rebinds its own framebuffer. Blended: background plus the
+    // blended reference, exactly as the live pass leaves it.
+    renderReferenceModel();
+    flushDraws();
+
+    if (m_oitActive) {
+        // Accumulated as in the live pass above, now the nearest surface depth for seeding
+        DrawState accumulate = m_drawState;
+        m_drawState.depthWrite = true;
+        m_drawState.colorWrite = false;
+        renderReferenceModel();
+        flushDraws();
+        m_drawState = accumulate;
+    }
+
+    m_referenceLayer->setCurrent();
+    qDebug() << "Reference layer updated for shape" << m_currentShape;
+}
+
+void OpenGL3DRenderer::seedReferenceLayer() {
+    // Written over the cleared transparency targets, so no blending. Surfaces behind the
+    // nearest reference surface still count at marker pixels in between; markers sit on
+    // the surface, so the difference stays within the marker outline.
+    m_glState->setEnabled(GLStateTracker::Blend, false);
+    m_glState->setEnabled(GLStateTracker::DepthTest, true);
+    m_glState->setDepthMask(false);
+    m_glState->setColorMask(true);
+
+    m_glState->bindTexture(0, m_referenceLayer->accumulationTexture());
+    m_glState->bindTexture(1, m_referenceLayer->weightTexture());
+    m_glState->bindTexture(2, m_referenceLayer->depthTexture());
+
+    m_glState->useProgram(m_referenceSeedProgram);
+    m_glState->bindVertexArray(m_fullscreenVao);
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    m_glState->countDrawCall();
+}
+
+void OpenGL3DRenderer::measureSilhouetteOverlap() {
+    if (!m_silhouetteProgram || !m_fullscreenSilhouetteProgram || !m_geometryAtlas ||
+        !m_geometryAtlas->isCreated()) {
+        return;
+    }
+
+    // Movable model at its alignment pose, as calculateAlignmentAccuracy() measures it
+    QMatrix4x4 movableMatrix;
+    movableMatrix.translate(m_translation);
+    movableMatrix.rotate(m_rotation);
+    movableMatrix.scale(m_scale);
+
+    // Nothing moved since the last measurement: its result is still valid
+    if (!m_silhouetteOverlap->needsReference() && movableMatrix == m_measuredMovableMatrix) {
+        m_silhouetteOverlap->poll();
+        return;
+    }
+    if (!m_silhouetteOverlap->begin(m_viewportSize)) {
+        return;
     }
 
-    // Restore OpenGL state
-    glDisable(GL_BLEND);
+    // Levels selected here like the render passes do, since those are skipped for hidden
+    // models and a level kept from another shape may not exist for the current one
+    const GeometryAtlas::Mesh mesh = GeometryAtlas::meshForShape(m_currentShape);
+    m_glState->useProgram(m_silhouetteProgram);
+    if (m_silhouetteOverlap->needsReference()) {
+        const QMatrix4x4 referenceMatrix = referenceModelMatrix();
+        m_silhouetteProgram->setUniformValue(m_silhouetteUniforms.modelMatrix, referenceMatrix);
+        const int referenceLevel =
+            selectLod(ReferenceModelLod, mesh,
+                      projectedRadius(referenceMatrix.map(QVector3D()),
+                                      GeometryAtlas::boundingRadius(mesh)));
+
+        m_silhouetteOverlap->beginReference();
+        bindAndRenderGeometry(referenceLevel);
+        m_silhouetteOverlap->endReference();
+    }
+
+    const int movableLevel =
+        selectLod(MovableModelLod, mesh,
+                  projectedRadius(movableMatrix.map(QVector3D()),
+                                  GeometryAtlas::boundingRadius(mesh) * qAbs(m_scale)));
+    m_silhouetteProgram->setUniformValue(m_silhouetteUniforms.modelMatrix, movableMatrix);
+    m_silhouetteOverlap->beginMovable();
+    bindAndRenderGeometry(movableLevel);
+    m_silhouetteOverlap->endMovable();
+
+    // One fragment per pixel tests both stencil bits
+    m_glState->useProgram(m_fullscreenSilhouetteProgram);
+    m_glState->bindVertexArray(m_fullscreenVao);
+    m_silhouetteOverlap->beginIntersection();
+    glDrawArrays(GL_TRIANGLES, 0, 3);
+    m_glState->countDrawCall();
+    m_silhouetteOverlap->endIntersection();
+
+    // Depth and stencil state were changed outside the tracker
+    m_silhouetteOverlap->end();
+    m_glState->invalidate();
+    m_measuredMovableMatrix = movableMatrix;
 }
 
 QOpenGLFramebufferObject* OpenGL3DRenderer::createFramebufferObject(const QSize& size) {
-    m_viewportSize = size;
+    // Reduced render scale: Qt Quick stretches the smaller texture over the item
+    QSize renderSize = (QSizeF(size) * m_renderScale).toSize().expandedTo(QSize(1, 1));
+    m_viewportSize = renderSize;
 
     // Create framebuffer with combined depth/stencil
     QOpenGLFramebufferObjectFormat format;
     format.setAttachment(QOpenGLFramebufferObject::CombinedDepthStencil);
-    format.setSamples(4);  // Enable 4x MSAA for smoother edges
+    format.setSamples(m_sampleCount);
 
-    return new QOpenGLFramebufferObject(size, format);
+    QOpenGLFramebufferObject* framebuffer = new QOpenGLFramebufferObject(renderSize, format);
+    m_framebufferSize = framebuffer->size();
+    m_framebufferSamples = framebuffer->format().samples();
+    return framebuffer;
 }
 
 void OpenGL3DRenderer::synchronize(QQuickFramebufferObject* item) {
@@ -157,33 +911,60 @@ void OpenGL3DRenderer::synchronize(QQuickFramebufferObject* item) {
         return;
     }
 
-    // Check if shape changed and regenerate geometry if needed
-    int newShape = viewport->currentShape();
-    if (m_currentShape != newShape) {
-        m_currentShape = newShape;
-        generateGeometry();
-        qDebug() << "Shape changed to:" << newShape;
+    // Scene state arrives through the snapshot buffer, consumed in render()
+    m_renderStates = viewport->renderStates();
+
+    // Resolution scale and MSAA changes need a new framebuffer object
+    float renderScale = viewport->renderScale();
+    int sampleCount = viewport->requestedSampleCount();
+    if (!qFuzzyCompare(m_renderScale, renderScale) || m_sampleCount != sampleCount) {
+        m_renderScale = renderScale;
+        m_sampleCount = sampleCount;
+        invalidateFramebufferObject();
+    }
+
+    // Start, stop or switch the session recording
+    if (m_captureSession != viewport->captureSession()) {
+        m_captureSession = viewport->captureSession();
+        m_frameCapture->stop();
+        if (viewport->capturing()) {
+            m_frameCapture->start(viewport->capturePath(), kCaptureFramesPerSecond);
+        }
     }
 
-    // Sync transform data
-    m_translation = viewport->translation();
+    // Hand finished frame timings, the current render target and capture counters back to
+    // the viewport (GUI thread is blocked here)
+    viewport->reportRenderTarget(m_framebufferSize, m_framebufferSamples);
+    viewport->reportCaptureStats(m_frameCapture->capturedFrames(),
+                                 m_frameCapture->droppedFrames());
+    viewport->reportSilhouetteOverlap(m_silhouetteOverlap->overlap(),
+                                      m_silhouetteOverlap->pending());
+    viewport->appendFrameSamples(takeFrameSamples());
+}
 
-    // Convert Euler angles to quaternion for smooth rotation
-    QVector3D rot = viewport->rotation();
-    m_rotation = QQuaternion::fromEulerAngles(rot.x(), rot.y(), rot.z());
+void OpenGL3DRenderer::setSyntheticMarkerCount(int count) {
+    m_syntheticMarkers = count > 0 ? syntheticMarkerPositions(count) : QVector<QVector3D>();
+}
 
-    m_scale = viewport->scale();
+QVector<FrameSample> OpenGL3DRenderer::takeFrameSamples(bool waitForGpu) {
+    if (!m_frameProfiler) {
+        return QVector<FrameSample>();
+    }
 
-    // Sync research display settings
-    m_showReferenceModel = viewport->showReferenceModel();
-    m_showMovableModel = viewport->showMovableModel();
-    m_showVertexLabels = viewport->showVertexLabels();
+    if (waitForGpu) {
+        m_frameProfiler->flush();
+    }
+    return m_frameProfiler->takeSamples();
 }
 
 void OpenGL3DRenderer::initializeGL() {
     // Initialize OpenGL functions
     initializeOpenGLFunctions();
 
+    // Per-pass CPU timers and non-blocking GPU timer queries
+    m_frameProfiler = new FrameProfiler();
+    m_frameProfiler->initialize();
+
     qDebug() << "Initializing OpenGL for dual-model research renderer...";
     qDebug() << "OpenGL version:" << (char*)glGetString(GL_VERSION);
     qDebug() << "GLSL version:" << (char*)glGetString(GL_SHADING_LANGUAGE_VERSION);
@@ -194,38 +975,307 @@ void OpenGL3DRenderer::initializeGL() {
         return;
     }
 
-    // Generate initial geometry
-    generateGeometry();
+    // Transparency targets (sized on first use) and the attribute-less fullscreen pass,
+    // created with the programs that use them so a later failure cannot leave them missing
+    m_oitFramebuffer = new OitFramebuffer();
+    m_fullscreenVao = new QOpenGLVertexArrayObject();
+    m_fullscreenVao->create();
+
+    // Every shape and the vertex marker sphere, built by the first renderer of the context
+    // group. Vertex array objects are per context, so this one is our own.
+    m_geometryAtlas = GpuResourceCache::geometryAtlas();
+    if (!m_geometryAtlas) {
+        qDebug() << "ERROR: Failed to create geometry atlas!";
+        return;
+    }
+    m_geometryVao = new QOpenGLVertexArrayObject();
+    if (!m_geometryVao->create()) {
+        qDebug() << "ERROR: Failed to create geometry vertex array!";
+        return;
+    }
+    m_geometryVao->bind();
+    m_geometryAtlas->setupVertexAttributes();
+    m_geometryVao->release();
+
+    // Marker VAO sharing the atlas buffers plus a per-instance stream
+    if (!setupMarkerInstancing()) {
+        qDebug() << "ERROR: Failed to setup marker instancing!";
+        return;
+    }
 
-    // Generate sphere markers for vertex labeling
-    generateSphereMarkerGeometry();
+    // Distance field glyphs for the numbered labels, generated once per context group
+    m_glyphAtlas = GpuResourceCache::glyphAtlas();
+    if (!m_labelProgram || !m_glyphAtlas || !setupLabelInstancing()) {
+        qDebug() << "WARNING: Vertex label text unavailable";
+    } else {
+        m_labelProgram->bind();
+        m_labelProgram->setUniformValue("glyphAtlas", 0);
+        m_labelProgram->setUniformValue("glyphCount", float(m_glyphAtlas->glyphCount()));
+        m_labelProgram->release();
+    }
 
     qDebug() << "Research OpenGL 3D Renderer initialized successfully";
 }
 
 bool OpenGL3DRenderer::setupShaders() {
-    // Create shader program
-    m_program = new QOpenGLShaderProgram();
+    QElapsedTimer setupTimer;
+    setupTimer.start();
 
-    // Compile vertex shader
-    if (!m_program->addShaderFromSourceCode(QOpenGLShader::Vertex, vertexShaderSource)) {
-        qDebug() << "ERROR: Failed to compile vertex shader:" << m_program->log();
+    // Cached program binaries skip compilation on later starts
+    m_programCache = new ProgramBinaryCache();
+    m_programCache->initialize();
+
+    // Main lit program for the reference and movable models
+    m_program = createProgram(vertexShaderSource, fragmentShaderSource);
+    if (!m_program) {
         return false;
     }
 
-    // Compile fragment shader
-    if (!m_program->addShaderFromSourceCode(QOpenGLShader::Fragment, fragmentShaderSource)) {
-        qDebug() << "ERROR: Failed to compile fragment shader:" << m_program->log();
+    // Instanced program for vertex markers (shares the fragment stage)
+    m_markerProgram = createProgram(markerVertexShaderSource, fragmentShaderSource);
+    if (!m_markerProgram) {
         return false;
     }
 
+    // Single-pass filled surface plus edges for the movable model. Without geometry
+    // shaders the movable model is drawn filled only.
+    m_wireframeProgram = createProgram(vertexShaderSource, wireframeFragmentShaderSource,
+                                       wireframeGeometryShaderSource);
+    if (!m_wireframeProgram) {
+        qDebug() << "WARNING: Wireframe program unavailable, edges disabled";
+    }
+
+    // Order-independent transparency variants of the model programs plus the resolve
+    // pass. Without them the models fall back to sorted alpha blending.
+    QByteArray oitFragmentSource = shaderVariant(fragmentShaderSource, "ORDER_INDEPENDENT");
+    QByteArray oitWireframeFragmentSource =
+        shaderVariant(wireframeFragmentShaderSource, "ORDER_INDEPENDENT");
+    m_oitProgram = createProgram(vertexShaderSource, oitFragmentSource.constData());
+    if (m_wireframeProgram) {
+        m_oitWireframeProgram =
+            createProgram(vertexShaderSource, oitWireframeFragmentSource.constData(),
+                          wireframeGeometryShaderSource);
+    }
+    m_compositeProgram = createProgram(fullscreenVertexShaderSource, compositeFragmentShaderSource);
+    if (m_compositeProgram) {
+        m_compositeProgram->bind();
+        m_compositeProgram->setUniformValue("accumulationTexture", 0);
+        m_compositeProgram->setUniformValue("weightTexture", 1);
+        m_compositeProgram->release();
+        m_compositeOriginLocation = m_compositeProgram->uniformLocation("targetOrigin");
+    }
+    if (!m_oitProgram || !m_compositeProgram) {
+        qDebug() << "WARNING: Order-independent transparency unavailable";
+    }
+
+    // Copies the cached reference layer into the transparency targets
+    m_referenceSeedProgram =
+        createProgram(fullscreenVertexShaderSource, referenceSeedFragmentShaderSource);
+    if (m_referenceSeedProgram) {
+        m_referenceSeedProgram->bind();
+        m_referenceSeedProgram->setUniformValue("accumulationTexture", 0);
+        m_referenceSeedProgram->setUniformValue("weightTexture", 1);
+        m_referenceSeedProgram->setUniformValue("depthTexture", 2);
+        m_referenceSeedProgram->release();
+    }
+
+    // Stencil-only silhouettes of both models and the fullscreen intersection pass
+    m_silhouetteProgram = createProgram(vertexShaderSource, silhouetteFragmentShaderSource);
+    m_fullscreenSilhouetteProgram =
+        createProgram(fullscreenVertexShaderSource, silhouetteFragmentShaderSource);
+    if (!m_silhouetteProgram || !m_fullscreenSilhouetteProgram) {
+        qDebug() << "WARNING: Silhouette overlap metric unavailable";
+    }
+
+    // Billboarded label glyphs (optional, like the markers they annotate)
+    m_labelProgram = createProgram(labelVertexShaderSource, labelFragmentShaderSource);
+
+    // Resolve uniform locations once instead of by name on every draw
+    m_programUniforms = resolveUniforms(m_program);
+    m_markerUniforms = resolveUniforms(m_markerProgram);
+    if (m_wireframeProgram) {
+        m_wireframeUniforms = resolveUniforms(m_wireframeProgram);
+    }
+    if (m_oitProgram) {
+        m_oitUniforms = resolveUniforms(m_oitProgram);
+    }
+    if (m_oitWireframeProgram) {
+        m_oitWireframeUniforms = resolveUniforms(m_oitWireframeProgram);
+    }
+    if (m_silhouetteProgram) {
+        m_silhouetteUniforms = resolveUniforms(m_silhouetteProgram);
+    }
+    if (m_labelProgram) {
+        m_labelUniforms = resolveUniforms(m_labelProgram);
+    }
+
+    // Per-frame camera and light data shared by both programs
+    glGenBuffers(1, &m_frameUniformBuffer);
+    glBindBuffer(GL_UNIFORM_BUFFER, m_frameUniformBuffer);
+    glBufferData(GL_UNIFORM_BUFFER, sizeof(FrameDataBlock), nullptr, GL_DYNAMIC_DRAW);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+    qDebug() << "Shaders compiled and linked successfully in" << setupTimer.elapsed() << "ms";
+    return true;
+}
+
+OpenGL3DRenderer::UniformLocations OpenGL3DRenderer::resolveUniforms(
+    QOpenGLShaderProgram* program) {
+    UniformLocations locations;
+    locations.modelMatrix = program->uniformLocation("modelMatrix");
+    locations.normalMatrix = program->uniformLocation("normalMatrix");
+    locations.color = program->uniformLocation("color");
+    locations.alpha = program->uniformLocation("alpha");
+    locations.edgeAlpha = program->uniformLocation("edgeAlpha");
+    locations.edgeWidth = program->uniformLocation("edgeWidth");
+    locations.viewportSize = program->uniformLocation("viewportSize");
+    locations.referenceMatrix = program->uniformLocation("referenceMatrix");
+    locations.alignmentOffset = program->uniformLocation("alignmentOffset");
+    locations.heatmap = program->uniformLocation("heatmap");
+    locations.heatmapRange = program->uniformLocation("heatmapRange");
+    locations.glyphSize = program->uniformLocation("glyphSize");
+    locations.labelOffset = program->uniformLocation("labelOffset");
+
+    // Attach the FrameData block to its fixed binding point
+    GLuint blockIndex = glGetUniformBlockIndex(program->programId(), "FrameData");
+    if (blockIndex != GL_INVALID_INDEX) {
+        glUniformBlockBinding(program->programId(), blockIndex, kFrameDataBinding);
+    }
+
+    return locations;
+}
+
+QOpenGLShaderProgram* OpenGL3DRenderer::createProgram(const char* vertexSource,
+                                                      const char* fragmentSource,
+                                                      const char* geometrySource) {
+    // Linked once per render thread and shared by every renderer on it
+    QByteArray cacheKey = m_programCache->key({vertexSource, geometrySource, fragmentSource});
+    bool built = false;
+    QSharedPointer<QOpenGLShaderProgram> program = GpuResourceCache::program(cacheKey, [&]() {
+        built = true;
+        return buildProgram(vertexSource, fragmentSource, geometrySource, cacheKey);
+    });
+    if (!program) {
+        return nullptr;
+    }
+
+    if (!built) {
+        qDebug() << "Program shared" << cacheKey.left(8) << "- already linked on this thread";
+    }
+    m_sharedPrograms.append(program);
+    return program.data();
+}
+
+QOpenGLShaderProgram* OpenGL3DRenderer::buildProgram(const char* vertexSource,
+                                                     const char* fragmentSource,
+                                                     const char* geometrySource,
+                                                     const QByteArray& cacheKey) {
+    QElapsedTimer linkTimer;
+    linkTimer.start();
+
+    // Linked binary from a previous run with the same sources and driver
+    QOpenGLShaderProgram* program = new QOpenGLShaderProgram();
+    if (m_programCache->load(program, cacheKey)) {
+        qDebug() << "Program cache hit" << cacheKey.left(8) << "- loaded in"
+                 << linkTimer.nsecsElapsed() / 1.0e6 << "ms";
+        return program;
+    }
+
+    // Missing or rejected binary: start over with a fresh program object
+    delete program;
+    program = new QOpenGLShaderProgram();
+    program->create();
+
+    // Compile vertex shader
+    if (!program->addShaderFromSourceCode(QOpenGLShader::Vertex, vertexSource)) {
+        qDebug() << "ERROR: Failed to compile vertex shader:" << program->log();
+        delete program;
+        return nullptr;
+    }
+
+    // Compile optional geometry shader
+    if (geometrySource &&
+        !program->addShaderFromSourceCode(QOpenGLShader::Geometry, geometrySource)) {
+        qDebug() << "ERROR: Failed to compile geometry shader:" << program->log();
+        delete program;
+        return nullptr;
+    }
+
+    // Compile fragment shader
+    if (!program->addShaderFromSourceCode(QOpenGLShader::Fragment, fragmentSource)) {
+        qDebug() << "ERROR: Failed to compile fragment shader:" << program->log();
+        delete program;
+        return nullptr;
+    }
+
     // Link shader program
-    if (!m_program->link()) {
-        qDebug() << "ERROR: Failed to link shader program:" << m_program->log();
+    m_programCache->prepareForSave(program);
+    if (!program->link()) {
+        qDebug() << "ERROR: Failed to link shader program:" << program->log();
+        delete program;
+        return nullptr;
+    }
+
+    m_programCache->save(program, cacheKey);
+    qDebug() << "Program cache miss" << cacheKey.left(8) << "- compiled and linked in"
+             << linkTimer.nsecsElapsed() / 1.0e6 << "ms";
+    return program;
+}
+
+bool OpenGL3DRenderer::setupMarkerInstancing() {
+    m_markerInstanceBuffer = new QOpenGLBuffer(QOpenGLBuffer::VertexBuffer);
+    m_markerInstanceBuffer->setUsagePattern(QOpenGLBuffer::DynamicDraw);
+    if (!m_markerInstanceBuffer->create()) {
+        return false;
+    }
+
+    m_markerVao = new QOpenGLVertexArrayObject();
+    if (!m_markerVao->create()) {
+        return false;
+    }
+
+    // Per-vertex sphere attributes come straight from the geometry atlas
+    m_markerVao->bind();
+    m_geometryAtlas->setupVertexAttributes();
+
+    // Per-instance attributes advance once per marker
+    m_markerInstanceBuffer->bind();
+    glEnableVertexAttribArray(2);
+    glVertexAttribDivisor(2, 1);
+    glEnableVertexAttribArray(3);
+    glVertexAttribDivisor(3, 1);
+    m_markerInstanceBuffer->release();
+    m_markerVao->release();
+
+    return true;
+}
+
+bool OpenGL3DRenderer::setupLabelInstancing() {
+    m_labelInstanceBuffer = new QOpenGLBuffer(QOpenGLBuffer::VertexBuffer);
+    m_labelInstanceBuffer->setUsagePattern(QOpenGLBuffer::DynamicDraw);
+    if (!m_labelInstanceBuffer->create()) {
         return false;
     }
 
-    qDebug() << "Shaders compiled and linked successfully";
+    m_labelVao = new QOpenGLVertexArrayObject();
+    if (!m_labelVao->create()) {
+        return false;
+    }
+
+    // No per-vertex data: the quad corners come from gl_VertexID
+    const int stride = kFloatsPerLabelInstance * sizeof(float);
+    m_labelVao->bind();
+    m_labelInstanceBuffer->bind();
+    glEnableVertexAttribArray(0);
+    glVertexAttribPointer(0, 4, GL_FLOAT, GL_FALSE, stride, nullptr);
+    glVertexAttribDivisor(0, 1);
+    glEnableVertexAttribArray(1);
+    glVertexAttribPointer(1, 4, GL_FLOAT, GL_FALSE, stride,
+                          reinterpret_cast<const void*>(4 * sizeof(float)));
+    glVertexAttribDivisor(1, 1);
+    m_labelInstanceBuffer->release();
+    m_labelVao->release();
+
     return true;
 }
 
@@ -237,54 +1287,86 @@ void OpenGL3DRenderer::setupCameraMatrices() {
 
     // Setup view matrix with fixed camera position for research consistency
     m_viewMatrix.setToIdentity();
-    QVector3D cameraPos(4.0f, 3.0f, 6.0f);  // Camera position
-    QVector3D target(0.0f, 0.0f, 0.0f);     // Look at origin
-    QVector3D up(0.0f, 1.0f, 0.0f);         // Up vector
-    m_viewMatrix.lookAt(cameraPos, target, up);
+    QVector3D target(0.0f, 0.0f, 0.0f);  // Look at origin
+    QVector3D up(0.0f, 1.0f, 0.0f);      // Up vector
+    m_viewMatrix.lookAt(kCameraPosition, target, up);
+
+    // Write camera and light data once per frame for every program
+    FrameDataBlock frameData;
+    QMatrix4x4 viewProjection = m_projectionMatrix * m_viewMatrix;
+    memcpy(frameData.viewProjectionMatrix, viewProjection.constData(), 16 * sizeof(float));
+    frameData.lightPos[0] = kLightPosition.x();
+    frameData.lightPos[1] = kLightPosition.y();
+    frameData.lightPos[2] = kLightPosition.z();
+    frameData.lightPos[3] = 1.0f;
+    frameData.viewPos[0] = kCameraPosition.x();
+    frameData.viewPos[1] = kCameraPosition.y();
+    frameData.viewPos[2] = kCameraPosition.z();
+    frameData.viewPos[3] = 1.0f;
+
+    glBindBuffer(GL_UNIFORM_BUFFER, m_frameUniformBuffer);
+    glBufferSubData(GL_UNIFORM_BUFFER, 0, sizeof(FrameDataBlock), &frameData);
+    glBindBuffer(GL_UNIFORM_BUFFER, 0);
+    glBindBufferBase(GL_UNIFORM_BUFFER, kFrameDataBinding, m_frameUniformBuffer);
 }
 
 void OpenGL3DRenderer::renderReferenceModel() {
     // Render the semi-transparent reference model at fixed position
-    if (!m_program || !m_vertexBuffer || !m_indexBuffer || m_vertices.isEmpty()) {
+    if (!m_program || !m_geometryAtlas || !m_geometryAtlas->isCreated()) {
         return;
     }
 
-    m_program->bind();
+    QOpenGLShaderProgram* program = m_oitActive ? m_oitProgram : m_program;
+    const UniformLocations uniforms = m_oitActive ? m_oitUniforms : m_programUniforms;
 
     // REFERENCE MODEL: Fixed transformation with good 3D viewing angle
-    QMatrix4x4 referenceMatrix;
-    referenceMatrix.setToIdentity();
-    referenceMatrix.rotate(QQuaternion::fromEulerAngles(15.0f, 25.0f, 0.0f));
-
-    // Calculate matrices
-    QMatrix4x4 mvpMatrix = m_projectionMatrix * m_viewMatrix * referenceMatrix;
-    QMatrix3x3 normalMatrix = referenceMatrix.normalMatrix();
-
-    // Set shader uniforms
-    m_program->setUniformValue("mvpMatrix", mvpMatrix);
-    m_program->setUniformValue("modelMatrix", referenceMatrix);
-    m_program->setUniformValue("normalMatrix", normalMatrix);
-    m_program->setUniformValue("lightPos", QVector3D(5.0f, 5.0f, 5.0f));
-    m_program->setUniformValue("viewPos", QVector3D(4.0f, 3.0f, 6.0f));
-
-    // REFERENCE MODEL COLOR: Semi-transparent light blue-gray
-    QVector3D referenceColor(0.7f, 0.7f, 0.8f);
-    m_program->setUniformValue("color", referenceColor);
-    m_program->setUniformValue("alpha", 0.4f);  // Semi-transparent
-
-    // Bind and render geometry
-    bindAndRenderGeometry();
-
-    m_program->release();
+    const QMatrix4x4 referenceMatrix = referenceModelMatrix();
+
+    // Tessellation level from the projected size of the model
+    GeometryAtlas::Mesh mesh = GeometryAtlas::meshForShape(m_currentShape);
+    int level = selectLod(ReferenceModelLod, mesh,
+                          projectedRadius(referenceMatrix.map(QVector3D()),
+                                          GeometryAtlas::boundingRadius(mesh)));
+
+    RenderQueue::DrawItem item;
+    item.layer = ReferenceDraws;
+    item.program = program;
+    item.vertexArray = shapeVertexArray();
+    item.state = m_drawState;
+    item.draw = [this, program, uniforms, referenceMatrix, mesh, level]() {
+        // Per-draw uniforms only (camera and light come from the FrameData block)
+        program->setUniformValue(uniforms.modelMatrix, referenceMatrix);
+        program->setUniformValue(uniforms.normalMatrix, referenceMatrix.normalMatrix());
+
+        // REFERENCE MODEL COLOR: Semi-transparent light blue-gray
+        QVector3D referenceColor(0.7f, 0.7f, 0.8f);
+        program->setUniformValue(uniforms.color, referenceColor);
+        program->setUniformValue(uniforms.alpha, 0.4f);  // Semi-transparent
+        program->setUniformValue(uniforms.heatmap, false);
+
+        drawShape(mesh, level);
+    };
+    m_renderQueue->submit(item);
 }
 
 void OpenGL3DRenderer::renderMovableModel() {
     // Render the user-controlled colored model with visibility offset
-    if (!m_program || !m_vertexBuffer || !m_indexBuffer || m_vertices.isEmpty()) {
+    if (!m_program || !m_geometryAtlas || !m_geometryAtlas->isCreated()) {
         return;
     }
 
-    m_program->bind();
+    // Filled surface and edges in one draw when geometry shaders are available
+    QOpenGLShaderProgram* program = m_program;
+    const UniformLocations* uniformsPtr = &m_programUniforms;
+    if (m_oitActive) {
+        program = m_oitWireframeProgram ? m_oitWireframeProgram : m_oitProgram;
+        uniformsPtr = m_oitWireframeProgram ? &m_oitWireframeUniforms : &m_oitUniforms;
+    } else if (m_wireframeProgram) {
+        program = m_wireframeProgram;
+        uniformsPtr = &m_wireframeUniforms;
+    }
+    const UniformLocations uniforms = *uniformsPtr;
+    const bool wireframe = program == m_wireframeProgram || program == m_oitWireframeProgram;
 
     // MOVABLE MODEL: Apply user transformations with visibility offset
     QMatrix4x4 movableMatrix;
@@ -296,63 +1378,147 @@ void OpenGL3DRenderer::renderMovableModel() {
     movableMatrix.rotate(m_rotation);
     movableMatrix.scale(m_scale);
 
-    // Calculate matrices
-    QMatrix4x4 mvpMatrix = m_projectionMatrix * m_viewMatrix * movableMatrix;
-    QMatrix3x3 normalMatrix = movableMatrix.normalMatrix();
-
-    // Set shader uniforms
-    m_program->setUniformValue("mvpMatrix", mvpMatrix);
-    m_program->setUniformValue("modelMatrix", movableMatrix);
-    m_program->setUniformValue("normalMatrix", normalMatrix);
-    m_program->setUniformValue("lightPos", QVector3D(5.0f, 5.0f, 5.0f));
-    m_program->setUniformValue("viewPos", QVector3D(4.0f, 3.0f, 6.0f));
-
-    // MOVABLE MODEL COLOR: Distinct bright color based on shape type
-    QVector3D movableColor = getShapeColor(m_currentShape);
-    m_program->setUniformValue("color", movableColor);
-
-    // First pass: Semi-transparent fill
-    m_program->setUniformValue("alpha", 0.4f);
-    bindAndRenderGeometry();
-
-    // Second pass: Solid wireframe edges for better visibility
-    glPolygonMode(GL_FRONT_AND_BACK, GL_LINE);
-    glLineWidth(4.0f);  // Thick edges for research visibility
-    m_program->setUniformValue("alpha", 1.0f);
-    bindAndRenderGeometry();
+    // Tessellation level from the projected size of the scaled model. The wireframe shows
+    // every triangle edge, so it stays at the finest level: an edge pattern that changes
+    // as participants scale or move the model would be part of the stimulus.
+    GeometryAtlas::Mesh mesh = GeometryAtlas::meshForShape(m_currentShape);
+    int level = 0;
+    if (!wireframe) {
+        level = selectLod(MovableModelLod, mesh,
+                          projectedRadius(movableMatrix.map(QVector3D()),
+                                          GeometryAtlas::boundingRadius(mesh) * qAbs(m_scale)));
+    }
+
+    // Alignment heatmap: displacement from the reference pose, as measured by
+    // calculateAlignmentAccuracy() (without the visibility offset)
+    bool heatmap = m_alignmentHeatmap && m_colormapTexture;
+
+    RenderQueue::DrawItem item;
+    item.layer = MovableDraws;
+    item.program = program;
+    item.vertexArray = shapeVertexArray();
+    item.state = m_drawState;
+    item.draw = [this, program, uniforms, movableMatrix, visibilityOffset, heatmap, mesh,
+                 level]() {
+        // Per-draw uniforms only (camera and light come from the FrameData block)
+        program->setUniformValue(uniforms.modelMatrix, movableMatrix);
+        program->setUniformValue(uniforms.normalMatrix, movableMatrix.normalMatrix());
+
+        // MOVABLE MODEL COLOR: Distinct bright color based on shape type
+        QVector3D movableColor = getShapeColor(m_currentShape);
+        program->setUniformValue(uniforms.color, movableColor);
+
+        program->setUniformValue(uniforms.heatmap, heatmap);
+        if (heatmap) {
+            const QMatrix4x4 referenceMatrix = referenceModelMatrix();
+            program->setUniformValue(uniforms.referenceMatrix, referenceMatrix);
+            program->setUniformValue(uniforms.alignmentOffset, visibilityOffset);
+            program->setUniformValue(uniforms.heatmapRange, qMax(m_heatmapRange, 1e-4f));
+            m_glState->bindTexture(0, m_colormapTexture);
+        }
 
-    // Restore fill mode
-    glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+        // Semi-transparent fill with solid edges of m_edgeWidth pixels once upscaled.
+        // Heatmap colors need a nearly opaque fill to stay readable.
+        program->setUniformValue(uniforms.alpha, heatmap ? 0.85f : 0.4f);
+        program->setUniformValue(uniforms.edgeAlpha, 1.0f);
+        program->setUniformValue(uniforms.edgeWidth, m_edgeWidth * m_renderScale);
+        program->setUniformValue(uniforms.viewportSize, QSizeF(m_viewportSize));
+        drawShape(mesh, level);
+    };
+    m_renderQueue->submit(item);
+}
+
+void OpenGL3DRenderer::updateColormapTexture() {
+    // 8-bit RGBA lookup table, linearly filtered between entries
+    QVector<QVector3D> colors =
+        Colormap::sample(Colormap::Name(qBound(0, m_heatmapColormap, Colormap::NameCount - 1)),
+                         kColormapTexels);
+    QVector<unsigned char> texels;
+    texels.reserve(colors.size() * 4);
+    for (const QVector3D& color : colors) {
+        texels.append(static_cast<unsigned char>(qRound(qBound(0.0f, color.x(), 1.0f) * 255)));
+        texels.append(static_cast<unsigned char>(qRound(qBound(0.0f, color.y(), 1.0f) * 255)));
+        texels.append(static_cast<unsigned char>(qRound(qBound(0.0f, color.z(), 1.0f) * 255)));
+        texels.append(255);
+    }
+
+    if (!m_colormapTexture) {
+        glGenTextures(1, &m_colormapTexture);
+    }
+    m_glState->bindTexture(0, m_colormapTexture);
+    glTexImage2D(GL_TEXTURE_2D, 0, GL_RGBA8, kColormapTexels, 1, 0, GL_RGBA, GL_UNSIGNED_BYTE,
+                 texels.constData());
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+
+    m_colormapTextureName = m_heatmapColormap;
+}
+
+void OpenGL3DRenderer::updateModelMesh() {
+    m_modelMesh.reset();
+    // Uploaded by the first renderer of the context group that gets the model
+    if (m_modelData) {
+        m_modelMesh = GpuResourceCache::modelMesh(m_modelData);
+    } else if (m_stlModel) {
+        m_modelMesh = GpuResourceCache::modelMesh(m_stlModel);
+    } else if (m_cachedModel) {
+        m_modelMesh = GpuResourceCache::modelMesh(m_cachedModel);
+    } else {
+        return;
+    }
+    if (!m_modelMesh) {
+        qDebug() << "WARNING: Loaded model could not be uploaded";
+        return;
+    }
 
-    m_program->release();
+    if (!m_modelVao) {
+        m_modelVao = new QOpenGLVertexArrayObject();
+        if (!m_modelVao->create()) {
+            qDebug() << "ERROR: Failed to create model VAO";
+            m_modelMesh.reset();
+            return;
+        }
+    }
+    m_glState->bindVertexArray(m_modelVao);
+    m_modelMesh->setupVertexAttributes();
 }
 
-void OpenGL3DRenderer::bindAndRenderGeometry() {
-    // Bind vertex data
-    m_vertexBuffer->bind();
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), 0);
+QOpenGLVertexArrayObject* OpenGL3DRenderer::shapeVertexArray() const {
+    if (m_currentShape == OpenGL3DViewport::MODEL && m_modelMesh) {
+        return m_modelVao;
+    }
+    return m_geometryVao;
+}
 
-    // Bind normal data if available
-    if (m_normalBuffer && !m_normals.isEmpty()) {
-        m_normalBuffer->bind();
-        glEnableVertexAttribArray(1);
-        glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), 0);
+void OpenGL3DRenderer::drawShape(int mesh, int level) {
+    // The loaded model has a single level; the atlas mesh stands in until one is uploaded
+    if (m_currentShape == OpenGL3DViewport::MODEL && m_modelMesh) {
+        m_modelMesh->draw();
+    } else {
+        m_geometryAtlas->draw(GeometryAtlas::Mesh(mesh), level);
     }
+}
 
-    // Render indexed geometry
-    m_indexBuffer->bind();
-    glDrawElements(GL_TRIANGLES, m_indices.size(), GL_UNSIGNED_INT, 0);
+void OpenGL3DRenderer::bindAndRenderGeometry(int level) {
+    // Draw the current shape's range of the shared atlas buffers, or the loaded model
+    m_glState->bindVertexArray(shapeVertexArray());
+    drawShape(GeometryAtlas::meshForShape(m_currentShape), level);
+    m_glState->countDrawCall();
+}
 
-    // Cleanup vertex attributes
-    glDisableVertexAttribArray(0);
-    if (m_normalBuffer && !m_normals.isEmpty()) {
-        glDisableVertexAttribArray(1);
-        m_normalBuffer->release();
-    }
+int OpenGL3DRenderer::selectLod(LodSlot slot, int mesh, float screenRadius) {
+    // Each slot keeps its own level so hysteresis applies per drawn group
+    m_lodLevels[slot] = m_geometryAtlas->selectLevel(GeometryAtlas::Mesh(mesh), screenRadius,
+                                                     m_lodLevels[slot]);
+    return m_lodLevels[slot];
+}
 
-    m_indexBuffer->release();
-    m_vertexBuffer->release();
+float OpenGL3DRenderer::projectedRadius(const QVector3D& worldCenter, float worldRadius) const {
+    // Approximate on-screen radius in pixels of a sphere under the current perspective
+    float depth = qMax(-m_viewMatrix.map(worldCenter).z(), 0.1f);
+    return worldRadius * m_projectionMatrix(1, 1) * 0.5f * m_viewportSize.height() / depth;
 }
 
 QVector3D OpenGL3DRenderer::getShapeColor(int shapeType) const {
@@ -366,6 +1532,8 @@ QVector3D OpenGL3DRenderer::getShapeColor(int shapeType) const {
             return QVector3D(0.3f, 1.0f, 0.3f);  // Bright green torus
         case 4:
             return QVector3D(1.0f, 0.3f, 1.0f);  // Bright magenta tetrahedron
+        case OpenGL3DViewport::MODEL:
+            return QVector3D(1.0f, 0.65f, 0.2f);  // Bright orange loaded model
         default:
             return QVector3D(0.8f, 0.8f, 0.8f);  // Gray fallback
     }
@@ -373,26 +1541,40 @@ QVector3D OpenGL3DRenderer::getShapeColor(int shapeType) const {
 
 void OpenGL3DRenderer::renderVertexLabels() {
     // Render sphere markers at vertices for alignment feedback
-    if (!m_showVertexLabels) {
+    m_markerBatches[0] = MarkerBatch();
+    m_markerBatches[1] = MarkerBatch();
+    m_labelCount = 0;
+    if (!m_showVertexLabels || !m_markerProgram || !m_markerVao) {
         return;
     }
 
-    // Get base vertex positions for current shape
-    QVector<QVector3D> baseVertices = getShapeVertices(m_currentShape);
+    // Get base vertex positions for current shape (or the benchmark marker load)
+    QVector<QVector3D> baseVertices =
+        m_syntheticMarkers.isEmpty() ? getShapeVertices(m_currentShape) : m_syntheticMarkers;
+    m_markerInstances.clear();
+    m_labelInstances.clear();
 
-    // Render reference model vertex markers (large bright white spheres)
+    // Reference model vertex markers (large bright white spheres, 1', 2', 3', 4')
+    int referenceCount = 0;
+    int referenceLevel = 0;
     if (m_showReferenceModel) {
-        QMatrix4x4 referenceMatrix;
-        referenceMatrix.rotate(QQuaternion::fromEulerAngles(15.0f, 25.0f, 0.0f));
+        const QMatrix4x4 referenceMatrix = referenceModelMatrix();
 
-        for (int i = 0; i < baseVertices.size(); ++i) {
-            QVector3D refPos = (referenceMatrix * QVector4D(baseVertices[i], 1.0f)).toVector3D();
-            QVector3D whiteColor(1.0f, 1.0f, 1.0f);         // Bright white for reference
-            renderVertexMarker(refPos, whiteColor, 0.15f);  // Large markers (1', 2', 3', 4')
+        QVector<QVector3D> refPositions;
+        refPositions.reserve(baseVertices.size());
+        for (const QVector3D& vertex : baseVertices) {
+            refPositions.append((referenceMatrix * QVector4D(vertex, 1.0f)).toVector3D());
         }
+        float screenRadius =
+            appendMarkerInstances(refPositions, QVector3D(1.0f, 1.0f, 1.0f), 0.15f);
+        referenceLevel = selectLod(ReferenceMarkerLod, GeometryAtlas::MarkerSphere, screenRadius);
+        referenceCount = refPositions.size();
+        appendLabelInstances(refPositions, QVector3D(1.0f, 1.0f, 1.0f), true);
     }
 
-    // Render movable model vertex markers (colored spheres)
+    // Movable model vertex markers (medium colored spheres, 1, 2, 3, 4)
+    int movableCount = 0;
+    int movableLevel = 0;
     if (m_showMovableModel) {
         QMatrix4x4 movableMatrix;
 
@@ -402,410 +1584,204 @@ void OpenGL3DRenderer::renderVertexLabels() {
         movableMatrix.rotate(m_rotation);
         movableMatrix.scale(m_scale);
 
-        QVector3D markerColor = getShapeColor(m_currentShape);
-
-        for (int i = 0; i < baseVertices.size(); ++i) {
-            QVector3D movPos = (movableMatrix * QVector4D(baseVertices[i], 1.0f)).toVector3D();
-            renderVertexMarker(movPos, markerColor, 0.12f);  // Medium markers (1, 2, 3, 4)
+        QVector<QVector3D> movPositions;
+        movPositions.reserve(baseVertices.size());
+        for (const QVector3D& vertex : baseVertices) {
+            movPositions.append((movableMatrix * QVector4D(vertex, 1.0f)).toVector3D());
         }
+        float screenRadius =
+            appendMarkerInstances(movPositions, getShapeColor(m_currentShape), 0.12f);
+        movableLevel = selectLod(MovableMarkerLod, GeometryAtlas::MarkerSphere, screenRadius);
+        movableCount = movPositions.size();
+        appendLabelInstances(movPositions, getShapeColor(m_currentShape), false);
     }
-}
-
-QVector<QVector3D> OpenGL3DRenderer::getShapeVertices(int shapeType) const {
-    // Return vertex positions for different shape types
-    switch (shapeType) {
-        case 1:  // Cube - 8 corners
-            return {QVector3D(-1.0f, -1.0f, -1.0f), QVector3D(1.0f, -1.0f, -1.0f),
-                    QVector3D(1.0f, 1.0f, -1.0f),   QVector3D(-1.0f, 1.0f, -1.0f),
-                    QVector3D(-1.0f, -1.0f, 1.0f),  QVector3D(1.0f, -1.0f, 1.0f),
-                    QVector3D(1.0f, 1.0f, 1.0f),    QVector3D(-1.0f, 1.0f, 1.0f)};
-
-        case 4:  // Tetrahedron - 4 corners
-        default:
-            return {
-                QVector3D(0.0f, 1.2f, 0.0f),    // apex
-                QVector3D(-1.0f, -0.4f, 1.0f),  // base front-left
-                QVector3D(1.0f, -0.4f, 1.0f),   // base front-right
-                QVector3D(0.0f, -0.4f, -1.4f)   // base back
-            };
-    }
-}
 
-void OpenGL3DRenderer::renderVertexMarker(const QVector3D& position, const QVector3D& color,
-                                          float scale) {
-    // Render a single sphere marker at specified position
-    if (!m_program || !m_sphereVertexBuffer || !m_sphereIndexBuffer) {
+    if (m_markerInstances.isEmpty()) {
         return;
     }
 
-    m_program->bind();
-
-    // Create marker transformation matrix
-    QMatrix4x4 markerMatrix;
-    markerMatrix.translate(position);
-    markerMatrix.scale(scale);
-
-    // Calculate matrices
-    QMatrix4x4 mvpMatrix = m_projectionMatrix * m_viewMatrix * markerMatrix;
-    QMatrix3x3 normalMatrix = markerMatrix.normalMatrix();
-
-    // Set shader uniforms
-    m_program->setUniformValue("mvpMatrix", mvpMatrix);
-    m_program->setUniformValue("modelMatrix", markerMatrix);
-    m_program->setUniformValue("normalMatrix", normalMatrix);
-    m_program->setUniformValue("lightPos", QVector3D(5.0f, 5.0f, 5.0f));
-    m_program->setUniformValue("viewPos", QVector3D(4.0f, 3.0f, 6.0f));
-    m_program->setUniformValue("color", color);
-    m_program->setUniformValue("alpha", 1.0f);  // Solid markers
-
-    // Bind sphere geometry
-    m_sphereVertexBuffer->bind();
-    glEnableVertexAttribArray(0);
-    glVertexAttribPointer(0, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), 0);
-
-    m_sphereNormalBuffer->bind();
-    glEnableVertexAttribArray(1);
-    glVertexAttribPointer(1, 3, GL_FLOAT, GL_FALSE, 3 * sizeof(float), 0);
-
-    // Render sphere marker
-    m_sphereIndexBuffer->bind();
-    glDrawElements(GL_TRIANGLES, m_sphereIndices.size(), GL_UNSIGNED_INT, 0);
-
-    // Cleanup
-    glDisableVertexAttribArray(0);
-    glDisableVertexAttribArray(1);
-    m_sphereIndexBuffer->release();
-    m_sphereNormalBuffer->release();
-    m_sphereVertexBuffer->release();
-    m_program->release();
-}
-
-// ===================================================================
-// GEOMETRY GENERATION METHODS
-// ===================================================================
+    // Upload all instances of both models at once (orphans the previous contents)
+    m_markerInstanceBuffer->bind();
+    m_markerInstanceBuffer->allocate(m_markerInstances.constData(),
+                                     m_markerInstances.size() * sizeof(float));
+    m_markerInstanceBuffer->release();
 
-void OpenGL3DRenderer::generateGeometry() {
-    // Clear existing geometry data
-    m_vertices.clear();
-    m_normals.clear();
-    m_indices.clear();
-
-    // Generate geometry based on current shape type
-    switch (m_currentShape) {
-        case 1:
-            generateCubeGeometry();
-            break;
-        case 2:
-            generateSphereGeometry();
-            break;
-        case 3:
-            generateTorusGeometry();
-            break;
-        case 4:
-            generateTetrahedronGeometry();
-            break;
-        default:
-            generateTetrahedronGeometry();
-            break;
+    // Label glyphs of both models, drawn later by renderLabelText()
+    if (!m_labelInstances.isEmpty()) {
+        m_labelInstanceBuffer->bind();
+        m_labelInstanceBuffer->allocate(m_labelInstances.constData(),
+                                        m_labelInstances.size() * sizeof(float));
+        m_labelInstanceBuffer->release();
+        m_labelCount = m_labelInstances.size() / kFloatsPerLabelInstance;
     }
 
-    // Update OpenGL buffers with new geometry
-    updateBuffers();
-
-    qDebug() << "Generated geometry for shape" << m_currentShape
-             << "- Vertices:" << m_vertices.size() / 3 << "Triangles:" << m_indices.size() / 3;
-}
-
-void OpenGL3DRenderer::generateCubeGeometry() {
-    // Generate cube with unique vertices per face for proper lighting
-    m_vertices = {// Front face (z = 1.0)
-                  -1.0f, -1.0f, 1.0f, 1.0f, -1.0f, 1.0f, 1.0f, 1.0f, 1.0f, -1.0f, 1.0f, 1.0f,
-                  // Back face (z = -1.0)
-                  -1.0f, -1.0f, -1.0f, -1.0f, 1.0f, -1.0f, 1.0f, 1.0f, -1.0f, 1.0f, -1.0f, -1.0f,
-                  // Top face (y = 1.0)
-                  -1.0f, 1.0f, -1.0f, -1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, 1.0f, -1.0f,
-                  // Bottom face (y = -1.0)
-                  -1.0f, -1.0f, -1.0f, 1.0f, -1.0f, -1.0f, 1.0f, -1.0f, 1.0f, -1.0f, -1.0f, 1.0f,
-                  // Right face (x = 1.0)
-                  1.0f, -1.0f, -1.0f, 1.0f, 1.0f, -1.0f, 1.0f, 1.0f, 1.0f, 1.0f, -1.0f, 1.0f,
-                  // Left face (x = -1.0)
-                  -1.0f, -1.0f, -1.0f, -1.0f, -1.0f, 1.0f, -1.0f, 1.0f, 1.0f, -1.0f, 1.0f, -1.0f};
-
-    // Face normals for proper lighting
-    m_normals = {// Front face normals (z+)
-                 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f,
-                 // Back face normals (z-)
-                 0.0f, 0.0f, -1.0f, 0.0f, 0.0f, -1.0f, 0.0f, 0.0f, -1.0f, 0.0f, 0.0f, -1.0f,
-                 // Top face normals (y+)
-                 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f,
-                 // Bottom face normals (y-)
-                 0.0f, -1.0f, 0.0f, 0.0f, -1.0f, 0.0f, 0.0f, -1.0f, 0.0f, 0.0f, -1.0f, 0.0f,
-                 // Right face normals (x+)
-                 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f, 1.0f, 0.0f, 0.0f,
-                 // Left face normals (x-)
-                 -1.0f, 0.0f, 0.0f, -1.0f, 0.0f, 0.0f, -1.0f, 0.0f, 0.0f, -1.0f, 0.0f, 0.0f};
-
-    // Triangle indices for each face (2 triangles per face)
-    m_indices = {
-        0,  1,  2,  2,  3,  0,   // Front face
-        4,  5,  6,  6,  7,  4,   // Back face
-        8,  9,  10, 10, 11, 8,   // Top face
-        12, 13, 14, 14, 15, 12,  // Bottom face
-        16, 17, 18, 18, 19, 16,  // Right face
-        20, 21, 22, 22, 23, 20   // Left face
-    };
+    m_markerBatches[0] = {0, referenceCount, referenceLevel};
+    m_markerBatches[1] = {referenceCount, movableCount, movableLevel};
+    drawMarkerBatches();
 }
 
-void OpenGL3DRenderer::generateSphereGeometry() {
-    // Generate sphere using latitude/longitude method
-    const int stacks = 12;  // Horizontal divisions
-    const int slices = 16;  // Vertical divisions
-    const float radius = 1.0f;
-
-    // Generate vertices and normals
-    for (int i = 0; i <= stacks; ++i) {
-        float phi = M_PI * float(i) / float(stacks);  // 0 to PI
-        float cosPhi = cos(phi);
-        float sinPhi = sin(phi);
-
-        for (int j = 0; j <= slices; ++j) {
-            float theta = 2.0f * M_PI * float(j) / float(slices);  // 0 to 2*PI
-            float cosTheta = cos(theta);
-            float sinTheta = sin(theta);
-
-            // Calculate vertex position
-            float x = radius * sinPhi * cosTheta;
-            float y = radius * cosPhi;
-            float z = radius * sinPhi * sinTheta;
-
-            // Add vertex
-            m_vertices.append(x);
-            m_vertices.append(y);
-            m_vertices.append(z);
-
-            // For sphere, normal equals normalized position
-            m_normals.append(x / radius);
-            m_normals.append(y / radius);
-            m_normals.append(z / radius);
-        }
+void OpenGL3DRenderer::drawMarkerBatches() {
+    // Submits the instances uploaded by the last renderVertexLabels() call
+    if (!m_markerProgram || !m_markerVao) {
+        return;
     }
 
-    // Generate triangle indices
-    for (int i = 0; i < stacks; ++i) {
-        for (int j = 0; j < slices; ++j) {
-            int first = i * (slices + 1) + j;
-            int second = first + slices + 1;
-
-            // Two triangles per quad
-            m_indices.append(first);
-            m_indices.append(second);
-            m_indices.append(first + 1);
-
-            m_indices.append(second);
-            m_indices.append(second + 1);
-            m_indices.append(first + 1);
+    // One instanced draw call per model, tessellated for its closest marker
+    for (const MarkerBatch& batch : m_markerBatches) {
+        if (batch.instanceCount == 0) {
+            continue;
         }
+
+        RenderQueue::DrawItem item;
+        item.layer = MarkerDraws;
+        item.program = m_markerProgram;
+        item.vertexArray = m_markerVao;
+        item.state = m_drawState;
+        item.draw = [this, batch]() {
+            m_markerProgram->setUniformValue(m_markerUniforms.alpha, 1.0f);  // Solid markers
+            renderMarkerInstances(batch.firstInstance, batch.instanceCount, batch.level);
+        };
+        m_renderQueue->submit(item);
     }
 }
 
-void OpenGL3DRenderer::generateTorusGeometry() {
-    // Generate torus geometry
-    const int majorSegments = 16;  // Around major radius
-    const int minorSegments = 12;  // Around minor radius
-    const float majorRadius = 1.0f;
-    const float minorRadius = 0.4f;
-
-    // Generate vertices and normals
-    for (int i = 0; i <= majorSegments; ++i) {
-        float u = 2.0f * M_PI * float(i) / float(majorSegments);
-        float cosU = cos(u);
-        float sinU = sin(u);
-
-        for (int j = 0; j <= minorSegments; ++j) {
-            float v = 2.0f * M_PI * float(j) / float(minorSegments);
-            float cosV = cos(v);
-            float sinV = sin(v);
-
-            // Calculate vertex position
-            float x = (majorRadius + minorRadius * cosV) * cosU;
-            float y = minorRadius * sinV;
-            float z = (majorRadius + minorRadius * cosV) * sinU;
-
-            // Add vertex
-            m_vertices.append(x);
-            m_vertices.append(y);
-            m_vertices.append(z);
+void OpenGL3DRenderer::flushDraws() {
+    // Issues the current pass, inside its profiler bracket
+    m_renderQueue->flush(*m_glState);
+}
 
-            // Calculate normal
-            float nx = cosV * cosU;
-            float ny = sinV;
-            float nz = cosV * sinU;
+float OpenGL3DRenderer::appendMarkerInstances(const QVector<QVector3D>& positions,
+                                              const QVector3D& color, float scale) {
+    // Returns the largest projected marker radius in pixels
+    float maxScreenRadius = 0.0f;
+    for (const QVector3D& position : positions) {
+        maxScreenRadius = qMax(maxScreenRadius, projectedRadius(position, scale));
 
-            m_normals.append(nx);
-            m_normals.append(ny);
-            m_normals.append(nz);
-        }
+        m_markerInstances.append(position.x());
+        m_markerInstances.append(position.y());
+        m_markerInstances.append(position.z());
+        m_markerInstances.append(scale);
+        m_markerInstances.append(color.x());
+        m_markerInstances.append(color.y());
+        m_markerInstances.append(color.z());
     }
+    return maxScreenRadius;
+}
 
-    // Generate triangle indices
-    for (int i = 0; i < majorSegments; ++i) {
-        for (int j = 0; j < minorSegments; ++j) {
-            int first = i * (minorSegments + 1) + j;
-            int second = first + minorSegments + 1;
+void OpenGL3DRenderer::renderMarkerInstances(int firstInstance, int instanceCount, int level) {
+    // Point the per-instance attributes at this model's slice of the instance buffer
+    const int stride = kFloatsPerMarkerInstance * sizeof(float);
+    const size_t offset = size_t(firstInstance) * stride;
 
-            // Two triangles per quad
-            m_indices.append(first);
-            m_indices.append(second);
-            m_indices.append(first + 1);
+    m_markerInstanceBuffer->bind();
+    glVertexAttribPointer(2, 4, GL_FLOAT, GL_FALSE, stride, reinterpret_cast<const void*>(offset));
+    glVertexAttribPointer(3, 3, GL_FLOAT, GL_FALSE, stride,
+                          reinterpret_cast<const void*>(offset + 4 * sizeof(float)));
+    m_markerInstanceBuffer->release();
 
-            m_indices.append(second);
-            m_indices.append(second + 1);
-            m_indices.append(first + 1);
-        }
-    }
+    m_geometryAtlas->drawInstanced(GeometryAtlas::MarkerSphere, instanceCount, level);
 }
 
-void OpenGL3DRenderer::generateTetrahedronGeometry() {
-    // Regular tetrahedron vertices
-    m_vertices = {
-        0.0f,  1.2f,  0.0f,  // apex
-        -1.0f, -0.4f, 1.0f,  // base front-left
-        1.0f,  -0.4f, 1.0f,  // base front-right
-        0.0f,  -0.4f, -1.4f  // base back
-    };
+void OpenGL3DRenderer::appendLabelInstances(const QVector<QVector3D>& positions,
+                                            const QVector3D& color, bool primed) {
+    // Numbered from 1 in vertex order; reference labels are primed (1', 2', ...)
+    if (!m_labelVao) {
+        return;
+    }
 
-    // Calculate face normals for tetrahedron
-    m_normals = {0.0f,  1.0f,  0.0f,  // apex normal
-                 -0.5f, -0.5f, 0.5f,  // base vertex normals (approximated)
-                 0.5f,  -0.5f, 0.5f, 0.0f, -0.5f, -0.7f};
-
-    // Triangle indices (4 triangular faces)
-    m_indices = {
-        0, 1, 2,  // front face
-        0, 2, 3,  // right face
-        0, 3, 1,  // left face
-        1, 3, 2   // base face
-    };
-}
+    for (int i = 0; i < positions.size(); ++i) {
+        QString text = QString::number(i + 1);
+        if (primed) {
+            text += QLatin1Char('\'');
+        }
 
-void OpenGL3DRenderer::generateSphereMarkerGeometry() {
-    // Generate low-resolution sphere for vertex markers
-    const int stacks = 8;  // Fewer divisions for performance
-    const int slices = 12;
-    const float radius = 1.0f;
-
-    m_sphereVertices.clear();
-    m_sphereNormals.clear();
-    m_sphereIndices.clear();
-
-    // Generate vertices and normals
-    for (int i = 0; i <= stacks; ++i) {
-        float phi = M_PI * float(i) / float(stacks);
-        float cosPhi = cos(phi);
-        float sinPhi = sin(phi);
-
-        for (int j = 0; j <= slices; ++j) {
-            float theta = 2.0f * M_PI * float(j) / float(slices);
-            float cosTheta = cos(theta);
-            float sinTheta = sin(theta);
-
-            // Calculate vertex position
-            float x = radius * sinPhi * cosTheta;
-            float y = radius * cosPhi;
-            float z = radius * sinPhi * sinTheta;
-
-            m_sphereVertices.append(x);
-            m_sphereVertices.append(y);
-            m_sphereVertices.append(z);
-
-            // Normal equals position for unit sphere
-            m_sphereNormals.append(x);
-            m_sphereNormals.append(y);
-            m_sphereNormals.append(z);
+        float pen = 0.0f;
+        for (QChar character : text) {
+            int glyph = GlyphAtlas::glyphIndex(character);
+            m_labelInstances.append(positions[i].x());
+            m_labelInstances.append(positions[i].y());
+            m_labelInstances.append(positions[i].z());
+            m_labelInstances.append(pen);
+            m_labelInstances.append(color.x());
+            m_labelInstances.append(color.y());
+            m_labelInstances.append(color.z());
+            m_labelInstances.append(float(glyph));
+            pen += m_glyphAtlas->advance(glyph);
         }
     }
+}
 
-    // Generate triangle indices
-    for (int i = 0; i < stacks; ++i) {
-        for (int j = 0; j < slices; ++j) {
-            int first = i * (slices + 1) + j;
-            int second = first + slices + 1;
-
-            m_sphereIndices.append(first);
-            m_sphereIndices.append(second);
-            m_sphereIndices.append(first + 1);
-
-            m_sphereIndices.append(second);
-            m_sphereIndices.append(second + 1);
-            m_sphereIndices.append(first + 1);
-        }
+void OpenGL3DRenderer::renderLabelText() {
+    // Submits every glyph uploaded by the last renderVertexLabels() call as one draw
+    if (!m_labelVao || m_labelCount == 0) {
+        return;
     }
 
-    // Create sphere marker OpenGL buffers
-    createSphereBuffers();
+    // Fixed size in item pixels, whatever the model scale or distance
+    const float height = kLabelHeight * m_renderScale;
+    const QSizeF glyphSize(height * m_glyphAtlas->cellAspect(), height);
+    const QPointF labelOffset = kLabelOffset * m_renderScale;
+    const int glyphCount = m_labelCount;
+
+    // On top of both models, so a label stays readable behind the other model
+    DrawState state;
+    state.blending = DrawState::AlphaBlend;
+    state.depthTest = false;
+    state.depthWrite = false;
+
+    RenderQueue::DrawItem item;
+    item.layer = LabelDraws;
+    item.program = m_labelProgram;
+    item.vertexArray = m_labelVao;
+    item.state = state;
+    item.draw = [this, glyphSize, labelOffset, glyphCount]() {
+        m_labelProgram->setUniformValue(m_labelUniforms.viewportSize, QSizeF(m_viewportSize));
+        m_labelProgram->setUniformValue(m_labelUniforms.glyphSize, glyphSize);
+        m_labelProgram->setUniformValue(m_labelUniforms.labelOffset, labelOffset);
+        m_glState->bindTexture(0, m_glyphAtlas->texture());
+        glDrawArraysInstanced(GL_TRIANGLE_STRIP, 0, 4, glyphCount);
+    };
+    m_renderQueue->submit(item);
 }
 
-void OpenGL3DRenderer::createSphereBuffers() {
-    // Create vertex buffer for sphere markers
-    if (!m_sphereVertexBuffer) {
-        m_sphereVertexBuffer = new QOpenGLBuffer(QOpenGLBuffer::VertexBuffer);
-        m_sphereVertexBuffer->create();
-    }
-    m_sphereVertexBuffer->bind();
-    m_sphereVertexBuffer->allocate(m_sphereVertices.constData(),
-                                   m_sphereVertices.size() * sizeof(float));
-    m_sphereVertexBuffer->release();
+QVector<QVector3D> OpenGL3DRenderer::getShapeVertices(int shapeType) const {
+    // Return vertex positions for different shape types
+    switch (shapeType) {
+        case 1:  // Cube - 8 corners
+            return {QVector3D(-1.0f, -1.0f, -1.0f), QVector3D(1.0f, -1.0f, -1.0f),
+                    QVector3D(1.0f, 1.0f, -1.0f),   QVector3D(-1.0f, 1.0f, -1.0f),
+                    QVector3D(-1.0f, -1.0f, 1.0f),  QVector3D(1.0f, -1.0f, 1.0f),
+                    QVector3D(1.0f, 1.0f, 1.0f),    QVector3D(-1.0f, 1.0f, 1.0f)};
 
-    // Create normal buffer for sphere markers
-    if (!m_sphereNormalBuffer) {
-        m_sphereNormalBuffer = new QOpenGLBuffer(QOpenGLBuffer::VertexBuffer);
-        m_sphereNormalBuffer->create();
-    }
-    m_sphereNormalBuffer->bind();
-    m_sphereNormalBuffer->allocate(m_sphereNormals.constData(),
-                                   m_sphereNormals.size() * sizeof(float));
-    m_sphereNormalBuffer->release();
+        case OpenGL3DViewport::MODEL:  // Loaded models carry no landmarks
+            return {};
 
-    // Create index buffer for sphere markers
-    if (!m_sphereIndexBuffer) {
-        m_sphereIndexBuffer = new QOpenGLBuffer(QOpenGLBuffer::IndexBuffer);
-        m_sphereIndexBuffer->create();
+        case 4:  // Tetrahedron - 4 corners
+        default:
+            return {
+                QVector3D(0.0f, 1.2f, 0.0f),    // apex
+                QVector3D(-1.0f, -0.4f, 1.0f),  // base front-left
+                QVector3D(1.0f, -0.4f, 1.0f),   // base front-right
+                QVector3D(0.0f, -0.4f, -1.4f)   // base back
+            };
     }
-    m_sphereIndexBuffer->bind();
-    m_sphereIndexBuffer->allocate(m_sphereIndices.constData(),
-                                  m_sphereIndices.size() * sizeof(unsigned int));
-    m_sphereIndexBuffer->release();
 }
 
-void OpenGL3DRenderer::updateBuffers() {
-    // Create or update vertex buffer
-    if (!m_vertexBuffer) {
-        m_vertexBuffer = new QOpenGLBuffer(QOpenGLBuffer::VertexBuffer);
-        m_vertexBuffer->create();
-    }
-    m_vertexBuffer->bind();
-    m_vertexBuffer->allocate(m_vertices.constData(), m_vertices.size() * sizeof(float));
-    m_vertexBuffer->release();
-
-    // Create or update normal buffer
-    if (!m_normals.isEmpty()) {
-        if (!m_normalBuffer) {
-            m_normalBuffer = new QOpenGLBuffer(QOpenGLBuffer::VertexBuffer);
-            m_normalBuffer->create();
-        }
-        m_normalBuffer->bind();
-        m_normalBuffer->allocate(m_normals.constData(), m_normals.size() * sizeof(float));
-        m_normalBuffer->release();
-    }
+QVector<QVector3D> OpenGL3DRenderer::syntheticMarkerPositions(int count) {
+    // Evenly spread points on a sphere enclosing the shapes (Fibonacci lattice)
+    const float goldenAngle = M_PI * (3.0f - qSqrt(5.0f));
+    const float radius = 1.2f;
 
-    // Create or update index buffer
-    if (!m_indexBuffer) {
-        m_indexBuffer = new QOpenGLBuffer(QOpenGLBuffer::IndexBuffer);
-        m_indexBuffer->create();
+    QVector<QVector3D> positions;
+    positions.reserve(count);
+    for (int i = 0; i < count; ++i) {
+        float y = count > 1 ? 1.0f - 2.0f * float(i) / float(count - 1) : 0.0f;
+        float ringRadius = qSqrt(qMax(0.0f, 1.0f - y * y));
+        float theta = goldenAngle * i;
+        positions.append(radius *
+                         QVector3D(ringRadius * qCos(theta), y, ringRadius * qSin(theta)));
     }
-    m_indexBuffer->bind();
-    m_indexBuffer->allocate(m_indices.constData(), m_indices.size() * sizeof(unsigned int));
-    m_indexBuffer->release();
+    return positions;
 }
 
 // Legacy method for compatibility
@@ -825,6 +1801,15 @@ OpenGL3DViewport::OpenGL3DViewport(QQuickItem* parent)
       m_translation(0.0f, 0.0f, 0.0f),  // Start at origin
       m_rotation(15.0f, 25.0f, 0.0f),   // Initial 3D viewing angle
       m_scale(1.0f),                    // Unity scale
+      m_adaptiveResolution(false),      // Full resolution until enabled
+      m_sampleCount(4),                 // 4x MSAA
+      m_activeSampleCount(0),           // Reported by the renderer
+      m_capturing(false),               // No recording
+      m_captureSession(0),
+      m_capturedFrames(0),
+      m_droppedCaptureFrames(0),
+      m_recordTasks(false),
+      m_continuousBeforeCapture(false),
       m_mousePressed(false),            // No mouse input initially
       m_activeButton(Qt::NoButton),     // No active button
       m_rotationSensitivity(0.5f),      // Default rotation sensitivity
@@ -833,8 +1818,17 @@ OpenGL3DViewport::OpenGL3DViewport(QQuickItem* parent)
       m_showReferenceModel(true),       // Show reference model
       m_showMovableModel(true),         // Show movable model
       m_showVertexLabels(true),         // Show vertex markers
+      m_edgeWidth(4.0f),                // Movable model edge width in pixels
+      m_orderIndependentTransparency(true),
+      m_alignmentHeatmap(false),        // Plain shape colors
+      m_heatmapColormap(VIRIDIS),
+      m_heatmapRange(0.5f),             // Error shown at the top of the colormap
       m_alignmentAccuracy(0.0f),        // Initial alignment accuracy
+      m_silhouetteOverlap(-1.0f),       // Reported by the renderer
       m_taskActive(false),              // NEW
+      m_modelLoading(false),            // No model loaded
+      m_modelLoadProgress(0.0),
+      m_weldModelVertices(false),       // Flat shaded STL straight from the file
       m_interactionMode("Mouse"),       // SpaceMouse integration
       m_spaceMouseEnabled(false),
       m_spaceMouseManager(nullptr),
@@ -855,18 +1849,31 @@ OpenGL3DViewport::OpenGL3DViewport(QQuickItem* parent)
     setFlag(QQuickItem::ItemIsFocusScope, true);
     setFocus(true);
 
-    // Setup animation timer for continuous rendering
-    m_animationTimer = new QTimer(this);
-    connect(m_animationTimer, &QTimer::timeout, this, &OpenGL3DViewport::updateAnimation);
-    m_animationTimer->start(33);  // ~30 FPS
+    // Render on demand: state changes are coalesced into the next vsync-aligned frame
+    m_renderScheduler = new RenderScheduler(this);
+    m_renderStates.reset(new TripleBuffer<RenderState>());
+    publishRenderState();
+
+    // Adaptive quality never exceeds the configured MSAA
+    m_qualityController.setMaxSampleCount(m_sampleCount);
 
     // Connect transform changes to alignment calculation for research
     connect(this, &OpenGL3DViewport::transformChanged, this,
             &OpenGL3DViewport::calculateAlignmentAccuracy);
+    connect(this, &OpenGL3DViewport::taskStateChanged, this,
+            &OpenGL3DViewport::onTaskStateChanged);
+    connect(&m_modelLoadWatcher, &QFutureWatcherBase::finished, this,
+            &OpenGL3DViewport::onModelLoadFinished);
     initializeSpaceMouse();
     qDebug() << "OpenGL3DViewport created - Ready for dual model research";
 }
 
+OpenGL3DViewport::~OpenGL3DViewport() {
+    // Loader threads post progress to this object, so they must be done before it goes
+    m_modelLoadCancelled.storeRelaxed(1);
+    m_modelLoadWatcher.waitForFinished();
+}
+
 QQuickFramebufferObject::Renderer* OpenGL3DViewport::createRenderer() const {
     return new OpenGL3DRenderer();
 }
@@ -879,7 +1886,7 @@ void OpenGL3DViewport::setCurrentShape(int shape) {
     if (m_currentShape != shape) {
         m_currentShape = shape;
         emit currentShapeChanged();
-        update();  // Trigger re-render
+        publishRenderState();
         qDebug() << "Shape changed to:" << shape;
     }
 }
@@ -888,7 +1895,7 @@ void OpenGL3DViewport::setTranslation(const QVector3D& translation) {
     if (m_translation != translation) {
         m_translation = translation;
         emit transformChanged();
-        update();
+        publishRenderState();
     }
 }
 
@@ -896,7 +1903,7 @@ void OpenGL3DViewport::setRotation(const QVector3D& rotation) {
     if (m_rotation != rotation) {
         m_rotation = rotation;
         emit transformChanged();
-        update();
+        publishRenderState();
     }
 }
 
@@ -904,7 +1911,7 @@ void OpenGL3DViewport::setScale(float scale) {
     if (qAbs(m_scale - scale) > 0.001f) {
         m_scale = scale;
         emit transformChanged();
-        update();
+        publishRenderState();
     }
 }
 
@@ -935,6 +1942,28 @@ void OpenGL3DViewport::setScaleSensitivity(float sensitivity) {
     }
 }
 
+void OpenGL3DViewport::publishRenderState() {
+    RenderState& state = m_renderStates->writeBuffer();
+    state.shape = m_currentShape;
+    state.translation = m_translation;
+    state.rotation = QQuaternion::fromEulerAngles(m_rotation.x(), m_rotation.y(), m_rotation.z());
+    state.scale = m_scale;
+    state.showReferenceModel = m_showReferenceModel;
+    state.showMovableModel = m_showMovableModel;
+    state.showVertexLabels = m_showVertexLabels;
+    state.edgeWidth = m_edgeWidth;
+    state.orderIndependentTransparency = m_orderIndependentTransparency;
+    state.alignmentHeatmap = m_alignmentHeatmap;
+    state.heatmapColormap = m_heatmapColormap;
+    state.heatmapRange = m_heatmapRange;
+    state.model = m_model;
+    state.stlModel = m_stlModel;
+    state.cachedModel = m_cachedModel;
+    m_renderStates->publish();
+
+    m_renderScheduler->requestFrame();
+}
+
 // ===================================================================
 // RESEARCH-SPECIFIC METHODS
 // ===================================================================
@@ -943,7 +1972,7 @@ void OpenGL3DViewport::setShowReferenceModel(bool show) {
     if (m_showReferenceModel != show) {
         m_showReferenceModel = show;
         emit displayChanged();
-        update();
+        publishRenderState();
         qDebug() << "Reference model visibility:" << show;
     }
 }
@@ -952,16 +1981,61 @@ void OpenGL3DViewport::setShowMovableModel(bool show) {
     if (m_showMovableModel != show) {
         m_showMovableModel = show;
         emit displayChanged();
-        update();
+        publishRenderState();
         qDebug() << "Movable model visibility:" << show;
     }
 }
 
+void OpenGL3DViewport::setEdgeWidth(float width) {
+    width = qBound(0.0f, width, 16.0f);
+    if (!qFuzzyCompare(m_edgeWidth, width)) {
+        m_edgeWidth = width;
+        emit displayChanged();
+        publishRenderState();
+    }
+}
+
+void OpenGL3DViewport::setOrderIndependentTransparency(bool enabled) {
+    if (m_orderIndependentTransparency != enabled) {
+        m_orderIndependentTransparency = enabled;
+        emit displayChanged();
+        publishRenderState();
+        qDebug() << "Order-independent transparency:" << enabled;
+    }
+}
+
+void OpenGL3DViewport::setAlignmentHeatmap(bool enabled) {
+    if (m_alignmentHeatmap != enabled) {
+        m_alignmentHeatmap = enabled;
+        emit displayChanged();
+        publishRenderState();
+        qDebug() << "Alignment heatmap:" << enabled;
+    }
+}
+
+void OpenGL3DViewport::setHeatmapColormap(int colormap) {
+    colormap = qBound(int(VIRIDIS), colormap, int(TRAFFIC_LIGHT));
+    if (m_heatmapColormap != colormap) {
+        m_heatmapColormap = colormap;
+        emit displayChanged();
+        publishRenderState();
+    }
+}
+
+void OpenGL3DViewport::setHeatmapRange(float range) {
+    range = qBound(0.01f, range, 10.0f);
+    if (!qFuzzyCompare(m_heatmapRange, range)) {
+        m_heatmapRange = range;
+        emit displayChanged();
+        publishRenderState();
+    }
+}
+
 void OpenGL3DViewport::setShowVertexLabels(bool show) {
     if (m_showVertexLabels != show) {
         m_showVertexLabels = show;
         emit displayChanged();
-        update();
+        publishRenderState();
         qDebug() << "Vertex labels visibility:" << show;
     }
 }
@@ -980,8 +2054,7 @@ void OpenGL3DViewport::calculateAlignmentAccuracy() {
     QVector<QVector3D> baseVertices = getBaseVertices();
 
     // Transform vertices using current matrices
-    QMatrix4x4 referenceMatrix;
-    referenceMatrix.rotate(QQuaternion::fromEulerAngles(15.0f, 25.0f, 0.0f));
+    const QMatrix4x4 referenceMatrix = referenceModelMatrix();
 
     QMatrix4x4 movableMatrix;
     movableMatrix.translate(m_translation);
@@ -1028,6 +2101,9 @@ QVector<QVector3D> OpenGL3DViewport::getBaseVertices() const {
                     QVector3D(-1.0f, -1.0f, 1.0f),  QVector3D(1.0f, -1.0f, 1.0f),
                     QVector3D(1.0f, 1.0f, 1.0f),    QVector3D(-1.0f, 1.0f, 1.0f)};
 
+        case MODEL:  // Loaded model
+            return m_modelCorners;
+
         case 4:  // Tetrahedron
         default:
             return {
@@ -1361,7 +2437,7 @@ void OpenGL3DViewport::keyPressEvent(QKeyEvent* event) {
             }
             break;
 
-        // Shape selection (1-4)
+        // Shape selection (1-4, 5 for the loaded model)
         case Qt::Key_1:
             setCurrentShape(1);
             action = "Select Cube";
@@ -1378,6 +2454,14 @@ void OpenGL3DViewport::keyPressEvent(QKeyEvent* event) {
             setCurrentShape(4);
             action = "Select Tetrahedron";
             break;
+        case Qt::Key_5:
+            if (m_model || m_stlModel || m_cachedModel) {
+                setCurrentShape(MODEL);
+                action = "Select Loaded Model";
+            } else {
+                handled = false;
+            }
+            break;
 
         default:
             handled = false;
@@ -1608,10 +2692,410 @@ void OpenGL3DViewport::setSpaceMouseRotationSensitivity(float sensitivity) {
 }
 
 // ===================================================================
-// ANIMATION AND UPDATE
+// RENDER SCHEDULING
+// ===================================================================
+
+bool OpenGL3DViewport::continuousRendering() const {
+    return m_renderScheduler->isContinuous();
+}
+
+void OpenGL3DViewport::setContinuousRendering(bool continuous) {
+    if (m_renderScheduler->isContinuous() != continuous) {
+        // Continuous mode renders at the display refresh rate, not a fixed timer
+        m_renderScheduler->setContinuous(continuous);
+        emit continuousRenderingChanged();
+    }
+}
+
+void OpenGL3DViewport::setAdaptiveResolution(bool adaptive) {
+    // The window target of direct rendering is always drawn at full resolution
+    if (adaptive && directRendering()) {
+        qDebug() << "WARNING: Adaptive resolution does not apply to direct rendering";
+        return;
+    }
+    if (m_adaptiveResolution != adaptive) {
+        m_adaptiveResolution = adaptive;
+        m_qualityController.reset();
+        emit renderQualityChanged();
+        m_renderScheduler->requestFrame();
+        qDebug() << "Adaptive resolution:" << adaptive;
+    }
+}
+
+void OpenGL3DViewport::setTargetFrameTimeMs(double targetMs) {
+    if (!qFuzzyCompare(m_qualityController.targetFrameTimeMs(), targetMs)) {
+        m_qualityController.setTargetFrameTimeMs(targetMs);
+        emit renderQualityChanged();
+    }
+}
+
+void OpenGL3DViewport::setSampleCount(int samples) {
+    samples = qBound(0, samples, 16);
+    if (m_sampleCount != samples) {
+        m_sampleCount = samples;
+        m_qualityController.setMaxSampleCount(samples);
+        emit renderQualityChanged();
+        m_renderScheduler->requestFrame();
+    }
+}
+
+float OpenGL3DViewport::renderScale() const {
+    if (directRendering()) {
+        return 1.0f;
+    }
+    return m_adaptiveResolution ? m_qualityController.renderScale() : 1.0f;
+}
+
+int OpenGL3DViewport::requestedSampleCount() const {
+    // Direct rendering draws with whatever samples the window was created with
+    if (directRendering()) {
+        return m_activeSampleCount;
+    }
+    return m_adaptiveResolution ? m_qualityController.sampleCount() : m_sampleCount;
+}
+
+void OpenGL3DViewport::appendFrameSamples(const QVector<FrameSample>& samples) {
+    // Runs on the render thread while the GUI thread is blocked in synchronize()
+    if (samples.isEmpty()) {
+        return;
+    }
+
+    m_frameStatistics.append(samples);
+    QMetaObject::invokeMethod(this, &OpenGL3DViewport::frameStatsChanged, Qt::QueuedConnection);
+
+    if (!m_adaptiveResolution) {
+        return;
+    }
+
+    // GPU time of the passes when measured, CPU submission time otherwise
+    bool qualityChanged = false;
+    for (const FrameSample& sample : samples) {
+        double frameMs = qMax(sample.cpuFrameMs, sample.gpuFrameMs);
+        qualityChanged = m_qualityController.addFrameTime(frameMs) || qualityChanged;
+    }
+
+    // The renderer picks the new level up in the next synchronize()
+    if (qualityChanged) {
+        QMetaObject::invokeMethod(this, &OpenGL3DViewport::renderQualityChanged,
+                                  Qt::QueuedConnection);
+        QMetaObject::invokeMethod(m_renderScheduler, &RenderScheduler::requestFrame,
+                                  Qt::QueuedConnection);
+    }
+}
+
+void OpenGL3DViewport::reportRenderTarget(const QSize& size, int samples) {
+    // Runs on the render thread while the GUI thread is blocked in synchronize()
+    if (m_activeRenderSize != size || m_activeSampleCount != samples) {
+        m_activeRenderSize = size;
+        m_activeSampleCount = samples;
+        QMetaObject::invokeMethod(this, &OpenGL3DViewport::renderQualityChanged,
+                                  Qt::QueuedConnection);
+    }
+}
+
+bool OpenGL3DViewport::dumpFrameStats(const QString& filePath) {
+    // Write frame time distribution and per-frame pass timings for offline review
+    bool written = m_frameStatistics.writeToFile(filePath);
+    if (written) {
+        qDebug() << "Frame statistics written to" << filePath << "-" << m_frameStatistics.count()
+                 << "frames";
+    }
+    return written;
+}
+
+void OpenGL3DViewport::resetFrameStats() {
+    m_frameStatistics.clear();
+    emit frameStatsChanged();
+}
+
+void OpenGL3DViewport::itemChange(ItemChange change, const ItemChangeData& value) {
+    // Frames are paced by the window the viewport is shown in
+    if (change == ItemSceneChange) {
+        m_renderScheduler->setWindow(value.window);
+    }
+
+    QQuickFramebufferObject::itemChange(change, value);
+}
+
+// ===================================================================
+// MODEL LOADING
+// ===================================================================
+
+void OpenGL3DViewport::loadModel(const QUrl& fileUrl) {
+    if (m_modelLoading) {
+        qDebug() << "WARNING: A model is already loading, ignoring" << fileUrl;
+        return;
+    }
+
+    const QString path = fileUrl.isLocalFile() ? fileUrl.toLocalFile() : fileUrl.toString();
+    m_modelLoading = true;
+    m_modelLoadProgress = 0.0;
+    emit modelLoadingChanged();
+
+    // Parsing runs on the global thread pool. Progress arrives from its workers, so it is
+    // queued to the GUI thread, once per percent.
+    QSharedPointer<QAtomicInt> reportedPercent(new QAtomicInt(-1));
+    auto progress = [this, reportedPercent](double fraction) {
+        int percent = int(fraction * 100.0);
+        if (reportedPercent->fetchAndStoreRelaxed(percent) != percent) {
+            QMetaObject::invokeMethod(
+                this,
+                [this, fraction]() {
+                    if (m_modelLoading) {
+                        m_modelLoadProgress = fraction;
+                        emit modelLoadingChanged();
+                    }
+                },
+                Qt::QueuedConnection);
+        }
+        return !m_modelLoadCancelled.loadRelaxed();
+    };
+    const bool weld = m_weldModelVertices;
+    m_modelLoadWatcher.setFuture(QtConcurrent::run(
+        [path, weld, progress]() { return loadModelFile(path, weld, progress); }));
+    qDebug() << "Loading model:" << path;
+}
+
+void OpenGL3DViewport::setWeldModelVertices(bool weld) {
+    if (m_weldModelVertices != weld) {
+        m_weldModelVertices = weld;
+        emit modelChanged();
+    }
+}
+
+OpenGL3DViewport::ModelLoad OpenGL3DViewport::loadModelFile(
+    const QString& path, bool weld, const std::function<bool(double)>& progress) {
+    QElapsedTimer timer;
+    timer.start();
+
+    ModelLoad result;
+    result.path = path;
+    const QString suffix = QFileInfo(path).suffix().toLower();
+    if (suffix != "stl" && suffix != "obj") {
+        result.error = QString("Unsupported model format: %1").arg(QFileInfo(path).fileName());
+        return result;
+    }
+    if (suffix == "stl" && !weld) {
+        // Kept mapped and written into the vertex buffer by the renderer
+        QSharedPointer<StlFile> stl(new StlFile());
+        if (!stl->open(path, &result.error, progress)) {
+            return result;
+        }
+        stl->normalize();
+        result.stl = stl;
+        qDebug() << "Model mapped:" << path << "in" << timer.elapsed() << "ms";
+        return result;
+    }
+
+    // Parsed and welded models are stored in a cache file, which later loads map instead
+    const QString cachePath = MeshCacheFile::cachePath(path);
+    const QByteArray cacheKey =
+        MeshCacheFile::sourceKey(path, suffix == "stl" ? QByteArray("stl-weld") : "obj");
+    QSharedPointer<MeshCacheFile> cached(new MeshCacheFile());
+    if (!cacheKey.isEmpty() && cached->open(cachePath, cacheKey)) {
+        if (progress) {
+            progress(1.0);
+        }
+        result.cached = cached;
+        qDebug() << "Model mapped from cache:" << path << "in" << timer.elapsed() << "ms";
+        return result;
+    }
+
+    // Progress of one loading stage, mapped into its share of the whole load
+    auto stage = [&progress](double begin, double end) -> std::function<bool(double)> {
+        if (!progress) {
+            return std::function<bool(double)>();
+        }
+        return [&progress, begin, end](double fraction) {
+            return progress(begin + (end - begin) * fraction);
+        };
+    };
+    // Checked between the stages that cannot be interrupted
+    auto cancelled = [&progress, &result](double fraction) {
+        if (progress && !progress(fraction)) {
+            result.error = QStringLiteral("Loading cancelled");
+            return true;
+        }
+        return false;
+    };
+
+    QSharedPointer<MeshData> mesh(new MeshData());
+    if (suffix == "stl") {
+        StlFile stl;
+        if (!stl.open(path, &result.error, stage(0.0, kModelParseShare))) {
+            return result;
+        }
+        stl.normalize();
+        stl.weld(*mesh);
+    } else {
+        if (!ObjLoader::load(path, *mesh, &result.error, stage(0.0, kModelParseShare))) {
+            return result;
+        }
+        // Same size as the built-in shapes, whatever units the file uses
+        mesh->normalize();
+    }
+    if (cancelled(kModelParseShare)) {
+        return result;
+    }
+    // Scanned meshes come in close to random order; reordered once, before caching
+    MeshOptimizer::optimize(*mesh);
+    if (cancelled(kModelOptimizeShare)) {
+        return result;
+    }
+
+    // Uploaded from the cache mapping once it is written, so the vertices are packed only
+    // once and the parsed copy is freed before the renderer picks the model up. A failed
+    // write only costs the next load its speed; this one uploads the parsed mesh.
+    QString writeError;
+    if (!cacheKey.isEmpty() &&
+        MeshCacheFile::write(cachePath, cacheKey, *mesh, &writeError,
+                             stage(kModelOptimizeShare, 1.0)) &&
+        cached->open(cachePath, cacheKey)) {
+        result.cached = cached;
+    } else if (cancelled(1.0)) {
+        return result;
+    } else {
+        result.mesh = mesh;
+    }
+    qDebug() << "Model loaded:" << path << "in" << timer.elapsed() << "ms";
+    return result;
+}
+
+void OpenGL3DViewport::onModelLoadFinished() {
+    ModelLoad result = m_modelLoadWatcher.result();
+    m_modelLoading = false;
+    const bool loaded = result.mesh || result.stl || result.cached;
+    m_modelLoadProgress = loaded ? 1.0 : 0.0;
+    emit modelLoadingChanged();
+
+    if (!loaded) {
+        qDebug() << "ERROR: Failed to load model" << result.path << "-" << result.error;
+        emit modelLoadFailed(result.error);
+        return;
+    }
+
+    float minimum[3];
+    float maximum[3];
+    if (result.mesh) {
+        result.mesh->bounds(minimum, maximum);
+    } else if (result.stl) {
+        result.stl->bounds(minimum, maximum);
+    } else {
+        result.cached->bounds(minimum, maximum);
+    }
+    m_modelCorners.clear();
+    for (int corner = 0; corner < 8; ++corner) {
+        m_modelCorners.append(QVector3D(corner & 1 ? maximum[0] : minimum[0],
+                                        corner & 2 ? maximum[1] : minimum[1],
+                                        corner & 4 ? maximum[2] : minimum[2]));
+    }
+
+    m_model = result.mesh;
+    m_stlModel = result.stl;
+    m_cachedModel = result.cached;
+    m_modelName = QFileInfo(result.path).fileName();
+    emit modelChanged();
+
+    // Published with the shape switch, or on its own if a model is already shown
+    if (m_currentShape == MODEL) {
+        publishRenderState();
+    } else {
+        setCurrentShape(MODEL);
+    }
+}
+
+// ===================================================================
+// SESSION CAPTURE
 // ===================================================================
 
-void OpenGL3DViewport::updateAnimation() {
-    // Trigger continuous re-rendering for smooth animation
-    update();
-}
\ No newline at end of file
+bool OpenGL3DViewport::startCapture(const QString& path) {
+    if (path.isEmpty()) {
+        return false;
+    }
+    if (m_capturing) {
+        stopCapture();
+    }
+
+    m_capturing = true;
+    m_capturePath = path;
+    m_captureSession++;
+    m_capturedFrames = 0;
+    m_droppedCaptureFrames = 0;
+
+    // Record at a steady rate, not only when something changes
+    m_continuousBeforeCapture = continuousRendering();
+    setContinuousRendering(true);
+
+    emit captureChanged();
+    m_renderScheduler->requestFrame();
+    qDebug() << "Capture requested:" << path;
+    return true;
+}
+
+void OpenGL3DViewport::stopCapture() {
+    if (!m_capturing) {
+        return;
+    }
+
+    m_capturing = false;
+    m_captureSession++;
+    setContinuousRendering(m_continuousBeforeCapture);
+
+    emit captureChanged();
+    m_renderScheduler->requestFrame();
+    qDebug() << "Capture stop requested:" << m_capturePath;
+}
+
+void OpenGL3DViewport::setRecordTasks(bool record) {
+    if (m_recordTasks != record) {
+        m_recordTasks = record;
+        emit captureChanged();
+    }
+}
+
+void OpenGL3DViewport::setCaptureDirectory(const QString& directory) {
+    if (m_captureDirectory != directory) {
+        m_captureDirectory = directory;
+        emit captureChanged();
+    }
+}
+
+void OpenGL3DViewport::reportSilhouetteOverlap(float overlap, bool pending) {
+    // Runs on the render thread while the GUI thread is blocked in synchronize()
+    if (!qFuzzyCompare(m_silhouetteOverlap, overlap)) {
+        m_silhouetteOverlap = overlap;
+        QMetaObject::invokeMethod(this, &OpenGL3DViewport::alignmentChanged,
+                                  Qt::QueuedConnection);
+    }
+
+    // Results still in flight need another frame to be collected
+    if (pending) {
+        QMetaObject::invokeMethod(m_renderScheduler, &RenderScheduler::requestFrame,
+                                  Qt::QueuedConnection);
+    }
+}
+
+void OpenGL3DViewport::reportCaptureStats(int capturedFrames, int droppedFrames) {
+    // Runs on the render thread while the GUI thread is blocked in synchronize()
+    if (m_capturedFrames != capturedFrames || m_droppedCaptureFrames != droppedFrames) {
+        m_capturedFrames = capturedFrames;
+        m_droppedCaptureFrames = droppedFrames;
+        QMetaObject::invokeMethod(this, &OpenGL3DViewport::captureChanged, Qt::QueuedConnection);
+    }
+}
+
+void OpenGL3DViewport::onTaskStateChanged() {
+    if (!m_recordTasks) {
+        return;
+    }
+
+    // One video per trial, named after its start time
+    if (m_taskActive) {
+        QString directory = m_captureDirectory.isEmpty() ? QDir::currentPath() : m_captureDirectory;
+        QString fileName =
+            QString("trial_%1.avi").arg(QDateTime::currentDateTime().toString("yyyyMMdd_HHmmss"));
+        startCapture(QDir(directory).filePath(fileName));
+    } else {
+        stopCapture();
+    }
+}
@@ -3,24 +3,68 @@
 
 #include <QElapsedTimer>
 #include <QFocusEvent>
+#include <QFutureWatcher>
 #include <QKeyEvent>
 #include <QMatrix4x4>
 #include <QMouseEvent>
 #include <QOpenGLBuffer>
+#include <QOpenGLExtraFunctions>
 #include <QOpenGLFramebufferObject>
-#include <QOpenGLFunctions>
 #include <QOpenGLShaderProgram>
+#include <QOpenGLVertexArrayObject>
 #include <QQuaternion>
 #include <QQuickFramebufferObject>
 #include <QQuickItem>
-#include <QTimer>
+#include <QSharedPointer>
+#include <QUrl>
 #include <QVector3D>
 #include <QWheelEvent>
 
+#include "FrameProfiler.hpp"
+#include "QualityController.hpp"
+#include "RenderQueue.hpp"
+#include "TripleBuffer.hpp"
+
 // Forward declarations
+class FrameCapture;
+class GeometryAtlas;
+class GLStateTracker;
+class GlyphAtlas;
+class MeshCacheFile;
+class ModelMesh;
+class OitFramebuffer;
+class ProgramBinaryCache;
+class ReferenceLayer;
+class RenderScheduler;
+class SilhouetteOverlap;
 class SpaceMouseManager;
+class StlFile;
+struct MeshData;
+
+// Scene state of one frame, published by the viewport (GUI thread) whenever it changes and
+// picked up by the renderer (render thread) through a TripleBuffer. The camera is fixed.
+struct RenderState {
+    int shape = 4;
+    QVector3D translation;
+    QQuaternion rotation;  // Converted from the Euler angle properties once, on publish
+    float scale = 1.0f;
+    bool showReferenceModel = true;
+    bool showMovableModel = true;
+    bool showVertexLabels = true;
+    float edgeWidth = 4.0f;
+    bool orderIndependentTransparency = true;
+    bool alignmentHeatmap = false;
+    int heatmapColormap = 0;
+    float heatmapRange = 0.5f;
+    // Loaded model drawn as shape MODEL, if any: parsed, a binary STL file that is
+    // expanded straight into GPU memory, or a mapped cache file of an earlier parse
+    QSharedPointer<const MeshData> model;
+    QSharedPointer<const StlFile> stlModel;
+    QSharedPointer<const MeshCacheFile> cachedModel;
+};
 
-class OpenGL3DRenderer : public QQuickFramebufferObject::Renderer, protected QOpenGLFunctions {
+class OpenGL3DRenderer : public QQuickFramebufferObject::Renderer,
+                         protected QOpenGLExtraFunctions {
    public:
     OpenGL3DRenderer();
     ~OpenGL3DRenderer();
@@ -29,59 +73,181 @@ class OpenGL3DRenderer : public QQuickFramebufferObject::Renderer, protected QOp
     QOpenGLFramebufferObject* createFramebufferObject(const QSize& size) override;
     void synchronize(QQuickFramebufferObject* item) override;
 
+    // Direct rendering (OpenGL3DDirectViewport): draw into rect of the window's own render
+    // target instead of a framebuffer object. Call after synchronize().
+    void setDirectTarget(const QRect& rect, int samples);
+
+    // Offline benchmark hooks (bench/bench_renderer.cpp)
+    void setSyntheticMarkerCount(int count);
+    QVector<FrameSample> takeFrameSamples(bool waitForGpu = false);
+
    private:
+    // Uniform locations resolved once at setupShaders() time
+    struct UniformLocations {
+        int modelMatrix = -1;
+        int normalMatrix = -1;
+        int color = -1;
+        int alpha = -1;
+        int edgeAlpha = -1;     // Wireframe program only
+        int edgeWidth = -1;     // Wireframe program only
+        int viewportSize = -1;  // Wireframe program only
+        int referenceMatrix = -1;
+        int alignmentOffset = -1;
+        int heatmap = -1;
+        int heatmapRange = -1;
+        int glyphSize = -1;    // Label program only
+        int labelOffset = -1;  // Label program only
+    };
+
+    // Independent level-of-detail state (with hysteresis) per drawn mesh group
+    enum LodSlot {
+        ReferenceModelLod = 0,
+        MovableModelLod,
+        ReferenceMarkerLod,
+        MovableMarkerLod,
+        LodSlotCount
+    };
+
+    // RenderQueue layers: the reference stays behind the movable model when alpha blended
+    enum DrawOrder { ReferenceDraws = 0, MovableDraws, MarkerDraws, LabelDraws };
+
     void initializeGL();
     bool setupShaders();
+    UniformLocations resolveUniforms(QOpenGLShaderProgram* program);
+    QOpenGLShaderProgram* createProgram(const char* vertexSource, const char* fragmentSource,
+                                        const char* geometrySource = nullptr);
+    QOpenGLShaderProgram* buildProgram(const char* vertexSource, const char* fragmentSource,
+                                       const char* geometrySource, const QByteArray& cacheKey);
+    bool setupMarkerInstancing();
+    bool setupLabelInstancing();
+
+    // Latest published RenderState, if any arrived since the previous frame
+    void applyRenderState();
 
     // Camera and rendering setup
     void setupCameraMatrices();
+    void setViewport(const QPoint& origin);
+
+    // Frame composition: fixed-order alpha blending or weighted blended transparency
+    void renderBlended();
+    void renderOrderIndependent();
+    void compositeTransparency();
+
+    // Static reference model, shaded into an offscreen layer only when it changes
+    void renderReferenceLayer();
+    void updateReferenceLayer();
+    void seedReferenceLayer();
+
+    // Silhouette intersection over union via stencil marking and occlusion queries
+    void measureSilhouetteOverlap();
 
     // Dual model rendering methods
     void renderReferenceModel();
     void renderMovableModel();
     void renderVertexLabels();
+    void flushDraws();
 
     // Geometry rendering helpers
-    void bindAndRenderGeometry();
+    void updateModelMesh();
+    QOpenGLVertexArrayObject* shapeVertexArray() const;
+    void drawShape(int mesh, int level);
+    void bindAndRenderGeometry(int level);
+    int selectLod(LodSlot slot, int mesh, float screenRadius);
+    float projectedRadius(const QVector3D& worldCenter, float worldRadius) const;
     QVector3D getShapeColor(int shapeType) const;
+    void updateColormapTexture();
 
-    // Vertex marker rendering
-    void renderVertexMarker(const QVector3D& position, const QVector3D& color, float scale = 0.05f);
+    // Instanced vertex marker rendering
+    float appendMarkerInstances(const QVector<QVector3D>& positions, const QVector3D& color,
+                                float scale);
+    void renderMarkerInstances(int firstInstance, int instanceCount, int level);
+    void drawMarkerBatches();
     QVector<QVector3D> getShapeVertices(int shapeType) const;
 
-    // Geometry generation methods
-    void generateGeometry();
-    void generateCubeGeometry();
-    void generateSphereGeometry();
-    void generateTorusGeometry();
-    void generateTetrahedronGeometry();
-    void generateSphereMarkerGeometry();
-    void createSphereBuffers();
-    void updateBuffers();
+    // Numbered vertex labels from the signed distance field glyph atlas
+    void appendLabelInstances(const QVector<QVector3D>& positions, const QVector3D& color,
+                              bool primed);
+    void renderLabelText();
+    static QVector<QVector3D> syntheticMarkerPositions(int count);
 
     // Legacy compatibility
     void renderShape();
 
     // OpenGL resources
     QOpenGLShaderProgram* m_program;
-    QOpenGLBuffer* m_vertexBuffer;
-    QOpenGLBuffer* m_indexBuffer;
-    QOpenGLBuffer* m_normalBuffer;
-
-    // Sphere marker buffers
-    QOpenGLBuffer* m_sphereVertexBuffer;
-    QOpenGLBuffer* m_sphereIndexBuffer;
-    QOpenGLBuffer* m_sphereNormalBuffer;
-
-    // Shape data
-    QVector<float> m_vertices;
-    QVector<float> m_normals;
-    QVector<unsigned int> m_indices;
-
-    // Sphere marker data
-    QVector<float> m_sphereVertices;
-    QVector<float> m_sphereNormals;
-    QVector<unsigned int> m_sphereIndices;
+    QOpenGLShaderProgram* m_markerProgram;       // Instanced marker vertex stage
+    QOpenGLShaderProgram* m_wireframeProgram;    // Filled surface plus edges in one pass
+    QOpenGLShaderProgram* m_oitProgram;          // Transparency accumulation variants
+    QOpenGLShaderProgram* m_oitWireframeProgram;
+    QOpenGLShaderProgram* m_compositeProgram;    // Resolves the transparency targets
+    int m_compositeOriginLocation;
+    QOpenGLShaderProgram* m_referenceSeedProgram;  // Cached reference into the targets
+    QOpenGLShaderProgram* m_silhouetteProgram;     // Stencil-only model silhouettes
+    QOpenGLShaderProgram* m_fullscreenSilhouetteProgram;
+    QOpenGLShaderProgram* m_labelProgram;          // Distance field label glyphs
+    // References to the GpuResourceCache programs behind the pointers above
+    QVector<QSharedPointer<QOpenGLShaderProgram>> m_sharedPrograms;
+    QSharedPointer<GeometryAtlas> m_geometryAtlas;  // All shapes and the marker sphere
+    QOpenGLVertexArrayObject* m_geometryVao;        // This context's view of the atlas
+    // Loaded model: the viewport's data and its uploaded copy, shared like the atlas
+    QSharedPointer<const MeshData> m_modelData;
+    QSharedPointer<const StlFile> m_stlModel;
+    QSharedPointer<const MeshCacheFile> m_cachedModel;
+    QSharedPointer<ModelMesh> m_modelMesh;
+    QOpenGLVertexArrayObject* m_modelVao;
+    ProgramBinaryCache* m_programCache;          // Linked binaries from previous runs
+    UniformLocations m_programUniforms;
+    UniformLocations m_markerUniforms;
+    UniformLocations m_wireframeUniforms;
+    UniformLocations m_oitUniforms;
+    UniformLocations m_oitWireframeUniforms;
+    UniformLocations m_silhouetteUniforms;
+    UniformLocations m_labelUniforms;
+    GLuint m_frameUniformBuffer;  // FrameData block: camera and light, written once per frame
+    FrameProfiler* m_frameProfiler;
+
+    // Draw submission: sorted per pass, state changes filtered against a shadow copy
+    GLStateTracker* m_glState;
+    RenderQueue* m_renderQueue;
+    DrawState m_drawState;  // State of the draws submitted by the current pass
+
+    // Marker instancing: per-instance position, scale and color
+    QOpenGLVertexArrayObject* m_markerVao;
+    QOpenGLBuffer* m_markerInstanceBuffer;
+    QVector<float> m_markerInstances;
+
+    // Marker draws of the current frame (reference, movable)
+    struct MarkerBatch {
+        int firstInstance = 0;
+        int instanceCount = 0;
+        int level = 0;
+    };
+    MarkerBatch m_markerBatches[2];
+
+    // Label glyph instancing: every glyph of both models' labels in one draw
+    QSharedPointer<GlyphAtlas> m_glyphAtlas;
+    QOpenGLVertexArrayObject* m_labelVao;
+    QOpenGLBuffer* m_labelInstanceBuffer;
+    QVector<float> m_labelInstances;
+    int m_labelCount;  // Glyphs uploaded by the last renderVertexLabels() call
+
+    // Session video capture (asynchronous PBO readback)
+    FrameCapture* m_frameCapture;
+    int m_captureSession;
+
+    // Weighted blended order-independent transparency
+    OitFramebuffer* m_oitFramebuffer;
+    QOpenGLVertexArrayObject* m_fullscreenVao;  // Empty VAO for the fullscreen triangle
+
+    // Reference model shaded once per shape and render target
+    ReferenceLayer* m_referenceLayer;
+
+    // Image-space alignment score and the movable pose it was last measured at
+    SilhouetteOverlap* m_silhouetteOverlap;
+    QMatrix4x4 m_measuredMovableMatrix;
+
+    // Current tessellation level of each LodSlot
+    int m_lodLevels[LodSlotCount];
 
     // Transform state
     QMatrix4x4 m_modelMatrix;
@@ -102,6 +268,28 @@ class OpenGL3DRenderer : public QQuickFramebufferObject::Renderer, protected QOp
     // State
     bool m_initialized;
     QSize m_viewportSize;
+    int m_sampleCount;    // Requested MSAA samples of the framebuffer object
+    float m_renderScale;  // Framebuffer size relative to the item (upscaled by Qt Quick)
+    QSize m_framebufferSize;
+    int m_framebufferSamples;  // Samples the driver actually allocated
+    bool m_directTarget;       // Drawing into the window, not a framebuffer object
+    QPoint m_targetOrigin;     // Lower left corner of the item in the target, in pixels
+    float m_edgeWidth;  // Movable model edge width in framebuffer pixels
+    bool m_orderIndependentTransparency;
+    bool m_oitActive;  // Model passes write to the transparency targets
+
+    // Per-fragment alignment error on the movable model, mapped through a colormap
+    bool m_alignmentHeatmap;
+    int m_heatmapColormap;
+    float m_heatmapRange;
+    GLuint m_colormapTexture;
+    int m_colormapTextureName;  // Colormap currently in the texture (-1: none)
+
+    // Benchmark marker load: replaces the shape corners when non-empty
+    QVector<QVector3D> m_syntheticMarkers;
+
+    // Shared with the viewport, which may be destroyed first
+    QSharedPointer<TripleBuffer<RenderState>> m_renderStates;
 };
 
 class OpenGL3DViewport : public QQuickFramebufferObject {
@@ -127,9 +315,47 @@ class OpenGL3DViewport : public QQuickFramebufferObject {
         bool showMovableModel READ showMovableModel WRITE setShowMovableModel NOTIFY displayChanged)
     Q_PROPERTY(
         bool showVertexLabels READ showVertexLabels WRITE setShowVertexLabels NOTIFY displayChanged)
+    Q_PROPERTY(float edgeWidth READ edgeWidth WRITE setEdgeWidth NOTIFY displayChanged)
+    Q_PROPERTY(bool orderIndependentTransparency READ orderIndependentTransparency WRITE
+                   setOrderIndependentTransparency NOTIFY displayChanged)
+    Q_PROPERTY(bool alignmentHeatmap READ alignmentHeatmap WRITE setAlignmentHeatmap NOTIFY
+                   displayChanged)
+    Q_PROPERTY(int heatmapColormap READ heatmapColormap WRITE setHeatmapColormap NOTIFY
+                   displayChanged)
+    Q_PROPERTY(float heatmapRange READ heatmapRange WRITE setHeatmapRange NOTIFY displayChanged)
     Q_PROPERTY(float alignmentAccuracy READ alignmentAccuracy NOTIFY alignmentChanged)
+    Q_PROPERTY(float silhouetteOverlap READ silhouetteOverlap NOTIFY alignmentChanged)
     Q_PROPERTY(bool taskActive READ taskActive NOTIFY taskStateChanged)
 
+    // Model loading properties
+    Q_PROPERTY(bool modelLoading READ modelLoading NOTIFY modelLoadingChanged)
+    Q_PROPERTY(double modelLoadProgress READ modelLoadProgress NOTIFY modelLoadingChanged)
+    Q_PROPERTY(QString modelName READ modelName NOTIFY modelChanged)
+    Q_PROPERTY(bool weldModelVertices READ weldModelVertices WRITE setWeldModelVertices NOTIFY
+                   modelChanged)
+
+    // Rendering properties
+    Q_PROPERTY(bool continuousRendering READ continuousRendering WRITE setContinuousRendering
+                   NOTIFY continuousRenderingChanged)
+    Q_PROPERTY(QVariantMap frameStats READ frameStats NOTIFY frameStatsChanged)
+    Q_PROPERTY(bool directRendering READ directRendering CONSTANT)
+    Q_PROPERTY(bool adaptiveResolution READ adaptiveResolution WRITE setAdaptiveResolution NOTIFY
+                   renderQualityChanged)
+    Q_PROPERTY(double targetFrameTimeMs READ targetFrameTimeMs WRITE setTargetFrameTimeMs NOTIFY
+                   renderQualityChanged)
+    Q_PROPERTY(int sampleCount READ sampleCount WRITE setSampleCount NOTIFY renderQualityChanged)
+    Q_PROPERTY(float renderScale READ renderScale NOTIFY renderQualityChanged)
+    Q_PROPERTY(QSize activeRenderSize READ activeRenderSize NOTIFY renderQualityChanged)
+    Q_PROPERTY(int activeSampleCount READ activeSampleCount NOTIFY renderQualityChanged)
+
+    // Session capture properties
+    Q_PROPERTY(bool capturing READ capturing NOTIFY captureChanged)
+    Q_PROPERTY(int capturedFrames READ capturedFrames NOTIFY captureChanged)
+    Q_PROPERTY(int droppedCaptureFrames READ droppedCaptureFrames NOTIFY captureChanged)
+    Q_PROPERTY(bool recordTasks READ recordTasks WRITE setRecordTasks NOTIFY captureChanged)
+    Q_PROPERTY(QString captureDirectory READ captureDirectory WRITE setCaptureDirectory NOTIFY
+                   captureChanged)
+
     // SpaceMouse integration properties
     Q_PROPERTY(QString interactionMode READ interactionMode WRITE setInteractionMode NOTIFY
                    interactionModeChanged)
@@ -146,10 +372,15 @@ class OpenGL3DViewport : public QQuickFramebufferObject {
                    spaceMouseInputChanged)
 
    public:
-    enum Shape { CUBE = 1, SPHERE = 2, TORUS = 3, TETRAHEDRON = 4 };
+    enum Shape { CUBE = 1, SPHERE = 2, TORUS = 3, TETRAHEDRON = 4, MODEL = 5 };
     Q_ENUM(Shape)
 
+    // Matches Colormap::Name
+    enum HeatmapColormap { VIRIDIS = 0, INFERNO = 1, TRAFFIC_LIGHT = 2 };
+    Q_ENUM(HeatmapColormap)
+
     explicit OpenGL3DViewport(QQuickItem* parent = nullptr);
+    ~OpenGL3DViewport();
 
     Renderer* createRenderer() const override;
 
@@ -191,13 +422,114 @@ class OpenGL3DViewport : public QQuickFramebufferObject {
     bool showVertexLabels() const {
         return m_showVertexLabels;
     }
+    float edgeWidth() const {
+        return m_edgeWidth;
+    }
+    bool orderIndependentTransparency() const {
+        return m_orderIndependentTransparency;
+    }
+    bool alignmentHeatmap() const {
+        return m_alignmentHeatmap;
+    }
+    int heatmapColormap() const {
+        return m_heatmapColormap;
+    }
+    float heatmapRange() const {
+        return m_heatmapRange;
+    }
     float alignmentAccuracy() const {
         return m_alignmentAccuracy;
     }
+    float silhouetteOverlap() const {
+        return m_silhouetteOverlap;
+    }
     bool taskActive() const {
         return m_taskActive;
     }
 
+    // Model loading getters
+    bool modelLoading() const {
+        return m_modelLoading;
+    }
+    double modelLoadProgress() const {
+        return m_modelLoadProgress;
+    }
+    QString modelName() const {
+        return m_modelName;
+    }
+    bool weldModelVertices() const {
+        return m_weldModelVertices;
+    }
+
+    // Rendering getters
+    bool continuousRendering() const;
+    QVariantMap frameStats() const {
+        return m_frameStatistics.summary();
+    }
+    // True for items drawing straight into the window (OpenGL3DDirectViewport)
+    virtual bool directRendering() const {
+        return false;
+    }
+
+    // Render quality getters
+    bool adaptiveResolution() const {
+        return m_adaptiveResolution;
+    }
+    double targetFrameTimeMs() const {
+        return m_qualityController.targetFrameTimeMs();
+    }
+    int sampleCount() const {
+        return m_sampleCount;
+    }
+    float renderScale() const;
+    int requestedSampleCount() const;
+    QSize activeRenderSize() const {
+        return m_activeRenderSize;
+    }
+    int activeSampleCount() const {
+        return m_activeSampleCount;
+    }
+
+    // Scene snapshots for the renderer, read without blocking on the render thread
+    QSharedPointer<TripleBuffer<RenderState>> renderStates() const {
+        return m_renderStates;
+    }
+
+    // Called by the renderer during synchronize() with finished frame timings
+    void appendFrameSamples(const QVector<FrameSample>& samples);
+
+    // Called by the renderer during synchronize() with its current framebuffer
+    void reportRenderTarget(const QSize& size, int samples);
+
+    // Session capture getters
+    bool capturing() const {
+        return m_capturing;
+    }
+    int capturedFrames() const {
+        return m_capturedFrames;
+    }
+    int droppedCaptureFrames() const {
+        return m_droppedCaptureFrames;
+    }
+    bool recordTasks() const {
+        return m_recordTasks;
+    }
+    QString captureDirectory() const {
+        return m_captureDirectory;
+    }
+    QString capturePath() const {
+        return m_capturePath;
+    }
+    int captureSession() const {
+        return m_captureSession;
+    }
+
+    // Called by the renderer during synchronize() with the running session's counters
+    void reportCaptureStats(int capturedFrames, int droppedFrames);
+
+    // Called by the renderer during synchronize() with the latest silhouette overlap
+    void reportSilhouetteOverlap(float overlap, bool pending);
+
     // SpaceMouse getters
     QString interactionMode() const {
         return m_interactionMode;
@@ -241,8 +573,33 @@ class OpenGL3DViewport : public QQuickFramebufferObject {
     void setShowReferenceModel(bool show);
     void setShowMovableModel(bool show);
     void setShowVertexLabels(bool show);
+    void setEdgeWidth(float width);
+    void setOrderIndependentTransparency(bool enabled);
+    void setAlignmentHeatmap(bool enabled);
+    void setHeatmapColormap(int colormap);
+    void setHeatmapRange(float range);
     void calculateAlignmentAccuracy();
 
+    // Rendering setters
+    void setContinuousRendering(bool continuous);
+    void setAdaptiveResolution(bool adaptive);
+    void setTargetFrameTimeMs(double targetMs);
+    void setSampleCount(int samples);
+
+    // Frame timing statistics
+    bool dumpFrameStats(const QString& filePath);
+    void resetFrameStats();
+
+    // Session capture: path ending in .avi/.mp4 records a video, otherwise PNG images
+    Q_INVOKABLE bool startCapture(const QString& path);
+    Q_INVOKABLE void stopCapture();
+    void setRecordTasks(bool record);
+    void setCaptureDirectory(const QString& directory);
+
+    // Model loading: parsed on worker threads, shown as shape MODEL once loaded
+    Q_INVOKABLE void loadModel(const QUrl& fileUrl);
+    void setWeldModelVertices(bool weld);
+
     // Research task methods
     Q_INVOKABLE void startAlignmentTask();
     Q_INVOKABLE void finishAlignmentTask();
@@ -266,6 +623,17 @@ class OpenGL3DViewport : public QQuickFramebufferObject {
     void taskStateChanged();
     void alignmentCompleted(float accuracy, int timeMs);
 
+    // Model loading signals
+    void modelLoadingChanged();
+    void modelChanged();
+    void modelLoadFailed(const QString& message);
+
+    // Rendering signals
+    void continuousRenderingChanged();
+    void frameStatsChanged();
+    void renderQualityChanged();
+    void captureChanged();
+
     // SpaceMouse signals
     void interactionModeChanged();
     void spaceMouseEnabledChanged();
@@ -281,10 +649,9 @@ class OpenGL3DViewport : public QQuickFramebufferObject {
     void wheelEvent(QWheelEvent* event) override;
     void keyPressEvent(QKeyEvent* event) override;
     void focusInEvent(QFocusEvent* event) override;
+    void itemChange(ItemChange change, const ItemChangeData& value) override;
 
    private slots:
-    void updateAnimation();
-
     // SpaceMouse input handlers
     void handleSpaceMouseTranslation(const QVector3D& translation);
     void handleSpaceMouseRotation(const QVector3D& rotation);
@@ -292,7 +659,24 @@ class OpenGL3DViewport : public QQuickFramebufferObject {
     void handleSpaceMouseRightButton();
     void onSpaceMouseConnectionChanged(bool connected);
 
+    // Starts and stops task recordings
+    void onTaskStateChanged();
+
+    // Takes over the mesh of a finished loadModel()
+    void onModelLoadFinished();
+
    private:
+    // Result of one loadModel() call, produced on a worker thread
+    struct ModelLoad {
+        QString path;
+        QSharedPointer<MeshData> mesh;         // Parsed or welded model
+        QSharedPointer<StlFile> stl;           // Mapped binary STL
+        QSharedPointer<MeshCacheFile> cached;  // Mapped cache file (all null on failure)
+        QString error;
+    };
+    static ModelLoad loadModelFile(const QString& path, bool weld,
+                                   const std::function<bool(double)>& progress);
+
     // Helper methods for mouse interactions
     void applyRotationDelta(const QPoint& delta);
     void applyTranslationDelta(const QPoint& delta);
@@ -301,6 +685,9 @@ class OpenGL3DViewport : public QQuickFramebufferObject {
     // SpaceMouse initialization
     void initializeSpaceMouse();
 
+    // Publishes the scene properties as a new RenderState and schedules a frame
+    void publishRenderState();
+
     // Research helper methods
     QVector<QVector3D> getBaseVertices() const;
 
@@ -309,7 +696,26 @@ class OpenGL3DViewport : public QQuickFramebufferObject {
     QVector3D m_translation;
     QVector3D m_rotation;
     float m_scale;
-    QTimer* m_animationTimer;
+    RenderScheduler* m_renderScheduler;
+    QSharedPointer<TripleBuffer<RenderState>> m_renderStates;
+    FrameStatistics m_frameStatistics;
+
+    // Render quality (resolution and MSAA)
+    bool m_adaptiveResolution;
+    int m_sampleCount;
+    QualityController m_qualityController;
+    QSize m_activeRenderSize;
+    int m_activeSampleCount;
+
+    // Session capture
+    bool m_capturing;
+    QString m_capturePath;
+    int m_captureSession;  // Incremented on every start and stop
+    int m_capturedFrames;
+    int m_droppedCaptureFrames;
+    bool m_recordTasks;
+    QString m_captureDirectory;
+    bool m_continuousBeforeCapture;
 
     // Mouse interaction state
     bool m_mousePressed;
@@ -323,10 +729,28 @@ class OpenGL3DViewport : public QQuickFramebufferObject {
     bool m_showReferenceModel;
     bool m_showMovableModel;
     bool m_showVertexLabels;
+    float m_edgeWidth;
+    bool m_orderIndependentTransparency;
+    bool m_alignmentHeatmap;
+    int m_heatmapColormap;
+    float m_heatmapRange;  // Displacement at the top of the colormap (scene units)
     float m_alignmentAccuracy;
+    float m_silhouetteOverlap;  // Intersection over union, -1 until measured
     QElapsedTimer m_taskStartTime;
     bool m_taskActive;
 
+    // Loaded model, shared with the renderer through RenderState
+    QSharedPointer<const MeshData> m_model;
+    QSharedPointer<const StlFile> m_stlModel;
+    QSharedPointer<const MeshCacheFile> m_cachedModel;
+    QString m_modelName;
+    QVector<QVector3D> m_modelCorners;  // Bounding box corners, the model's base vertices
+    bool m_modelLoading;
+    double m_modelLoadProgress;
+    bool m_weldModelVertices;  // Binary STL: merge shared corners (smooth, copied on the heap)
+    QFutureWatcher<ModelLoad> m_modelLoadWatcher;
+    QAtomicInt m_modelLoadCancelled;  // Set on destruction, polled by the loader threads
+
     // SpaceMouse integration
     QString m_interactionMode;
     bool m_spaceMouseEnabled;
@@ -0,0 +1,150 @@
+#include "ProgramBinaryCache.hpp"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDebug>
+#include <QDir>
+#include <QFile>
+#include <QOpenGLContext>
+#include <QOpenGLShaderProgram>
+#include <QSaveFile>
+#include <QStandardPaths>
+
+// ARB_get_program_binary / GL 4.1 / ES 3.0 tokens
+#ifndef GL_PROGRAM_BINARY_RETRIEVABLE_HINT
+#define GL_PROGRAM_BINARY_RETRIEVABLE_HINT 0x8257
+#endif
+#ifndef GL_PROGRAM_BINARY_LENGTH
+#define GL_PROGRAM_BINARY_LENGTH 0x8741
+#endif
+#ifndef GL_NUM_PROGRAM_BINARY_FORMATS
+#define GL_NUM_PROGRAM_BINARY_FORMATS 0x87FE
+#endif
+
+// Bumped when the file layout changes
+static const quint32 kCacheFileMagic = 0x50424331;  // "PBC1"
+
+ProgramBinaryCache::ProgramBinaryCache() : m_initialized(false), m_supported(false) {}
+
+void ProgramBinaryCache::initialize() {
+    if (m_initialized) {
+        return;
+    }
+    m_initialized = true;
+
+    QOpenGLContext* context = QOpenGLContext::currentContext();
+    if (!context) {
+        return;
+    }
+    initializeOpenGLFunctions();
+
+    // Program binaries are core in GL 4.1 and ES 3.0, an extension before that
+    QPair<int, int> version = context->format().version();
+    bool coreSupport = context->isOpenGLES() ? version >= qMakePair(3, 0)
+                                              : version >= qMakePair(4, 1);
+    if (coreSupport || context->hasExtension("GL_ARB_get_program_binary")) {
+        GLint formatCount = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+        m_supported = formatCount > 0;
+    }
+
+    m_contextKey = QByteArray(reinterpret_cast<const char*>(glGetString(GL_VENDOR))) + '\n' +
+                   reinterpret_cast<const char*>(glGetString(GL_RENDERER)) + '\n' +
+                   reinterpret_cast<const char*>(glGetString(GL_VERSION));
+    m_directory = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) +
+                  QStringLiteral("/shaders");
+
+    qDebug() << "Program binary cache:" << (m_supported ? m_directory : QString("unsupported"));
+}
+
+QByteArray ProgramBinaryCache::key(const QList<const char*>& sources) const {
+    QCryptographicHash hash(QCryptographicHash::Sha1);
+    for (const char* source : sources) {
+        if (source) {
+            hash.addData(QByteArray::fromRawData(source, qstrlen(source)));
+        }
+        hash.addData(QByteArray(1, '\0'));  // Keeps (a, bc) and (ab, c) apart
+    }
+    hash.addData(m_contextKey);
+    return hash.result().toHex();
+}
+
+bool ProgramBinaryCache::load(QOpenGLShaderProgram* program, const QByteArray& key) {
+    if (!m_supported) {
+        return false;
+    }
+
+    QFile file(filePath(key));
+    if (!file.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+
+    QDataStream stream(&file);
+    quint32 magic = 0;
+    quint32 binaryFormat = 0;
+    QByteArray binary;
+    stream >> magic >> binaryFormat >> binary;
+    file.close();
+    if (stream.status() != QDataStream::Ok || magic != kCacheFileMagic || binary.isEmpty()) {
+        QFile::remove(filePath(key));
+        return false;
+    }
+
+    // QOpenGLShaderProgram::link() without shaders accepts an already linked program
+    if (!program->create()) {
+        return false;
+    }
+    glProgramBinary(program->programId(), binaryFormat, binary.constData(), binary.size());
+
+    GLint linked = GL_FALSE;
+    glGetProgramiv(program->programId(), GL_LINK_STATUS, &linked);
+    if (!linked || !program->link()) {
+        // Driver rejected the binary (e.g. after an update with unchanged version strings)
+        qDebug() << "Program cache entry rejected:" << key.left(8);
+        QFile::remove(filePath(key));
+        return false;
+    }
+    return true;
+}
+
+void ProgramBinaryCache::prepareForSave(QOpenGLShaderProgram* program) {
+    if (m_supported) {
+        glProgramParameteri(program->programId(), GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
+    }
+}
+
+void ProgramBinaryCache::save(QOpenGLShaderProgram* program, const QByteArray& key) {
+    if (!m_supported) {
+        return;
+    }
+
+    GLint length = 0;
+    glGetProgramiv(program->programId(), GL_PROGRAM_BINARY_LENGTH, &length);
+    if (length <= 0) {
+        return;
+    }
+
+    QByteArray binary(length, Qt::Uninitialized);
+    GLenum binaryFormat = 0;
+    GLsizei written = 0;
+    glGetProgramBinary(program->programId(), length, &written, &binaryFormat, binary.data());
+    if (written <= 0) {
+        return;
+    }
+    binary.truncate(written);
+
+    // Write atomically so a concurrent renderer never reads a partial entry
+    QDir().mkpath(m_directory);
+    QSaveFile file(filePath(key));
+    if (!file.open(QIODevice::WriteOnly)) {
+        qDebug() << "Program cache not writable:" << m_directory;
+        return;
+    }
+    QDataStream stream(&file);
+    stream << kCacheFileMagic << quint32(binaryFormat) << binary;
+    file.commit();
+}
+
+QString ProgramBinaryCache::filePath(const QByteArray& key) const {
+    return m_directory + QLatin1Char('/') + QString::fromLatin1(key) + QStringLiteral(".bin");
+}
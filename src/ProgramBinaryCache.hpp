@@ -0,0 +1,50 @@
+#ifndef PROGRAMBINARYCACHE_HPP
+#define PROGRAMBINARYCACHE_HPP
+
+#include <QByteArray>
+#include <QList>
+#include <QOpenGLExtraFunctions>
+#include <QString>
+
+class QOpenGLShaderProgram;
+
+/**
+ * @brief On-disk cache of linked shader program binaries
+ *
+ * Entries are keyed on a hash of the shader sources plus the GL vendor, renderer and
+ * version strings, so a driver update or a different GPU never sees a stale binary. They
+ * are stored under the user cache directory. A binary the driver rejects is deleted and
+ * the caller falls back to compiling from source.
+ */
+class ProgramBinaryCache : protected QOpenGLExtraFunctions {
+   public:
+    ProgramBinaryCache();
+
+    // Detects program binary support (requires a current OpenGL context)
+    void initialize();
+    bool isSupported() const {
+        return m_supported;
+    }
+
+    // Cache key of a program built from the given sources (null entries are skipped)
+    QByteArray key(const QList<const char*>& sources) const;
+
+    // Links program from a cached binary; false on a miss or a rejected binary
+    bool load(QOpenGLShaderProgram* program, const QByteArray& key);
+
+    // Must be called after the shaders are added and before linking from source
+    void prepareForSave(QOpenGLShaderProgram* program);
+
+    // Stores the binary of a program linked from source
+    void save(QOpenGLShaderProgram* program, const QByteArray& key);
+
+   private:
+    QString filePath(const QByteArray& key) const;
+
+    bool m_initialized;
+    bool m_supported;
+    QByteArray m_contextKey;  // Vendor, renderer and version strings
+    QString m_directory;
+};
+
+#endif  // PROGRAMBINARYCACHE_HPP
@@ -0,0 +1,108 @@
+#include "QualityController.hpp"
+
+#include <QDebug>
+#include <QtGlobal>
+
+// Quality ladder, best first: framebuffer scale relative to the item and MSAA samples
+struct QualityLevel {
+    float scale;
+    int samples;
+};
+static const QualityLevel kQualityLevels[] = {
+    {1.0f, 4}, {1.0f, 2}, {0.85f, 2}, {0.75f, 0}, {0.6f, 0}, {0.5f, 0}};
+static const int kQualityLevelCount = sizeof(kQualityLevels) / sizeof(kQualityLevels[0]);
+
+// Frames averaged per decision
+static const int kWindowFrames = 30;
+
+// Step up once this many consecutive windows average below this fraction of the target
+static const int kFastWindowsToStepUp = 3;
+static const double kStepUpFraction = 0.7;
+
+QualityController::QualityController()
+    : m_targetMs(1000.0 / 60.0),
+      m_maxSamples(4),
+      m_level(0),
+      m_windowFrames(0),
+      m_windowSumMs(0.0),
+      m_fastWindows(0),
+      m_skipWindow(false) {}
+
+void QualityController::setTargetFrameTimeMs(double targetMs) {
+    m_targetMs = qMax(1.0, targetMs);
+    m_windowFrames = 0;
+    m_windowSumMs = 0.0;
+    m_fastWindows = 0;
+    m_skipWindow = false;
+}
+
+void QualityController::setMaxSampleCount(int samples) {
+    m_maxSamples = qMax(0, samples);
+}
+
+void QualityController::reset() {
+    m_level = 0;
+    m_windowFrames = 0;
+    m_windowSumMs = 0.0;
+    m_fastWindows = 0;
+    m_skipWindow = false;
+}
+
+bool QualityController::addFrameTime(double frameMs) {
+    m_windowSumMs += frameMs;
+    if (++m_windowFrames < kWindowFrames) {
+        return false;
+    }
+
+    double meanMs = m_windowSumMs / m_windowFrames;
+    m_windowFrames = 0;
+    m_windowSumMs = 0.0;
+
+    // The frames right after a change pay for the framebuffer reallocation
+    if (m_skipWindow) {
+        m_skipWindow = false;
+        return false;
+    }
+
+    // Over budget: drop one level immediately
+    if (meanMs > m_targetMs) {
+        m_fastWindows = 0;
+        return changeLevel(m_level + 1);
+    }
+
+    // Well under budget for long enough: try one level better
+    if (meanMs < m_targetMs * kStepUpFraction) {
+        if (++m_fastWindows >= kFastWindowsToStepUp) {
+            m_fastWindows = 0;
+            return changeLevel(m_level - 1);
+        }
+    } else {
+        m_fastWindows = 0;
+    }
+    return false;
+}
+
+int QualityController::levelCount() const {
+    return kQualityLevelCount;
+}
+
+float QualityController::renderScale() const {
+    return kQualityLevels[m_level].scale;
+}
+
+int QualityController::sampleCount() const {
+    return qMin(kQualityLevels[m_level].samples, m_maxSamples);
+}
+
+bool QualityController::changeLevel(int level) {
+    level = qBound(0, level, kQualityLevelCount - 1);
+    if (level == m_level) {
+        return false;
+    }
+
+    m_level = level;
+    m_skipWindow = true;
+    qDebug() << "Render quality level" << level << "- scale" << renderScale() << "samples"
+             << sampleCount();
+    return true;
+}
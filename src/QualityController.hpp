@@ -0,0 +1,51 @@
+#ifndef QUALITYCONTROLLER_HPP
+#define QUALITYCONTROLLER_HPP
+
+#include <QVector>
+
+/**
+ * @brief Frame-time driven render quality ladder (resolution scale and MSAA samples)
+ *
+ * Frame times are averaged over a fixed window. A window over budget steps one level down
+ * the ladder right away; stepping back up needs several consecutive windows comfortably
+ * under budget, so quality does not oscillate around the target. The window after a
+ * change is discarded, since its frames include the framebuffer reallocation.
+ */
+class QualityController {
+   public:
+    QualityController();
+
+    void setTargetFrameTimeMs(double targetMs);
+    double targetFrameTimeMs() const {
+        return m_targetMs;
+    }
+
+    // Upper bound for the sample count of every level (the configured MSAA)
+    void setMaxSampleCount(int samples);
+
+    // Back to full quality with an empty window
+    void reset();
+
+    // Feeds one measured frame time, returns true when the quality level changed
+    bool addFrameTime(double frameMs);
+
+    int level() const {
+        return m_level;
+    }
+    int levelCount() const;
+    float renderScale() const;
+    int sampleCount() const;
+
+   private:
+    bool changeLevel(int level);
+
+    double m_targetMs;
+    int m_maxSamples;
+    int m_level;
+    int m_windowFrames;
+    double m_windowSumMs;
+    int m_fastWindows;
+    bool m_skipWindow;  // The current window includes a level change
+};
+
+#endif  // QUALITYCONTROLLER_HPP
@@ -0,0 +1,189 @@
+#include "ReferenceLayer.hpp"
+
+#include <QDebug>
+
+ReferenceLayer::ReferenceLayer()
+    : m_functionsInitialized(false),
+      m_mode(Blended),
+      m_samples(0),
+      m_current(false),
+      m_framebuffer(0),
+      m_colorBuffer(0),
+      m_depthStencilBuffer(0),
+      m_accumulationTexture(0),
+      m_weightTexture(0),
+      m_depthTexture(0) {}
+
+ReferenceLayer::~ReferenceLayer() {
+    destroy();
+}
+
+bool ReferenceLayer::resize(Mode mode, const QSize& size, int samples) {
+    // Transparency targets are never multisampled
+    if (mode == OrderIndependent) {
+        samples = 0;
+    }
+    if (isValid() && m_mode == mode && m_size == size && m_samples == samples) {
+        return true;
+    }
+
+    if (!m_functionsInitialized) {
+        initializeOpenGLFunctions();
+        m_functionsInitialized = true;
+    }
+
+    destroy();
+    if (size.isEmpty()) {
+        return false;
+    }
+    m_mode = mode;
+    m_size = size;
+    m_samples = samples;
+
+    // Keep the caller's framebuffer binding
+    GLint previousFramebuffer = 0;
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &previousFramebuffer);
+
+    glGenFramebuffers(1, &m_framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+    bool created = true;
+    if (mode == Blended) {
+        created = createBlendedTargets();
+    } else {
+        createOrderIndependentTargets();
+    }
+
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindFramebuffer(GL_FRAMEBUFFER, previousFramebuffer);
+
+    if (!created || status != GL_FRAMEBUFFER_COMPLETE) {
+        qDebug() << "ERROR: Reference layer framebuffer incomplete, status" << Qt::hex << status;
+        destroy();
+        return false;
+    }
+
+    qDebug() << "Reference layer created:" << size << "samples" << samples
+             << (mode == Blended ? "(blended)" : "(order independent)");
+    return true;
+}
+
+void ReferenceLayer::destroy() {
+    m_current = false;
+    if (!m_functionsInitialized) {
+        return;
+    }
+
+    if (m_framebuffer) {
+        glDeleteFramebuffers(1, &m_framebuffer);
+    }
+    if (m_colorBuffer) {
+        glDeleteRenderbuffers(1, &m_colorBuffer);
+    }
+    if (m_depthStencilBuffer) {
+        glDeleteRenderbuffers(1, &m_depthStencilBuffer);
+    }
+    if (m_accumulationTexture) {
+        glDeleteTextures(1, &m_accumulationTexture);
+    }
+    if (m_weightTexture) {
+        glDeleteTextures(1, &m_weightTexture);
+    }
+    if (m_depthTexture) {
+        glDeleteTextures(1, &m_depthTexture);
+    }
+
+    m_framebuffer = 0;
+    m_colorBuffer = 0;
+    m_depthStencilBuffer = 0;
+    m_accumulationTexture = 0;
+    m_weightTexture = 0;
+    m_depthTexture = 0;
+    m_size = QSize();
+}
+
+void ReferenceLayer::bindAndClear() {
+    glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+
+    if (m_mode == Blended) {
+        glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT | GL_STENCIL_BUFFER_BIT);
+        return;
+    }
+
+    // Nothing accumulated, everything behind fully revealed
+    const GLfloat accumulationClear[4] = {0.0f, 0.0f, 0.0f, 1.0f};
+    const GLfloat weightClear[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    const GLfloat depthClear = 1.0f;
+    glClearBufferfv(GL_COLOR, 0, accumulationClear);
+    glClearBufferfv(GL_COLOR, 1, weightClear);
+    glClearBufferfv(GL_DEPTH, 0, &depthClear);
+}
+
+void ReferenceLayer::blitTo(GLuint framebuffer) {
+    // Same size, sample count and formats as the item framebuffer: a plain copy
+    glBindFramebuffer(GL_READ_FRAMEBUFFER, m_framebuffer);
+    glBindFramebuffer(GL_DRAW_FRAMEBUFFER, framebuffer);
+    glBlitFramebuffer(0, 0, m_size.width(), m_size.height(), 0, 0, m_size.width(),
+                      m_size.height(), GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT, GL_NEAREST);
+    glBindFramebuffer(GL_FRAMEBUFFER, framebuffer);
+}
+
+bool ReferenceLayer::createBlendedTargets() {
+    // Formats of a QOpenGLFramebufferObject with a CombinedDepthStencil attachment
+    m_colorBuffer = createRenderbuffer(GL_RGBA8);
+    m_depthStencilBuffer = createRenderbuffer(GL_DEPTH24_STENCIL8);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_RENDERBUFFER,
+                              m_colorBuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER,
+                              m_depthStencilBuffer);
+
+    // Multisample blits need identical sample counts, which the driver may round up
+    GLint allocatedSamples = 0;
+    glBindRenderbuffer(GL_RENDERBUFFER, m_colorBuffer);
+    glGetRenderbufferParameteriv(GL_RENDERBUFFER, GL_RENDERBUFFER_SAMPLES, &allocatedSamples);
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+    if (allocatedSamples != m_samples) {
+        qDebug() << "ERROR: Reference layer got" << allocatedSamples << "samples instead of"
+                 << m_samples;
+        return false;
+    }
+    return true;
+}
+
+void ReferenceLayer::createOrderIndependentTargets() {
+    m_accumulationTexture = createTexture(GL_RGBA16F, GL_RGBA, GL_FLOAT);
+    m_weightTexture = createTexture(GL_R16F, GL_RED, GL_FLOAT);
+    m_depthTexture = createTexture(GL_DEPTH_COMPONENT24, GL_DEPTH_COMPONENT, GL_UNSIGNED_INT);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT0, GL_TEXTURE_2D,
+                           m_accumulationTexture, 0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_COLOR_ATTACHMENT1, GL_TEXTURE_2D, m_weightTexture,
+                           0);
+    glFramebufferTexture2D(GL_FRAMEBUFFER, GL_DEPTH_ATTACHMENT, GL_TEXTURE_2D, m_depthTexture, 0);
+
+    const GLenum drawBuffers[2] = {GL_COLOR_ATTACHMENT0, GL_COLOR_ATTACHMENT1};
+    glDrawBuffers(2, drawBuffers);
+}
+
+GLuint ReferenceLayer::createTexture(GLenum internalFormat, GLenum format, GLenum type) {
+    // Sampled with texelFetch only, no filtering or mipmaps
+    GLuint texture = 0;
+    glGenTextures(1, &texture);
+    glBindTexture(GL_TEXTURE_2D, texture);
+    glTexImage2D(GL_TEXTURE_2D, 0, internalFormat, m_size.width(), m_size.height(), 0, format,
+                 type, nullptr);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_CLAMP_TO_EDGE);
+    glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_CLAMP_TO_EDGE);
+    glBindTexture(GL_TEXTURE_2D, 0);
+    return texture;
+}
+
+GLuint ReferenceLayer::createRenderbuffer(GLenum internalFormat) {
+    GLuint renderbuffer = 0;
+    glGenRenderbuffers(1, &renderbuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, renderbuffer);
+    glRenderbufferStorageMultisample(GL_RENDERBUFFER, m_samples, internalFormat, m_size.width(),
+                                     m_size.height());
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+    return renderbuffer;
+}
@@ -0,0 +1,84 @@
+#ifndef REFERENCELAYER_HPP
+#define REFERENCELAYER_HPP
+
+#include <QOpenGLExtraFunctions>
+#include <QSize>
+
+/**
+ * @brief Offscreen copy of the static reference model layer
+ *
+ * The camera and the reference transform never change, so the reference model only needs
+ * shading again when its shape or the render target changes. In Blended mode the layer
+ * holds the background with the reference blended over it, color plus depth, in
+ * renderbuffers matching the item framebuffer so both can be blitted straight into it. In
+ * OrderIndependent mode it holds the reference's share of the transparency targets plus
+ * the depth of its nearest surface, all as textures for a fullscreen seed pass.
+ */
+class ReferenceLayer : protected QOpenGLExtraFunctions {
+   public:
+    enum Mode { Blended = 0, OrderIndependent };
+
+    ReferenceLayer();
+    ~ReferenceLayer();
+
+    // (Re)creates the targets when mode, size or sample count change, which discards the
+    // content (requires a current OpenGL context)
+    bool resize(Mode mode, const QSize& size, int samples);
+    void destroy();
+    bool isValid() const {
+        return m_framebuffer != 0;
+    }
+
+    // Content stays current until invalidate() or a resize
+    bool isCurrent() const {
+        return m_current;
+    }
+    void setCurrent() {
+        m_current = true;
+    }
+    void invalidate() {
+        m_current = false;
+    }
+
+    // Binds the layer and resets it: Blended to the current clear color and depth,
+    // OrderIndependent to empty accumulation, full revealage and far depth
+    void bindAndClear();
+
+    // Blended mode: copies color and depth into framebuffer and leaves it bound
+    void blitTo(GLuint framebuffer);
+
+    // OrderIndependent mode textures
+    GLuint accumulationTexture() const {
+        return m_accumulationTexture;
+    }
+    GLuint weightTexture() const {
+        return m_weightTexture;
+    }
+    GLuint depthTexture() const {
+        return m_depthTexture;
+    }
+
+   private:
+    bool createBlendedTargets();
+    void createOrderIndependentTargets();
+    GLuint createTexture(GLenum internalFormat, GLenum format, GLenum type);
+    GLuint createRenderbuffer(GLenum internalFormat);
+
+    bool m_functionsInitialized;
+    Mode m_mode;
+    QSize m_size;
+    int m_samples;
+    bool m_current;
+    GLuint m_framebuffer;
+
+    // Blended mode
+    GLuint m_colorBuffer;
+    GLuint m_depthStencilBuffer;
+
+    // OrderIndependent mode
+    GLuint m_accumulationTexture;
+    GLuint m_weightTexture;
+    GLuint m_depthTexture;
+};
+
+#endif  // REFERENCELAYER_HPP
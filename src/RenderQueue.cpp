@@ -0,0 +1,61 @@
+#include "RenderQueue.hpp"
+
+#include <algorithm>
+
+#include "GLStateTracker.hpp"
+
+static GLuint programId(const RenderQueue::DrawItem& item) {
+    return item.program ? item.program->programId() : 0;
+}
+
+static GLuint vertexArrayId(const RenderQueue::DrawItem& item) {
+    return item.vertexArray ? item.vertexArray->objectId() : 0;
+}
+
+void RenderQueue::submit(const DrawItem& item) {
+    m_items.append(item);
+}
+
+void RenderQueue::flush(GLStateTracker& state) {
+    // Stable, so equal items keep their submission order
+    std::stable_sort(m_items.begin(), m_items.end(), [](const DrawItem& a, const DrawItem& b) {
+        if (a.layer != b.layer) {
+            return a.layer < b.layer;
+        }
+        if (programId(a) != programId(b)) {
+            return programId(a) < programId(b);
+        }
+        if (vertexArrayId(a) != vertexArrayId(b)) {
+            return vertexArrayId(a) < vertexArrayId(b);
+        }
+        return a.state.sortKey() < b.state.sortKey();
+    });
+
+    for (const DrawItem& item : m_items) {
+        state.useProgram(item.program);
+        state.bindVertexArray(item.vertexArray);
+
+        switch (item.state.blending) {
+            case DrawState::Opaque:
+                state.setEnabled(GLStateTracker::Blend, false);
+                break;
+            case DrawState::AlphaBlend:
+                state.setEnabled(GLStateTracker::Blend, true);
+                state.setBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+                break;
+            case DrawState::Accumulate:
+                // Weighted blended transparency targets (see OitFramebuffer)
+                state.setEnabled(GLStateTracker::Blend, true);
+                state.setBlendFuncSeparate(GL_ONE, GL_ONE, GL_ZERO, GL_ONE_MINUS_SRC_ALPHA);
+                break;
+        }
+        state.setEnabled(GLStateTracker::DepthTest, item.state.depthTest);
+        state.setDepthMask(item.state.depthWrite);
+        state.setColorMask(item.state.colorWrite);
+
+        item.draw();
+        state.countDrawCall();
+    }
+
+    m_items.clear();
+}
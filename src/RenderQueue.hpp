@@ -0,0 +1,59 @@
+#ifndef RENDERQUEUE_HPP
+#define RENDERQUEUE_HPP
+
+#include <QOpenGLShaderProgram>
+#include <QOpenGLVertexArrayObject>
+#include <QVector>
+#include <functional>
+
+class GLStateTracker;
+
+/**
+ * @brief Fixed-function state a draw needs, applied through the GLStateTracker
+ */
+struct DrawState {
+    enum Blending { Opaque = 0, AlphaBlend, Accumulate };
+
+    Blending blending = Opaque;
+    bool depthTest = true;
+    bool depthWrite = true;
+    bool colorWrite = true;
+
+    // Orders draws sharing a program and geometry so state flips back and forth less
+    int sortKey() const {
+        return (int(blending) << 3) | (depthTest << 2) | (depthWrite << 1) | int(colorWrite);
+    }
+};
+
+/**
+ * @brief Draws submitted by one render pass, sorted to minimize state changes
+ *
+ * Items are sorted by layer first, then by program, vertex array and DrawState. Layers
+ * keep an order that matters, e.g. alpha-blended surfaces drawn back to front; items in
+ * the same layer may be reordered freely. flush() binds through the GLStateTracker, so a
+ * program or vertex array shared by consecutive items is bound once, then calls each
+ * item's draw function to set its uniforms and issue one draw call.
+ */
+class RenderQueue {
+   public:
+    struct DrawItem {
+        int layer = 0;
+        QOpenGLShaderProgram* program = nullptr;
+        QOpenGLVertexArrayObject* vertexArray = nullptr;
+        DrawState state;
+        std::function<void()> draw;
+    };
+
+    void submit(const DrawItem& item);
+    bool isEmpty() const {
+        return m_items.isEmpty();
+    }
+
+    // Executes and clears the queue (requires a current OpenGL context)
+    void flush(GLStateTracker& state);
+
+   private:
+    QVector<DrawItem> m_items;
+};
+
+#endif  // RENDERQUEUE_HPP
@@ -0,0 +1,61 @@
+#include "RenderScheduler.hpp"
+
+#include <QDebug>
+
+RenderScheduler::RenderScheduler(QQuickItem* item)
+    : QObject(item), m_item(item), m_framePending(false), m_continuous(false) {}
+
+void RenderScheduler::setWindow(QQuickWindow* window) {
+    if (m_window == window) {
+        return;
+    }
+
+    disconnect(m_syncConnection);
+    disconnect(m_swapConnection);
+    m_window = window;
+    m_framePending = false;
+
+    if (!m_window) {
+        return;
+    }
+
+    // Runs on the render thread while the GUI thread is blocked: the pending frame is
+    // being consumed, so later requests must schedule a new one
+    m_syncConnection = connect(
+        m_window, &QQuickWindow::beforeSynchronizing, this, [this]() { m_framePending = false; },
+        Qt::DirectConnection);
+
+    // Swaps are paced by vsync, which drives the continuous mode
+    m_swapConnection = connect(m_window, &QQuickWindow::frameSwapped, this,
+                               &RenderScheduler::onFrameSwapped, Qt::QueuedConnection);
+
+    requestFrame();
+}
+
+void RenderScheduler::setContinuous(bool continuous) {
+    if (m_continuous == continuous) {
+        return;
+    }
+
+    m_continuous = continuous;
+    qDebug() << "Render scheduler:" << (continuous ? "continuous" : "on demand");
+
+    if (m_continuous) {
+        requestFrame();
+    }
+}
+
+void RenderScheduler::requestFrame() {
+    // Coalesce all changes made before the next frame into a single update
+    if (m_framePending.exchange(true)) {
+        return;
+    }
+
+    m_item->update();
+}
+
+void RenderScheduler::onFrameSwapped() {
+    if (m_continuous) {
+        requestFrame();
+    }
+}
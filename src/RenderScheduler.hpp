@@ -0,0 +1,49 @@
+#ifndef RENDERSCHEDULER_HPP
+#define RENDERSCHEDULER_HPP
+
+#include <QObject>
+#include <QPointer>
+#include <QQuickItem>
+#include <QQuickWindow>
+#include <atomic>
+
+/**
+ * @brief Demand-driven frame scheduler for a QQuickItem-based 3D viewport
+ *
+ * Renders only when state is dirty: any number of requestFrame() calls between two frames
+ * are coalesced into a single update on the next vsync-aligned frame of the scene graph
+ * render loop. In continuous mode a new frame is requested after every swap, so rendering
+ * runs at the display refresh rate instead of a fixed timer.
+ */
+class RenderScheduler : public QObject {
+    Q_OBJECT
+
+   public:
+    explicit RenderScheduler(QQuickItem* item);
+
+    // Window the item is rendered into (frame pacing source)
+    void setWindow(QQuickWindow* window);
+
+    bool isContinuous() const {
+        return m_continuous;
+    }
+    void setContinuous(bool continuous);
+
+   public slots:
+    void requestFrame();
+
+   private slots:
+    void onFrameSwapped();
+
+   private:
+    QQuickItem* m_item;
+    QPointer<QQuickWindow> m_window;
+    QMetaObject::Connection m_syncConnection;
+    QMetaObject::Connection m_swapConnection;
+
+    // Cleared by the render thread when the pending frame is synchronized
+    std::atomic<bool> m_framePending;
+    bool m_continuous;
+};
+
+#endif  // RENDERSCHEDULER_HPP
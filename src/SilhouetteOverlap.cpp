@@ -0,0 +1,237 @@
+#include "SilhouetteOverlap.hpp"
+
+#include <QDebug>
+
+// Desktop occlusion query target (GL 1.5), not in the ES-based function headers
+#ifndef GL_SAMPLES_PASSED
+#define GL_SAMPLES_PASSED 0x8914
+#endif
+
+// Stencil bits of the two silhouettes
+static const GLuint kReferenceBit = 0x1;
+static const GLuint kMovableBit = 0x2;
+
+SilhouetteOverlap::SilhouetteOverlap()
+    : m_initialized(false),
+      m_framebuffer(0),
+      m_stencilBuffer(0),
+      m_previousFramebuffer(0),
+      m_previousViewport{0, 0, 0, 0},
+      m_referenceQuery(0),
+      m_referenceMarked(false),
+      m_referencePending(false),
+      m_referenceSamples(0),
+      m_currentSlot(0),
+      m_oldestSlot(0),
+      m_overlap(-1.0f) {
+    for (Measurement& measurement : m_ring) {
+        measurement.movableQuery = 0;
+        measurement.intersectionQuery = 0;
+        measurement.pending = false;
+    }
+}
+
+SilhouetteOverlap::~SilhouetteOverlap() {
+    if (!m_initialized) {
+        return;
+    }
+
+    destroy();
+    glDeleteQueries(1, &m_referenceQuery);
+    for (Measurement& measurement : m_ring) {
+        glDeleteQueries(1, &measurement.movableQuery);
+        glDeleteQueries(1, &measurement.intersectionQuery);
+    }
+}
+
+bool SilhouetteOverlap::begin(const QSize& size) {
+    if (!m_initialized) {
+        initializeOpenGLFunctions();
+        glGenQueries(1, &m_referenceQuery);
+        for (Measurement& measurement : m_ring) {
+            glGenQueries(1, &measurement.movableQuery);
+            glGenQueries(1, &measurement.intersectionQuery);
+        }
+        m_initialized = true;
+    }
+
+    glGetIntegerv(GL_FRAMEBUFFER_BINDING, &m_previousFramebuffer);
+    if (!resize(size)) {
+        return false;
+    }
+    poll();
+
+    // Stencil only: no color, no depth test, no depth writes. The caller's viewport may sit
+    // inside a larger window target.
+    glGetIntegerv(GL_VIEWPORT, m_previousViewport);
+    glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+    glViewport(0, 0, m_size.width(), m_size.height());
+    glDisable(GL_DEPTH_TEST);
+    glDepthMask(GL_FALSE);
+    glEnable(GL_STENCIL_TEST);
+    return true;
+}
+
+void SilhouetteOverlap::end() {
+    glStencilMask(0xFF);
+    glStencilFunc(GL_ALWAYS, 0, 0xFF);
+    glStencilOp(GL_KEEP, GL_KEEP, GL_KEEP);
+    glDisable(GL_STENCIL_TEST);
+    glDepthMask(GL_TRUE);
+    glEnable(GL_DEPTH_TEST);
+    glBindFramebuffer(GL_FRAMEBUFFER, m_previousFramebuffer);
+    glViewport(m_previousViewport[0], m_previousViewport[1], m_previousViewport[2],
+               m_previousViewport[3]);
+}
+
+void SilhouetteOverlap::beginReference() {
+    // Measurements still in flight were taken against the previous reference
+    for (Measurement& measurement : m_ring) {
+        measurement.pending = false;
+    }
+    m_oldestSlot = m_currentSlot;
+
+    glStencilMask(0xFF);
+    glClear(GL_STENCIL_BUFFER_BIT);
+
+    // Only samples not marked yet pass, and each marks itself
+    glStencilFunc(GL_NOTEQUAL, kReferenceBit, kReferenceBit);
+    glStencilOp(GL_KEEP, GL_KEEP, GL_REPLACE);
+    glStencilMask(kReferenceBit);
+    glBeginQuery(GL_SAMPLES_PASSED, m_referenceQuery);
+}
+
+void SilhouetteOverlap::endReference() {
+    glEndQuery(GL_SAMPLES_PASSED);
+    m_referenceMarked = true;
+    m_referencePending = true;
+}
+
+void SilhouetteOverlap::beginMovable() {
+    // The oldest measurement is dropped when the ring is full
+    Measurement& measurement = m_ring[m_currentSlot];
+    if (measurement.pending) {
+        measurement.pending = false;
+        m_oldestSlot = (m_oldestSlot + 1) % RingSize;
+    }
+
+    // glClear honours the stencil write mask: the reference bit survives
+    glStencilMask(kMovableBit);
+    glClear(GL_STENCIL_BUFFER_BIT);
+
+    glStencilFunc(GL_NOTEQUAL, kMovableBit, kMovableBit);
+    glStencilOp(GL_KEEP, GL_KEEP, GL_REPLACE);
+    glBeginQuery(GL_SAMPLES_PASSED, measurement.movableQuery);
+}
+
+void SilhouetteOverlap::endMovable() {
+    glEndQuery(GL_SAMPLES_PASSED);
+}
+
+void SilhouetteOverlap::beginIntersection() {
+    glStencilFunc(GL_EQUAL, kReferenceBit | kMovableBit, kReferenceBit | kMovableBit);
+    glStencilOp(GL_KEEP, GL_KEEP, GL_KEEP);
+    glStencilMask(0);
+    glBeginQuery(GL_SAMPLES_PASSED, m_ring[m_currentSlot].intersectionQuery);
+}
+
+void SilhouetteOverlap::endIntersection() {
+    glEndQuery(GL_SAMPLES_PASSED);
+    m_ring[m_currentSlot].pending = true;
+    m_currentSlot = (m_currentSlot + 1) % RingSize;
+}
+
+bool SilhouetteOverlap::pending() const {
+    for (const Measurement& measurement : m_ring) {
+        if (measurement.pending) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void SilhouetteOverlap::poll() {
+    // Every measurement needs the reference count first
+    if (m_referencePending) {
+        GLuint available = 0;
+        glGetQueryObjectuiv(m_referenceQuery, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (!available) {
+            return;
+        }
+        glGetQueryObjectuiv(m_referenceQuery, GL_QUERY_RESULT, &m_referenceSamples);
+        m_referencePending = false;
+    }
+
+    // Oldest first, stopping at the first one still in flight
+    while (m_ring[m_oldestSlot].pending) {
+        Measurement& measurement = m_ring[m_oldestSlot];
+        GLuint available = 0;
+        glGetQueryObjectuiv(measurement.intersectionQuery, GL_QUERY_RESULT_AVAILABLE, &available);
+        if (available) {
+            glGetQueryObjectuiv(measurement.movableQuery, GL_QUERY_RESULT_AVAILABLE, &available);
+        }
+        if (!available) {
+            return;
+        }
+
+        GLuint movableSamples = 0;
+        GLuint intersectionSamples = 0;
+        glGetQueryObjectuiv(measurement.movableQuery, GL_QUERY_RESULT, &movableSamples);
+        glGetQueryObjectuiv(measurement.intersectionQuery, GL_QUERY_RESULT, &intersectionSamples);
+        measurement.pending = false;
+        m_oldestSlot = (m_oldestSlot + 1) % RingSize;
+
+        double unionSamples = double(m_referenceSamples) + movableSamples - intersectionSamples;
+        m_overlap = unionSamples > 0.0 ? float(intersectionSamples / unionSamples) : 0.0f;
+    }
+}
+
+bool SilhouetteOverlap::resize(const QSize& size) {
+    if (m_framebuffer && m_size == size) {
+        return true;
+    }
+
+    destroy();
+    m_referenceMarked = false;
+    if (size.isEmpty()) {
+        return false;
+    }
+    m_size = size;
+
+    glGenRenderbuffers(1, &m_stencilBuffer);
+    glBindRenderbuffer(GL_RENDERBUFFER, m_stencilBuffer);
+    glRenderbufferStorage(GL_RENDERBUFFER, GL_DEPTH24_STENCIL8, size.width(), size.height());
+    glBindRenderbuffer(GL_RENDERBUFFER, 0);
+
+    glGenFramebuffers(1, &m_framebuffer);
+    glBindFramebuffer(GL_FRAMEBUFFER, m_framebuffer);
+    glFramebufferRenderbuffer(GL_FRAMEBUFFER, GL_DEPTH_STENCIL_ATTACHMENT, GL_RENDERBUFFER,
+                              m_stencilBuffer);
+
+    // No color attachment at all
+    const GLenum noDrawBuffer = GL_NONE;
+    glDrawBuffers(1, &noDrawBuffer);
+    glReadBuffer(GL_NONE);
+
+    GLenum status = glCheckFramebufferStatus(GL_FRAMEBUFFER);
+    glBindFramebuffer(GL_FRAMEBUFFER, m_previousFramebuffer);
+
+    if (status != GL_FRAMEBUFFER_COMPLETE) {
+        qDebug() << "ERROR: Silhouette framebuffer incomplete, status" << Qt::hex << status;
+        destroy();
+        return false;
+    }
+    return true;
+}
+
+void SilhouetteOverlap::destroy() {
+    if (m_framebuffer) {
+        glDeleteFramebuffers(1, &m_framebuffer);
+    }
+    if (m_stencilBuffer) {
+        glDeleteRenderbuffers(1, &m_stencilBuffer);
+    }
+    m_framebuffer = 0;
+    m_stencilBuffer = 0;
+    m_size = QSize();
+}
@@ -0,0 +1,86 @@
+#ifndef SILHOUETTEOVERLAP_HPP
+#define SILHOUETTEOVERLAP_HPP
+
+#include <QOpenGLExtraFunctions>
+#include <QSize>
+
+/**
+ * @brief Image-space intersection over union of the reference and movable silhouettes
+ *
+ * Silhouettes are marked in a private stencil-only framebuffer: bit 0 for the reference,
+ * bit 1 for the movable model. Each bit's pass only lets through samples not yet marked,
+ * so a GL_SAMPLES_PASSED query counts each covered sample exactly once regardless of
+ * overdraw. A fullscreen pass tested against both bits counts the intersection.
+ *
+ * The reference never moves, so its bit and sample count are kept until invalidated.
+ * Query results are polled a frame or more later from a small ring and never waited on.
+ */
+class SilhouetteOverlap : protected QOpenGLExtraFunctions {
+   public:
+    SilhouetteOverlap();
+    ~SilhouetteOverlap();
+
+    // Binds the stencil target at the given size and collects finished results. Returns
+    // false when no target is available (requires a current OpenGL context).
+    bool begin(const QSize& size);
+    // Restores the default stencil and mask state and the caller's framebuffer and viewport
+    void end();
+
+    // Reference silhouette, drawn again only after invalidateReference() or a resize
+    bool needsReference() const {
+        return !m_referenceMarked;
+    }
+    void invalidateReference() {
+        m_referenceMarked = false;
+    }
+    void beginReference();
+    void endReference();
+
+    // Movable silhouette and the fullscreen intersection pass of one measurement
+    void beginMovable();
+    void endMovable();
+    void beginIntersection();
+    void endIntersection();
+
+    // Latest intersection over union in [0, 1], or -1 before the first result
+    float overlap() const {
+        return m_overlap;
+    }
+    // True while issued measurements have not been collected yet
+    bool pending() const;
+
+    // Non-blocking collection of finished measurements
+    void poll();
+
+   private:
+    static const int RingSize = 3;
+
+    struct Measurement {
+        GLuint movableQuery;
+        GLuint intersectionQuery;
+        bool pending;
+    };
+
+    bool resize(const QSize& size);
+    void destroy();
+
+    bool m_initialized;
+    QSize m_size;
+    GLuint m_framebuffer;
+    GLuint m_stencilBuffer;
+    GLint m_previousFramebuffer;
+    GLint m_previousViewport[4];
+
+    // Reference sample count, measured once per reference silhouette
+    GLuint m_referenceQuery;
+    bool m_referenceMarked;
+    bool m_referencePending;
+    GLuint m_referenceSamples;
+
+    Measurement m_ring[RingSize];
+    int m_currentSlot;
+    int m_oldestSlot;
+    float m_overlap;
+};
+
+#endif  // SILHOUETTEOVERLAP_HPP
@@ -0,0 +1,327 @@
+#include "StlFile.hpp"
+
+#include <QDebug>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QVector>
+#include <QtConcurrent>
+#include <QtEndian>
+#include <atomic>
+#include <climits>
+#include <cmath>
+#include <cstring>
+
+#include "CompactVertexFormat.hpp"
+#include "MeshData.hpp"
+
+// 80 byte header followed by the little-endian triangle count
+static const int kHeaderSize = 84;
+// Face normal, three corners (12 floats) and a 16 bit attribute word
+static const int kRecordSize = 50;
+// Triangles per worker task
+static const int kRangeSize = 1 << 16;
+
+// Triangles handled by one worker task, and what it measured
+struct StlRange {
+    int first = 0;
+    int count = 0;
+    float minimum[3];
+    float maximum[3];
+    float radiusSquared = 0.0f;
+};
+
+static QVector<StlRange> splitTriangles(int triangleCount) {
+    QVector<StlRange> ranges;
+    for (int first = 0; first < triangleCount; first += kRangeSize) {
+        StlRange range;
+        range.first = first;
+        range.count = qMin(kRangeSize, triangleCount - first);
+        ranges.append(range);
+    }
+    return ranges;
+}
+
+// Corner positions of one record (the stored normal is recomputed from them)
+static inline void readCorners(const uchar* record, float corners[9]) {
+    qFromLittleEndian<float>(record + 12, 9, corners);
+}
+
+// Unit face normal from the winding, or the stored normal for degenerate triangles
+static inline void faceNormal(const uchar* record, const float corners[9], float normal[3]) {
+    const float e1[3] = {corners[3] - corners[0], corners[4] - corners[1],
+                         corners[5] - corners[2]};
+    const float e2[3] = {corners[6] - corners[0], corners[7] - corners[1],
+                         corners[8] - corners[2]};
+    normal[0] = e1[1] * e2[2] - e1[2] * e2[1];
+    normal[1] = e1[2] * e2[0] - e1[0] * e2[2];
+    normal[2] = e1[0] * e2[1] - e1[1] * e2[0];
+
+    float length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+    if (!(length > 0.0f)) {
+        qFromLittleEndian<float>(record, 3, normal);
+        length = std::sqrt(normal[0] * normal[0] + normal[1] * normal[1] + normal[2] * normal[2]);
+    }
+    if (length > 0.0f) {
+        normal[0] /= length;
+        normal[1] /= length;
+        normal[2] /= length;
+    }
+}
+
+// Welding key: the bit pattern of a corner, with -0 folded into +0
+struct StlVertexKey {
+    quint32 bits[3];
+
+    explicit StlVertexKey(const float* position) {
+        for (int axis = 0; axis < 3; ++axis) {
+            float value = position[axis] + 0.0f;
+            std::memcpy(&bits[axis], &value, sizeof(float));
+        }
+    }
+    bool operator==(const StlVertexKey& other) const {
+        return bits[0] == other.bits[0] && bits[1] == other.bits[1] && bits[2] == other.bits[2];
+    }
+};
+
+static inline size_t qHash(const StlVertexKey& key, size_t seed = 0) {
+    return qHashMulti(seed, key.bits[0], key.bits[1], key.bits[2]);
+}
+
+StlFile::StlFile()
+    : m_mapping(nullptr), m_records(nullptr), m_triangleCount(0), m_radius(0.0f), m_scale(1.0f) {
+    for (int axis = 0; axis < 3; ++axis) {
+        m_minimum[axis] = 0.0f;
+        m_maximum[axis] = 0.0f;
+    }
+}
+
+StlFile::~StlFile() {
+    close();
+}
+
+bool StlFile::open(const QString& filePath, QString* errorMessage,
+                   const ProgressCallback& progress) {
+    QElapsedTimer timer;
+    timer.start();
+
+    close();
+    auto fail = [&](const QString& message) {
+        qDebug() << "ERROR:" << message;
+        if (errorMessage) {
+            *errorMessage = message;
+        }
+        close();
+        return false;
+    };
+
+    m_file.setFileName(filePath);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        return fail(QStringLiteral("Cannot open %1: %2").arg(filePath, m_file.errorString()));
+    }
+    const qint64 size = m_file.size();
+    if (size == 0) {
+        return fail(QStringLiteral("%1 is empty").arg(filePath));
+    }
+    m_mapping = m_file.map(0, size);
+    if (!m_mapping) {
+        return fail(QStringLiteral("Cannot map %1: %2").arg(filePath, m_file.errorString()));
+    }
+
+    // The size check tells binary files from ASCII ones, which may also start with "solid"
+    const quint32 count = size >= kHeaderSize ? qFromLittleEndian<quint32>(m_mapping + 80) : 0;
+    if (size < kHeaderSize || size != kHeaderSize + qint64(count) * kRecordSize) {
+        if (size >= 5 && std::memcmp(m_mapping, "solid", 5) == 0) {
+            return fail(QStringLiteral("%1 is an ASCII STL file, only binary STL is supported")
+                            .arg(filePath));
+        }
+        return fail(QStringLiteral("%1 is truncated or not an STL file").arg(filePath));
+    }
+    if (count == 0) {
+        return fail(QStringLiteral("%1 has no triangles").arg(filePath));
+    }
+    if (count > quint32(INT_MAX / 9)) {
+        return fail(QStringLiteral("%1 has too many triangles").arg(filePath));
+    }
+    m_records = m_mapping + kHeaderSize;
+    m_triangleCount = int(count);
+
+    // Two read-only passes over the mapping: bounding box, then the radius around its
+    // center. The first one pulls the file from disk.
+    QVector<StlRange> ranges = splitTriangles(m_triangleCount);
+    std::atomic<qint64> trianglesDone(0);
+    std::atomic<bool> cancelled(false);
+    auto report = [&](int triangles) {
+        qint64 done = trianglesDone += triangles;
+        if (progress && !progress(0.5 * double(done) / m_triangleCount)) {
+            cancelled = true;
+        }
+    };
+
+    QtConcurrent::blockingMap(ranges, [&](StlRange& range) {
+        if (cancelled) {
+            return;
+        }
+        float corners[9];
+        readCorners(m_records + qint64(range.first) * kRecordSize, corners);
+        for (int axis = 0; axis < 3; ++axis) {
+            range.minimum[axis] = corners[axis];
+            range.maximum[axis] = corners[axis];
+        }
+        for (int triangle = range.first; triangle < range.first + range.count; ++triangle) {
+            readCorners(m_records + qint64(triangle) * kRecordSize, corners);
+            for (int corner = 0; corner < 9; corner += 3) {
+                for (int axis = 0; axis < 3; ++axis) {
+                    range.minimum[axis] = qMin(range.minimum[axis], corners[corner + axis]);
+                    range.maximum[axis] = qMax(range.maximum[axis], corners[corner + axis]);
+                }
+            }
+        }
+        report(range.count);
+    });
+    if (cancelled) {
+        return fail(QStringLiteral("Loading cancelled"));
+    }
+    for (int axis = 0; axis < 3; ++axis) {
+        m_minimum[axis] = ranges[0].minimum[axis];
+        m_maximum[axis] = ranges[0].maximum[axis];
+        for (const StlRange& range : ranges) {
+            m_minimum[axis] = qMin(m_minimum[axis], range.minimum[axis]);
+            m_maximum[axis] = qMax(m_maximum[axis], range.maximum[axis]);
+        }
+    }
+    if (!std::isfinite(m_minimum[0] + m_minimum[1] + m_minimum[2] + m_maximum[0] +
+                       m_maximum[1] + m_maximum[2])) {
+        return fail(QStringLiteral("%1 has invalid coordinates").arg(filePath));
+    }
+
+    const float center[3] = {(m_minimum[0] + m_maximum[0]) * 0.5f,
+                             (m_minimum[1] + m_maximum[1]) * 0.5f,
+                             (m_minimum[2] + m_maximum[2]) * 0.5f};
+    QtConcurrent::blockingMap(ranges, [&](StlRange& range) {
+        if (cancelled) {
+            return;
+        }
+        float corners[9];
+        for (int triangle = range.first; triangle < range.first + range.count; ++triangle) {
+            readCorners(m_records + qint64(triangle) * kRecordSize, corners);
+            for (int corner = 0; corner < 9; corner += 3) {
+                const float dx = corners[corner] - center[0];
+                const float dy = corners[corner + 1] - center[1];
+                const float dz = corners[corner + 2] - center[2];
+                range.radiusSquared = qMax(range.radiusSquared, dx * dx + dy * dy + dz * dz);
+            }
+        }
+        report(range.count);
+    });
+    if (cancelled) {
+        return fail(QStringLiteral("Loading cancelled"));
+    }
+    float radiusSquared = 0.0f;
+    for (const StlRange& range : ranges) {
+        radiusSquared = qMax(radiusSquared, range.radiusSquared);
+    }
+    m_radius = std::sqrt(radiusSquared);
+    m_scale = 1.0f;
+
+    if (progress) {
+        progress(1.0);
+    }
+    qDebug() << "STL mapped - Triangles:" << m_triangleCount << "in" << timer.elapsed() << "ms";
+    return true;
+}
+
+void StlFile::close() {
+    if (m_mapping) {
+        m_file.unmap(m_mapping);
+        m_mapping = nullptr;
+    }
+    m_file.close();
+    m_records = nullptr;
+    m_triangleCount = 0;
+}
+
+void StlFile::normalize(float radius) {
+    m_scale = m_radius > 0.0f ? radius / m_radius : 1.0f;
+}
+
+void StlFile::bounds(float minimum[3], float maximum[3]) const {
+    for (int axis = 0; axis < 3; ++axis) {
+        const float halfExtent = (m_maximum[axis] - m_minimum[axis]) * 0.5f * m_scale;
+        minimum[axis] = -halfExtent;
+        maximum[axis] = halfExtent;
+    }
+}
+
+void StlFile::writeVertices(uchar* vertices) const {
+    if (!isOpen()) {
+        return;
+    }
+
+    const float center[3] = {(m_minimum[0] + m_maximum[0]) * 0.5f,
+                             (m_minimum[1] + m_maximum[1]) * 0.5f,
+                             (m_minimum[2] + m_maximum[2]) * 0.5f};
+    const float scale = m_scale;
+    const CompactVertexFormat::Positions format = CompactVertexFormat::FloatPositions;
+    const int stride = CompactVertexFormat::stride(format);
+
+    // Every range writes its own part of the output, straight from the mapped records.
+    // Writes only, in order, which suits write-combined buffer mappings.
+    QVector<StlRange> ranges = splitTriangles(m_triangleCount);
+    QtConcurrent::blockingMap(ranges, [&](StlRange& range) {
+        uchar* vertex = vertices + qint64(range.first) * 3 * stride;
+        float corners[9];
+        float face[3];
+        for (int triangle = range.first; triangle < range.first + range.count; ++triangle) {
+            const uchar* record = m_records + qint64(triangle) * kRecordSize;
+            readCorners(record, corners);
+            faceNormal(record, corners, face);
+            for (int corner = 0; corner < 9; corner += 3, vertex += stride) {
+                const float position[3] = {(corners[corner] - center[0]) * scale,
+                                           (corners[corner + 1] - center[1]) * scale,
+                                           (corners[corner + 2] - center[2]) * scale};
+                CompactVertexFormat::packVertex(format, position, face, vertex);
+            }
+        }
+    });
+}
+
+void StlFile::weld(MeshData& mesh) const {
+    mesh = MeshData();
+    if (!isOpen()) {
+        return;
+    }
+
+    QElapsedTimer timer;
+    timer.start();
+
+    const float center[3] = {(m_minimum[0] + m_maximum[0]) * 0.5f,
+                             (m_minimum[1] + m_maximum[1]) * 0.5f,
+                             (m_minimum[2] + m_maximum[2]) * 0.5f};
+
+    // Closed meshes have about half as many vertices as triangles
+    QHash<StlVertexKey, unsigned int> vertices;
+    vertices.reserve(m_triangleCount / 2 + 1);
+    mesh.positions.reserve((m_triangleCount / 2 + 1) * 3);
+    mesh.indices.resize(vertexCount());
+
+    float corners[9];
+    unsigned int* index = mesh.indices.data();
+    for (int triangle = 0; triangle < m_triangleCount; ++triangle) {
+        readCorners(m_records + qint64(triangle) * kRecordSize, corners);
+        for (int corner = 0; corner < 9; corner += 3) {
+            const StlVertexKey key(corners + corner);
+            auto it = vertices.constFind(key);
+            if (it == vertices.constEnd()) {
+                it = vertices.insert(key, unsigned(mesh.vertexCount()));
+                mesh.positions.append((corners[corner] - center[0]) * m_scale);
+                mesh.positions.append((corners[corner + 1] - center[1]) * m_scale);
+                mesh.positions.append((corners[corner + 2] - center[2]) * m_scale);
+            }
+            *index++ = it.value();
+        }
+    }
+    mesh.computeNormals();
+
+    qDebug() << "STL welded - Vertices:" << mesh.vertexCount() << "of" << vertexCount()
+             << "corners in" << timer.elapsed() << "ms";
+}
@@ -0,0 +1,73 @@
+#ifndef STLFILE_HPP
+#define STLFILE_HPP
+
+#include <QFile>
+#include <QString>
+#include <functional>
+
+struct MeshData;
+
+/**
+ * @brief Memory-mapped binary STL model, expanded straight into GPU memory
+ *
+ * Binary STL stores every triangle as a fixed 50 byte record (face normal, three corners,
+ * attribute word), so the file is used in place: open() maps it, checks its size against
+ * the triangle count and measures its bounds, and writeVertices() expands the records into
+ * caller memory, normally a mapped vertex buffer (ModelMesh). No copy of the model is kept
+ * on the heap, and the mapping only holds clean page cache.
+ *
+ * Corners are not shared between triangles, which gives flat shading. weld() builds an
+ * indexed MeshData with coincident corners merged and smooth normals instead, at the cost
+ * of a CPU-side copy.
+ *
+ * Vertices are centered on the bounding box and scaled by normalize() as they are written;
+ * the mapped file is never modified.
+ */
+class StlFile {
+   public:
+    // Receives the fraction of the file processed so far from worker threads. Returning
+    // false cancels open().
+    using ProgressCallback = std::function<bool(double)>;
+
+    StlFile();
+    ~StlFile();
+
+    // Maps a binary STL file (errorMessage, if given, receives the reason of a failure)
+    bool open(const QString& filePath, QString* errorMessage = nullptr,
+              const ProgressCallback& progress = ProgressCallback());
+    void close();
+    bool isOpen() const {
+        return m_records != nullptr;
+    }
+
+    int triangleCount() const {
+        return m_triangleCount;
+    }
+    int vertexCount() const {
+        return m_triangleCount * 3;
+    }
+
+    // Scales written vertices into a sphere of radius around the bounding box center
+    void normalize(float radius = 1.0f);
+    // Axis-aligned bounds of the written vertices
+    void bounds(float minimum[3], float maximum[3]) const;
+
+    // Three corners per triangle, in file order, each with the face normal, written on all
+    // cores as CompactVertexFormat vertices with float positions
+    void writeVertices(uchar* vertices) const;
+
+    // Indexed copy with bit-identical corners merged into one vertex
+    void weld(MeshData& mesh) const;
+
+   private:
+    QFile m_file;
+    uchar* m_mapping;
+    const uchar* m_records;  // First triangle record inside the mapping
+    int m_triangleCount;
+    float m_minimum[3];  // Bounds as stored in the file
+    float m_maximum[3];
+    float m_radius;  // Bounding sphere around the box center, as stored in the file
+    float m_scale;
+};
+
+#endif  // STLFILE_HPP
@@ -0,0 +1,57 @@
+#ifndef TRIPLEBUFFER_HPP
+#define TRIPLEBUFFER_HPP
+
+#include <atomic>
+
+/**
+ * @brief Lock-free single-producer, single-consumer latest-value exchange
+ *
+ * Three slots: the producer owns one to write into, the consumer owns one to read from,
+ * and the third is handed between them through an atomic index. Publishing swaps the
+ * written slot into the middle, consuming swaps the middle out for reading, so neither
+ * side ever waits and the consumer always gets the most recently published value.
+ * Values published in between are overwritten, which is what a state snapshot wants.
+ */
+template <typename T>
+class TripleBuffer {
+   public:
+    TripleBuffer() : m_writeIndex(0), m_middle(1), m_readIndex(2) {}
+
+    // Producer side: fill writeBuffer(), then publish() it
+    T& writeBuffer() {
+        return m_slots[m_writeIndex];
+    }
+    void publish() {
+        int previous = m_middle.exchange(m_writeIndex | kFresh, std::memory_order_acq_rel);
+        m_writeIndex = previous & kIndexMask;
+    }
+    void publish(const T& value) {
+        writeBuffer() = value;
+        publish();
+    }
+
+    // Consumer side: switches readBuffer() to the latest published value, returns false
+    // (keeping the current one) when nothing was published since the last call
+    bool consume() {
+        if (!(m_middle.load(std::memory_order_relaxed) & kFresh)) {
+            return false;
+        }
+        int previous = m_middle.exchange(m_readIndex, std::memory_order_acq_rel);
+        m_readIndex = previous & kIndexMask;
+        return true;
+    }
+    const T& readBuffer() const {
+        return m_slots[m_readIndex];
+    }
+
+   private:
+    static const int kIndexMask = 0x3;
+    static const int kFresh = 0x4;  // Middle slot holds an unconsumed value
+
+    T m_slots[3];
+    int m_writeIndex;           // Producer only
+    std::atomic<int> m_middle;  // Slot index plus kFresh
+    int m_readIndex;            // Consumer only
+};
+
+#endif  // TRIPLEBUFFER_HPP
@@ -0,0 +1,27 @@
+#ifndef VERTEXLAYOUT_HPP
+#define VERTEXLAYOUT_HPP
+
+#include <QVector>
+#include <QtGlobal>
+#include <qopengl.h>
+
+/**
+ * @brief Where one vertex attribute of a model vertex buffer lives, and in what format
+ *
+ * Plain fixed-size fields, so the same struct is stored in mesh cache files
+ * (MeshCacheFile) and handed to glVertexAttribPointer() by ModelMesh.
+ */
+struct VertexAttribute {
+    quint32 location;    // Vertex shader input
+    quint32 components;  // Per vertex
+    quint32 type;        // OpenGL component type, e.g. GL_FLOAT
+    quint32 normalized;  // Integer components mapped to [0, 1] or [-1, 1]
+    quint64 offset;      // Of the first vertex in the buffer, in bytes
+    quint32 stride;      // Between consecutive vertices, in bytes
+    quint32 reserved;
+};
+Q_STATIC_ASSERT(sizeof(VertexAttribute) == 32);
+
+using VertexLayout = QVector<VertexAttribute>;
+
+#endif  // VERTEXLAYOUT_HPP
@@ -0,0 +1,136 @@
+#include "VideoEncoder.hpp"
+
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <cmath>
+#include <opencv2/imgcodecs.hpp>
+#include <opencv2/imgproc.hpp>
+#include <opencv2/videoio.hpp>
+
+// Longest gap (in seconds) filled by repeating the previous frame
+static const double kMaxRepeatSeconds = 2.0;
+
+VideoEncoder::VideoEncoder(const QString& path, double framesPerSecond, int queueCapacity)
+    : m_path(path),
+      m_framesPerSecond(framesPerSecond),
+      m_queueCapacity(queueCapacity),
+      m_finishing(false),
+      m_writer(nullptr),
+      m_outputFailed(false),
+      m_writtenFrames(0),
+      m_droppedFrames(0) {
+    QString suffix = QFileInfo(path).suffix().toLower();
+    m_imageSequence = suffix != "avi" && suffix != "mp4";
+}
+
+VideoEncoder::~VideoEncoder() {
+    finish();
+    wait();
+    delete m_writer;
+}
+
+bool VideoEncoder::enqueue(const cv::Mat& frame, qint64 timestampMs) {
+    QMutexLocker locker(&m_mutex);
+    if (m_finishing || m_queue.size() >= m_queueCapacity) {
+        ++m_droppedFrames;
+        return false;
+    }
+
+    m_queue.enqueue({frame, timestampMs});
+    m_frameAvailable.wakeOne();
+    return true;
+}
+
+void VideoEncoder::finish() {
+    QMutexLocker locker(&m_mutex);
+    m_finishing = true;
+    m_frameAvailable.wakeOne();
+}
+
+void VideoEncoder::run() {
+    int outputFrames = 0;  // Frames on the output timeline, including repeats
+
+    while (true) {
+        QueuedFrame frame;
+        {
+            QMutexLocker locker(&m_mutex);
+            while (m_queue.isEmpty() && !m_finishing) {
+                m_frameAvailable.wait(&m_mutex);
+            }
+            if (m_queue.isEmpty()) {
+                break;  // Finishing and drained
+            }
+            frame = m_queue.dequeue();
+        }
+
+        // OpenGL rows are bottom-up RGBA; the writers expect top-down BGR
+        cv::Mat bgr;
+        cv::cvtColor(frame.image, bgr, cv::COLOR_RGBA2BGR);
+        cv::flip(bgr, frame.image, 0);
+
+        // The output is created with the size of the first frame
+        if (m_frameSize.empty()) {
+            m_frameSize = frame.image.size();
+            if (m_imageSequence) {
+                QDir().mkpath(m_path);
+            } else {
+                openOutput(m_frameSize);
+            }
+        }
+        if (m_outputFailed) {
+            ++m_droppedFrames;
+            continue;
+        }
+
+        // Keep the output at wall-clock speed: repeat the frame until the timeline catches up
+        int targetIndex = int(std::lround(frame.timestampMs * m_framesPerSecond / 1000.0));
+        int repeats = qBound(1, targetIndex - outputFrames + 1,
+                             int(kMaxRepeatSeconds * m_framesPerSecond));
+
+        // Later frames are resized if the render size changes mid-session
+        cv::Mat image = frame.image;
+        if (image.size() != m_frameSize) {
+            cv::resize(frame.image, image, m_frameSize);
+        }
+
+        if (m_imageSequence) {
+            writeFrame(image);  // Image sequences keep one file per captured frame
+        } else {
+            for (int i = 0; i < repeats; ++i) {
+                writeFrame(image);
+            }
+        }
+        outputFrames += repeats;
+    }
+
+    if (m_writer) {
+        m_writer->release();
+    }
+    qDebug() << "Capture finished:" << m_path << "-" << int(m_writtenFrames) << "frames written,"
+             << int(m_droppedFrames) << "dropped by the encoder";
+}
+
+void VideoEncoder::openOutput(const cv::Size& frameSize) {
+    QString suffix = QFileInfo(m_path).suffix().toLower();
+    int fourcc = suffix == "mp4" ? cv::VideoWriter::fourcc('m', 'p', '4', 'v')
+                                 : cv::VideoWriter::fourcc('M', 'J', 'P', 'G');
+
+    QDir().mkpath(QFileInfo(m_path).absolutePath());
+    m_writer = new cv::VideoWriter(m_path.toStdString(), fourcc, m_framesPerSecond, frameSize);
+    if (!m_writer->isOpened()) {
+        qWarning() << "Failed to open video output:" << m_path;
+        m_outputFailed = true;
+    }
+}
+
+void VideoEncoder::writeFrame(const cv::Mat& image) {
+    if (m_imageSequence) {
+        QString fileName = QString("frame_%1.png").arg(int(m_writtenFrames), 6, 10, QChar('0'));
+        cv::imwrite(QDir(m_path).filePath(fileName).toStdString(), image);
+    } else {
+        m_writer->write(image);
+    }
+    ++m_writtenFrames;
+}
@@ -0,0 +1,77 @@
+#ifndef VIDEOENCODER_HPP
+#define VIDEOENCODER_HPP
+
+#include <QMutex>
+#include <QQueue>
+#include <QString>
+#include <QThread>
+#include <QWaitCondition>
+#include <atomic>
+#include <opencv2/core.hpp>
+
+namespace cv {
+class VideoWriter;
+}
+
+/**
+ * @brief Worker thread writing captured frames to a video file or an image sequence
+ *
+ * Frames are handed over through a bounded queue; when the encoder falls behind, new
+ * frames are dropped instead of blocking the render thread. The color conversion and the
+ * vertical flip of the OpenGL rows happen here, off the render thread. Each frame carries
+ * its capture time and is repeated as needed so the output plays back at wall-clock speed.
+ * Paths ending in .avi (MJPG) or .mp4 (mp4v) produce a video, any other path is treated as
+ * a directory of numbered PNG images.
+ */
+class VideoEncoder : public QThread {
+    Q_OBJECT
+
+   public:
+    VideoEncoder(const QString& path, double framesPerSecond, int queueCapacity = 8);
+    ~VideoEncoder();
+
+    // Takes ownership of a frame as read back from OpenGL (bottom-up RGBA), which is
+    // converted on the encoder thread; false when the queue is full (frame dropped)
+    bool enqueue(const cv::Mat& frame, qint64 timestampMs);
+
+    // Writes what is queued, closes the output and ends the thread
+    void finish();
+
+    int writtenFrames() const {
+        return m_writtenFrames;
+    }
+    int droppedFrames() const {
+        return m_droppedFrames;
+    }
+
+   protected:
+    void run() override;
+
+   private:
+    struct QueuedFrame {
+        cv::Mat image;
+        qint64 timestampMs;
+    };
+
+    void openOutput(const cv::Size& frameSize);
+    void writeFrame(const cv::Mat& image);
+
+    QString m_path;
+    double m_framesPerSecond;
+    int m_queueCapacity;
+    bool m_imageSequence;
+
+    QMutex m_mutex;
+    QWaitCondition m_frameAvailable;
+    QQueue<QueuedFrame> m_queue;
+    bool m_finishing;
+
+    // Encoder thread state
+    cv::VideoWriter* m_writer;
+    cv::Size m_frameSize;
+    bool m_outputFailed;
+    std::atomic<int> m_writtenFrames;
+    std::atomic<int> m_droppedFrames;
+};
+
+#endif  // VIDEOENCODER_HPP
@@ -5,9 +5,13 @@
 #include <QQmlApplicationEngine>
 #include <iostream>
 
+#include "OpenGL3DDirectViewport.hpp"
 #include "OpenGL3DViewport.hpp"
 
 int main(int argc, char* argv[]) {
+    // One OpenGL context group for all windows, so every viewport shares the programs,
+    // meshes and glyphs in the GpuResourceCache (must be set before the application)
+    QCoreApplication::setAttribute(Qt::AA_ShareOpenGLContexts);
     QGuiApplication app(argc, argv);
 
     // Set application information
@@ -17,8 +21,9 @@ int main(int argc, char* argv[]) {
 
     std::cout << "SURGAR Manual Registration Simulator V2 - Starting..." << std::endl;
 
-    // Register the 3D viewport component
+    // Register the 3D viewport components (framebuffer object and direct window rendering)
     qmlRegisterType<OpenGL3DViewport>("SURGAR.Components", 1, 0, "OpenGL3DViewport");
+    qmlRegisterType<OpenGL3DDirectViewport>("SURGAR.Components", 1, 0, "OpenGL3DDirectViewport");
 
     // Initialize QML engine
     QQmlApplicationEngine engine;
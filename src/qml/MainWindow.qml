@@ -1,4 +1,5 @@
 import QtQuick 2.15
+import QtQuick.Dialogs
 import SURGAR.Components 1.0
 
 // =================================================================
@@ -8,7 +9,8 @@ import SURGAR.Components 1.0
 // Layout: 25% left panel + 50% 3D viewport + 25% right panel
 Rectangle {
     id: mainWindow
-    color: "#F8F9FA"
+    // A direct viewport draws underneath: nothing below it may be opaque
+    color: viewport3D.directRendering ? "transparent" : "#F8F9FA"
 
     // 3D Viewport reference for easy access throughout the interface
     property alias viewport3D: viewport3D
@@ -124,16 +126,35 @@ Rectangle {
                             }
                         }
 
-                        // Load Custom Model Option
+                        // Load Custom Model Option (parsed in the background, shown as
+                        // shape 5 once loaded)
                         Rectangle {
                             width: parent.width
                             height: 32
                             color: "#607D8B"
                             radius: 6
+                            clip: true
+
+                            // Load progress fill
+                            Rectangle {
+                                anchors.left: parent.left
+                                anchors.top: parent.top
+                                anchors.bottom: parent.bottom
+                                width: parent.width * viewport3D.modelLoadProgress
+                                visible: viewport3D.modelLoading
+                                color: "#4A90E2"
+                                radius: 6
+                            }
 
                             Text {
                                 anchors.centerIn: parent
-                                text: "Load Custom Model..."
+                                width: parent.width - 12
+                                horizontalAlignment: Text.AlignHCenter
+                                elide: Text.ElideMiddle
+                                text: viewport3D.modelLoading
+                                      ? "Loading... " + Math.round(viewport3D.modelLoadProgress * 100) + "%"
+                                      : (viewport3D.modelName !== "" ? viewport3D.modelName
+                                                                     : "Load Custom Model...")
                                 color: "#FFFFFF"
                                 font.pixelSize: 12
                                 font.family: "Arial"
@@ -141,7 +162,8 @@ Rectangle {
 
                             MouseArea {
                                 anchors.fill: parent
-                                onClicked: console.log("Load model clicked")
+                                enabled: !viewport3D.modelLoading
+                                onClicked: modelFileDialog.open()
                             }
                         }
                     }
@@ -395,7 +417,7 @@ Rectangle {
         Rectangle {
             width: parent.width * 0.5
             height: parent.height
-            color: "#F5F5F5"
+            color: viewport3D.directRendering ? "transparent" : "#F5F5F5"
             border.color: "#E1E5E9"
             border.width: 2
             radius: 8
@@ -403,7 +425,9 @@ Rectangle {
             // -----------------------------------------------------
             // 3D OPENGL VIEWPORT COMPONENT
             // -----------------------------------------------------
-            // Main 3D rendering area with dual model display
+            // Main 3D rendering area with dual model display. OpenGL3DDirectViewport takes
+            // the same settings and renders straight into the window instead of a
+            // framebuffer object (for latency and GPU cost comparisons).
             OpenGL3DViewport {
                 id: viewport3D
                 anchors.fill: parent
@@ -419,6 +443,8 @@ Rectangle {
                 showReferenceModel: true   // Show semi-transparent reference
                 showMovableModel: true     // Show user-controlled model
                 showVertexLabels: true     // Show alignment markers
+                edgeWidth: 4.0             // Movable model edge width in pixels
+                orderIndependentTransparency: true  // Draw-order independent overlap
 
                 // Connect transform changes to update right panel displays
                 onTransformChanged: {
@@ -713,7 +739,7 @@ Rectangle {
                 // Start/finish tasks, view current mode, accuracy display
                 Rectangle {
                     width: parent.width
-                    height: 220
+                    height: 235
                     color: "#FFFFFF"
                     border.color: "#E1E5E9"
                     border.width: 1
@@ -855,7 +881,7 @@ Rectangle {
                         // Current Alignment Accuracy Display
                         Rectangle {
                             width: parent.width
-                            height: 45
+                            height: 60
                             color: "#F8F9FA"
                             radius: 6
                             border.color: "#E1E5E9"
@@ -885,6 +911,16 @@ Rectangle {
                                     font.family: "Consolas, Monaco, monospace"
                                     anchors.horizontalCenter: parent.horizontalCenter
                                 }
+
+                                // Image-space silhouette intersection over union
+                                Text {
+                                    text: "Silhouette overlap: " + (viewport3D.silhouetteOverlap < 0
+                                          ? "--" : (viewport3D.silhouetteOverlap * 100).toFixed(1) + "%")
+                                    font.pixelSize: 10
+                                    color: "#666666"
+                                    font.family: "Arial"
+                                    anchors.horizontalCenter: parent.horizontalCenter
+                                }
                             }
                         }
                     }
@@ -893,10 +929,10 @@ Rectangle {
                 // -----------------------------------------------------
                 // DISPLAY OPTIONS SECTION
                 // -----------------------------------------------------
-                // Toggle visibility of reference model, movable model, vertex labels
+                // Toggle visibility of reference model, movable model, vertex labels, heatmap
                 Rectangle {
                     width: parent.width
-                    height: 200
+                    height: 250
                     color: "#FFFFFF"
                     border.color: "#E1E5E9"
                     border.width: 1
@@ -1035,6 +1071,46 @@ Rectangle {
                                 onClicked: viewport3D.showVertexLabels = !viewport3D.showVertexLabels
                             }
                         }
+
+                        // Alignment Heatmap Toggle (Movable model colored by alignment error)
+                        Rectangle {
+                            width: parent.width
+                            height: 35
+                            color: viewport3D.alignmentHeatmap ? "#4A90E2" : "#F8F9FA"
+                            radius: 6
+                            border.color: "#4A90E2"
+                            border.width: 1
+
+                            Row {
+                                anchors.left: parent.left
+                                anchors.leftMargin: 12
+                                anchors.verticalCenter: parent.verticalCenter
+                                spacing: 8
+
+                                Rectangle {
+                                    width: 12
+                                    height: 12
+                                    radius: 6
+                                    color: viewport3D.alignmentHeatmap ? "#FFFFFF" : "transparent"
+                                    border.color: "#4A90E2"
+                                    border.width: 1
+                                    anchors.verticalCenter: parent.verticalCenter
+                                }
+
+                                Text {
+                                    text: "Show Alignment Heatmap"
+                                    color: viewport3D.alignmentHeatmap ? "#FFFFFF" : "#2E3440"
+                                    font.pixelSize: 11
+                                    font.family: "Arial"
+                                    anchors.verticalCenter: parent.verticalCenter
+                                }
+                            }
+
+                            MouseArea {
+                                anchors.fill: parent
+                                onClicked: viewport3D.alignmentHeatmap = !viewport3D.alignmentHeatmap
+                            }
+                        }
                     }
                 }
 
@@ -1247,5 +1323,17 @@ Rectangle {
             // Show the completion dialog
             taskCompletionMessage.visible = true
         }
+
+        function onModelLoadFailed(message) {
+            console.log("Model could not be loaded:", message)
+        }
+    }
+
+    // Model file selection for Stereo Image mode
+    FileDialog {
+        id: modelFileDialog
+        title: "Load Custom Model"
+        nameFilters: ["3D models (*.obj *.stl)", "Wavefront OBJ (*.obj)", "Binary STL (*.stl)"]
+        onAccepted: viewport3D.loadModel(selectedFile)
     }
-}
\ No newline at end of file
+}
@@ -0,0 +1,151 @@
+#include <QFloat16>
+#include <QTest>
+#include <cmath>
+#include <cstring>
+
+#include "CompactVertexFormat.hpp"
+
+class CompactVertexFormatTest : public QObject {
+    Q_OBJECT
+
+   private slots:
+    void testNormalRoundTrip();
+    void testChoosePositions();
+    void testPackVertices();
+    void testPackIndices();
+};
+
+// Flat quad grid of size x size cells with the given cell size, offset along X
+static void grid(int size, float cell, float offset, QVector<float>& vertices,
+                 QVector<unsigned int>& indices) {
+    for (int y = 0; y <= size; ++y) {
+        for (int x = 0; x <= size; ++x) {
+            vertices << offset + x * cell << y * cell << 0.0f << 0.0f << 0.0f << 1.0f;
+        }
+    }
+    for (int y = 0; y < size; ++y) {
+        for (int x = 0; x < size; ++x) {
+            const unsigned int corner = y * (size + 1) + x;
+            indices << corner << corner + 1 << corner + size + 2;
+            indices << corner << corner + size + 2 << corner + size + 1;
+        }
+    }
+}
+
+void CompactVertexFormatTest::testNormalRoundTrip() {
+    // Poles, axes, both hemispheres and the fold seam
+    const float normals[][3] = {
+        {0, 0, 1}, {0, 0, -1}, {1, 0, 0}, {0, -1, 0}, {1, 1, 1},
+        {-1, 2, -3}, {0.2f, -5, -1}, {3, -1, 0}, {-1, -1, -0.01f}, {0.01f, 0, -1},
+    };
+    for (const auto& source : normals) {
+        const float length = std::sqrt(source[0] * source[0] + source[1] * source[1] +
+                                       source[2] * source[2]);
+        const float unit[3] = {source[0] / length, source[1] / length, source[2] / length};
+
+        qint16 encoded[2];
+        CompactVertexFormat::encodeNormal(unit, encoded);
+        float decoded[3];
+        CompactVertexFormat::decodeNormal(encoded, decoded);
+
+        const float cosine = unit[0] * decoded[0] + unit[1] * decoded[1] + unit[2] * decoded[2];
+        QVERIFY2(cosine > 0.99999f, qPrintable(QString("(%1, %2, %3) -> (%4, %5, %6)")
+                                                   .arg(unit[0])
+                                                   .arg(unit[1])
+                                                   .arg(unit[2])
+                                                   .arg(decoded[0])
+                                                   .arg(decoded[1])
+                                                   .arg(decoded[2])));
+    }
+}
+
+void CompactVertexFormatTest::testChoosePositions() {
+    // Small part near the origin: half floats are plenty
+    QVector<float> vertices;
+    QVector<unsigned int> indices;
+    grid(8, 1.0f, 0.0f, vertices, indices);
+    QCOMPARE(CompactVertexFormat::choosePositions(vertices.constData(), 6, vertices.size() / 6,
+                                                  indices.constData(), indices.size()),
+             CompactVertexFormat::HalfPositions);
+
+    // Fine triangles far from the origin would be crushed
+    vertices.clear();
+    indices.clear();
+    grid(8, 0.01f, 1000.0f, vertices, indices);
+    QCOMPARE(CompactVertexFormat::choosePositions(vertices.constData(), 6, vertices.size() / 6,
+                                                  indices.constData(), indices.size()),
+             CompactVertexFormat::FloatPositions);
+
+    // Beyond the half float range
+    vertices.clear();
+    indices.clear();
+    grid(2, 50000.0f, 0.0f, vertices, indices);
+    QCOMPARE(CompactVertexFormat::choosePositions(vertices.constData(), 6, vertices.size() / 6,
+                                                  indices.constData(), indices.size()),
+             CompactVertexFormat::FloatPositions);
+}
+
+void CompactVertexFormatTest::testPackVertices() {
+    // Position and normal of two vertices
+    const float source[] = {
+        1.5f, -2.0f, 3.25f, 0.0f, 0.0f, 1.0f, -4.0f, 0.5f, 8.0f, 0.0f, -1.0f, 0.0f,
+    };
+
+    for (CompactVertexFormat::Positions format :
+         {CompactVertexFormat::FloatPositions, CompactVertexFormat::HalfPositions}) {
+        const int stride = CompactVertexFormat::stride(format);
+        const VertexLayout layout = CompactVertexFormat::layout(format);
+        QCOMPARE(int(layout.size()), 2);
+        QCOMPARE(int(layout[0].stride), stride);
+        QCOMPARE(int(layout[1].location), 1);
+        QCOMPARE(int(layout[1].components), 2);
+        QVERIFY(layout[1].offset % 4 == 0);
+
+        QByteArray packed(2 * stride, '\0');
+        CompactVertexFormat::pack(format, source, source + 3, 6, 2,
+                                  reinterpret_cast<uchar*>(packed.data()));
+
+        for (int vertex = 0; vertex < 2; ++vertex) {
+            const char* data = packed.constData() + vertex * stride;
+            float position[3];
+            if (format == CompactVertexFormat::HalfPositions) {
+                qfloat16 half[3];
+                std::memcpy(half, data, sizeof(half));
+                for (int axis = 0; axis < 3; ++axis) {
+                    position[axis] = float(half[axis]);
+                }
+            } else {
+                std::memcpy(position, data, sizeof(position));
+            }
+            qint16 encoded[2];
+            std::memcpy(encoded, data + layout[1].offset, sizeof(encoded));
+            float normal[3];
+            CompactVertexFormat::decodeNormal(encoded, normal);
+
+            for (int axis = 0; axis < 3; ++axis) {
+                // All source values are exact in half floats
+                QCOMPARE(position[axis], source[vertex * 6 + axis]);
+                QVERIFY(std::fabs(normal[axis] - source[vertex * 6 + 3 + axis]) < 1e-4f);
+            }
+        }
+    }
+}
+
+void CompactVertexFormatTest::testPackIndices() {
+    QCOMPARE(CompactVertexFormat::indexType(65536), GLenum(GL_UNSIGNED_SHORT));
+    QCOMPARE(CompactVertexFormat::indexType(65537), GLenum(GL_UNSIGNED_INT));
+
+    const unsigned int indices[] = {0, 1, 65535, 7};
+    quint16 shorts[4];
+    CompactVertexFormat::packIndices(indices, 4, GL_UNSIGNED_SHORT,
+                                     reinterpret_cast<uchar*>(shorts));
+    QCOMPARE(QVector<quint16>(shorts, shorts + 4), QVector<quint16>({0, 1, 65535, 7}));
+
+    quint32 ints[4];
+    CompactVertexFormat::packIndices(indices, 4, GL_UNSIGNED_INT,
+                                     reinterpret_cast<uchar*>(ints));
+    QCOMPARE(QVector<quint32>(ints, ints + 4), QVector<quint32>({0, 1, 65535, 7}));
+}
+
+QTEST_APPLESS_MAIN(CompactVertexFormatTest)
+#include "CompactVertexFormat_test.moc"
@@ -0,0 +1,131 @@
+#include <QTest>
+#include <algorithm>
+#include <random>
+
+#include "MeshOptimizer.hpp"
+
+class MeshOptimizerTest : public QObject {
+    Q_OBJECT
+
+   private slots:
+    void testAcmr();
+    void testVertexCacheImprovesShuffledGrid();
+    void testVertexCacheKeepsTriangles();
+    void testVertexFetchOrder();
+    void testOptimizeMesh();
+};
+
+// Grid of size x size quads in the XY plane, triangles in random order
+static MeshData shuffledGrid(int size) {
+    MeshData mesh;
+    for (int y = 0; y <= size; ++y) {
+        for (int x = 0; x <= size; ++x) {
+            mesh.positions << float(x) << float(y) << 0.0f;
+        }
+    }
+
+    QVector<QVector<unsigned int>> triangles;
+    for (int y = 0; y < size; ++y) {
+        for (int x = 0; x < size; ++x) {
+            unsigned int corner = y * (size + 1) + x;
+            triangles.append({corner, corner + 1, corner + size + 2});
+            triangles.append({corner, corner + size + 2, corner + size + 1});
+        }
+    }
+    std::shuffle(triangles.begin(), triangles.end(), std::mt19937(1));
+    for (const QVector<unsigned int>& triangle : triangles) {
+        mesh.indices << triangle;
+    }
+    mesh.computeNormals();
+    return mesh;
+}
+
+// Triangles as sorted position triples, each rotated to start at its smallest corner so
+// that the winding is part of the comparison
+static QVector<QVector<float>> triangleSet(const MeshData& mesh) {
+    QVector<QVector<float>> triangles;
+    for (int triangle = 0; triangle < mesh.triangleCount(); ++triangle) {
+        QVector<QVector<float>> corners;
+        for (int corner = 0; corner < 3; ++corner) {
+            const unsigned int vertex = mesh.indices[triangle * 3 + corner];
+            const float* position = mesh.positions.constData() + vertex * 3;
+            corners.append({position[0], position[1], position[2]});
+        }
+        std::rotate(corners.begin(), std::min_element(corners.begin(), corners.end()),
+                    corners.end());
+        triangles.append(corners[0] + corners[1] + corners[2]);
+    }
+    std::sort(triangles.begin(), triangles.end());
+    return triangles;
+}
+
+void MeshOptimizerTest::testAcmr() {
+    // Every vertex shaded once, then all hits
+    const unsigned int strip[] = {0, 1, 2, 2, 1, 3, 2, 3, 4};
+    QCOMPARE(MeshOptimizer::acmr(strip, 9, 5), 5.0 / 3.0);
+    // Vertex 0 is evicted from a two-entry cache before its reuse
+    const unsigned int fan[] = {0, 1, 2, 0, 2, 3};
+    QCOMPARE(MeshOptimizer::acmr(fan, 6, 4, 2), 5.0 / 2.0);
+    QCOMPARE(MeshOptimizer::acmr(fan, 6, 4, 3), 4.0 / 2.0);
+    QCOMPARE(MeshOptimizer::acmr(fan, 0, 4), 0.0);
+}
+
+void MeshOptimizerTest::testVertexCacheImprovesShuffledGrid() {
+    MeshData mesh = shuffledGrid(64);
+    const double before = MeshOptimizer::acmr(mesh.indices.constData(), mesh.indices.size(),
+                                              mesh.vertexCount());
+    QVERIFY(before > 2.5);
+
+    MeshOptimizer::optimizeVertexCache(mesh.indices.data(), mesh.indices.size(),
+                                       mesh.vertexCount());
+    const double after = MeshOptimizer::acmr(mesh.indices.constData(), mesh.indices.size(),
+                                             mesh.vertexCount());
+    QVERIFY2(after < 0.8, qPrintable(QString("ACMR %1 -> %2").arg(before).arg(after)));
+}
+
+void MeshOptimizerTest::testVertexCacheKeepsTriangles() {
+    MeshData mesh = shuffledGrid(16);
+    // A degenerate triangle and an unreferenced vertex must not confuse it either
+    mesh.indices << 0 << 0 << 1;
+    mesh.positions << 100.0f << 100.0f << 100.0f;
+    const QVector<QVector<float>> before = triangleSet(mesh);
+
+    MeshOptimizer::optimizeVertexCache(mesh.indices.data(), mesh.indices.size(),
+                                       mesh.vertexCount());
+    QCOMPARE(triangleSet(mesh), before);
+}
+
+void MeshOptimizerTest::testVertexFetchOrder() {
+    unsigned int indices[] = {4, 2, 0, 0, 2, 1};
+    QVector<unsigned int> remap = MeshOptimizer::optimizeVertexFetch(indices, 6, 5);
+
+    // First use order, then the unreferenced vertex 3
+    QCOMPARE(remap, QVector<unsigned int>({2, 3, 1, 4, 0}));
+    QCOMPARE(QVector<unsigned int>(indices, indices + 6),
+             QVector<unsigned int>({0, 1, 2, 2, 1, 3}));
+
+    QVector<float> vertices = {0, 0, 1, 1, 2, 2, 3, 3, 4, 4};
+    MeshOptimizer::remapVertices(vertices.data(), 2, 5, remap);
+    QCOMPARE(vertices, QVector<float>({4, 4, 2, 2, 0, 0, 1, 1, 3, 3}));
+}
+
+void MeshOptimizerTest::testOptimizeMesh() {
+    MeshData mesh = shuffledGrid(32);
+    const QVector<QVector<float>> before = triangleSet(mesh);
+    MeshOptimizer::optimize(mesh);
+
+    QCOMPARE(triangleSet(mesh), before);
+    // Normals moved with their positions (all +Z for a flat grid)
+    for (int vertex = 0; vertex < mesh.vertexCount(); ++vertex) {
+        QCOMPARE(mesh.normals[vertex * 3 + 2], 1.0f);
+    }
+    // Indices walk the vertex buffer forward
+    unsigned int next = 0;
+    for (unsigned int index : mesh.indices) {
+        QVERIFY(index <= next);
+        next = qMax(next, index + 1);
+    }
+}
+
+QTEST_APPLESS_MAIN(MeshOptimizerTest)
+#include "MeshOptimizer_test.moc"
@@ -0,0 +1,192 @@
+#include <QFile>
+#include <QTemporaryDir>
+#include <QTest>
+
+#include "ObjLoader.hpp"
+
+class ObjLoaderTest : public QObject {
+    Q_OBJECT
+
+   private slots:
+    void testTriangle();
+    void testPolygonFan();
+    void testCornerForms();
+    void testNegativeIndices();
+    void testChunkSizeDoesNotMatter();
+    void testComputedNormals();
+    void testPerFaceNormals();
+    void testMalformedLine();
+    void testMissingVertex();
+    void testCancel();
+    void testLoadFile();
+};
+
+static bool parseText(const QByteArray& text, MeshData& mesh, QString* error = nullptr,
+                      qint64 chunkSize = ObjLoader::ChunkSize) {
+    return ObjLoader::parse(text.constData(), text.size(), mesh, error,
+                            ObjLoader::ProgressCallback(), chunkSize);
+}
+
+void ObjLoaderTest::testTriangle() {
+    MeshData mesh;
+    QVERIFY(parseText("# triangle\nv 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 3\n", mesh));
+
+    QCOMPARE(mesh.vertexCount(), 3);
+    QCOMPARE(mesh.triangleCount(), 1);
+    QCOMPARE(mesh.indices, QVector<unsigned int>({0, 1, 2}));
+    QCOMPARE(mesh.positions[3], 1.0f);
+    QCOMPARE(mesh.normals.size(), mesh.positions.size());
+}
+
+void ObjLoaderTest::testPolygonFan() {
+    MeshData mesh;
+    QVERIFY(parseText("v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\nv -1 1 0\nf 1 2 3 4 5\n", mesh));
+
+    QCOMPARE(mesh.triangleCount(), 3);
+    QCOMPARE(mesh.indices, QVector<unsigned int>({0, 1, 2, 0, 2, 3, 0, 3, 4}));
+}
+
+void ObjLoaderTest::testCornerForms() {
+    // Texture coordinates are skipped, file normals are kept
+    MeshData mesh;
+    QVERIFY(parseText("v 0 0 0\r\nv 1 0 0\r\nv 0 1 0\r\nvt 0 0\r\nvn 0 0 -1\r\n"
+                      "f 1/1/1 2//1 3/1/1\r\n",
+                      mesh));
+
+    QCOMPARE(mesh.triangleCount(), 1);
+    QCOMPARE(mesh.normals[2], -1.0f);
+    QCOMPARE(mesh.normals[5], -1.0f);
+    // The third corner has no normal of its own, so all normals are computed
+    MeshData computed;
+    QVERIFY(parseText("v 0 0 0\nv 1 0 0\nv 0 1 0\nvn 0 0 -1\nf 1//1 2//1 3\n", computed));
+    QCOMPARE(computed.normals[2], 1.0f);
+}
+
+void ObjLoaderTest::testNegativeIndices() {
+    MeshData mesh;
+    QVERIFY(parseText("v 0 0 0\nv 1 0 0\nv 0 1 0\nf -3 -2 -1\n"
+                      "v 5 0 0\nv 6 0 0\nv 5 1 0\nf -3 -2 -1\nf 1 -2 -1\n",
+                      mesh));
+
+    QCOMPARE(mesh.indices, QVector<unsigned int>({0, 1, 2, 3, 4, 5, 0, 4, 5}));
+}
+
+void ObjLoaderTest::testChunkSizeDoesNotMatter() {
+    // Relative indices and normals reaching back into earlier chunks
+    QByteArray text;
+    for (int quad = 0; quad < 50; ++quad) {
+        text += QByteArray("v ") + QByteArray::number(quad) + " 0 0\n";
+        text += QByteArray("v ") + QByteArray::number(quad) + " 1 0\n";
+        text += QByteArray("v ") + QByteArray::number(quad) + ".5 1 1.5e-1\n";
+        text += "vn 0 0 1\n";
+        text += "f -3//-1 -2//-1 -1//-1\n";
+        if (quad > 0) {
+            text += "f -4//1 -3//1 -6//-1 -5//-1\n";
+        }
+    }
+
+    MeshData reference;
+    QVERIFY(parseText(text, reference));
+    QCOMPARE(reference.vertexCount(), 150);
+    QCOMPARE(reference.triangleCount(), 50 + 49 * 2);
+
+    for (qint64 chunkSize : {1, 7, 64, 500}) {
+        MeshData mesh;
+        QVERIFY(parseText(text, mesh, nullptr, chunkSize));
+        QCOMPARE(mesh.positions, reference.positions);
+        QCOMPARE(mesh.normals, reference.normals);
+        QCOMPARE(mesh.indices, reference.indices);
+    }
+}
+
+void ObjLoaderTest::testComputedNormals() {
+    // Counter-clockwise in the XY plane faces +Z
+    MeshData mesh;
+    QVERIFY(parseText("v 0 0 0\nv 2 0 0\nv 0 2 0\nf 1 2 3\n", mesh));
+
+    for (int vertex = 0; vertex < 3; ++vertex) {
+        QCOMPARE(mesh.normals[vertex * 3], 0.0f);
+        QCOMPARE(mesh.normals[vertex * 3 + 1], 0.0f);
+        QCOMPARE(mesh.normals[vertex * 3 + 2], 1.0f);
+    }
+}
+
+void ObjLoaderTest::testPerFaceNormals() {
+    // Flat shaded cube: every corner position is shared by three faces with other normals
+    MeshData mesh;
+    QVERIFY(parseText("v -1 -1 -1\nv 1 -1 -1\nv 1 1 -1\nv -1 1 -1\n"
+                      "v -1 -1 1\nv 1 -1 1\nv 1 1 1\nv -1 1 1\n"
+                      "vn 0 0 -1\nvn 0 0 1\nvn 0 -1 0\nvn 0 1 0\nvn -1 0 0\nvn 1 0 0\n"
+                      "f 1//1 4//1 3//1 2//1\nf 5//2 6//2 7//2 8//2\nf 1//3 2//3 6//3 5//3\n"
+                      "f 4//4 8//4 7//4 3//4\nf 1//5 5//5 8//5 4//5\nf 2//6 3//6 7//6 6//6\n",
+                      mesh));
+
+    QCOMPARE(mesh.vertexCount(), 24);
+    QCOMPARE(mesh.triangleCount(), 12);
+    // Every corner keeps the normal of its own face, which points at it from the center
+    for (unsigned int vertex : mesh.indices) {
+        const float* position = mesh.positions.constData() + vertex * 3;
+        const float* normal = mesh.normals.constData() + vertex * 3;
+        QCOMPARE(position[0] * normal[0] + position[1] * normal[1] + position[2] * normal[2],
+                 1.0f);
+    }
+}
+
+void ObjLoaderTest::testMalformedLine() {
+    MeshData mesh;
+    QString error;
+    QVERIFY(!parseText("v 0 0 0\nv 1 0 0\nv 0 x 0\nf 1 2 3\n", mesh, &error, 4));
+    QVERIFY(error.startsWith("Line 3:"));
+    QVERIFY(mesh.isEmpty());
+
+    QVERIFY(!parseText("v 0 0 0\nv 1 0 0\nf 1 2\n", mesh, &error));
+    QVERIFY(!parseText("v 0 0 0\nv 1 0 0\nv 0 1 0\nf 0 1 2\n", mesh, &error));
+    QVERIFY(!parseText("# no faces\nv 0 0 0\n", mesh, &error));
+}
+
+void ObjLoaderTest::testMissingVertex() {
+    MeshData mesh;
+    QString error;
+    QVERIFY(!parseText("v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 4\n", mesh, &error));
+    QVERIFY(!parseText("v 0 0 0\nf -1 -2 -3\n", mesh, &error));
+    QVERIFY(mesh.isEmpty());
+}
+
+void ObjLoaderTest::testCancel() {
+    QByteArray text = "v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 3\n";
+    MeshData mesh;
+    QVERIFY(!ObjLoader::parse(text.constData(), text.size(), mesh, nullptr,
+                              [](double) { return false; }));
+    QVERIFY(mesh.isEmpty());
+
+    double lastProgress = 0.0;
+    QVERIFY(ObjLoader::parse(text.constData(), text.size(), mesh, nullptr,
+                             [&lastProgress](double progress) {
+                                 lastProgress = progress;
+                                 return true;
+                             }));
+    QCOMPARE(lastProgress, 1.0);
+}
+
+void ObjLoaderTest::testLoadFile() {
+    QTemporaryDir directory;
+    QVERIFY(directory.isValid());
+    const QString path = directory.filePath("quad.obj");
+    QFile file(path);
+    QVERIFY(file.open(QIODevice::WriteOnly));
+    file.write("o quad\nv -1 -1 0\nv 1 -1 0\nv 1 1 0\nv -1 1 0\nvn 0 0 1\n"
+               "usemtl none\ns off\nf 1//1 2//1 3//1 4//1\n");
+    file.close();
+
+    MeshData mesh;
+    QVERIFY(ObjLoader::load(path, mesh));
+    QCOMPARE(mesh.vertexCount(), 4);
+    QCOMPARE(mesh.triangleCount(), 2);
+
+    QString error;
+    QVERIFY(!ObjLoader::load(directory.filePath("missing.obj"), mesh, &error));
+    QVERIFY(!error.isEmpty());
+}
+
+QTEST_APPLESS_MAIN(ObjLoaderTest)
+#include "ObjLoader_test.moc"
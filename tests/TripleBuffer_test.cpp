@@ -0,0 +1,89 @@
+#include <QTest>
+#include <QThread>
+
+#include "TripleBuffer.hpp"
+
+class TripleBufferTest : public QObject {
+    Q_OBJECT
+
+   private slots:
+    void testNothingPublished();
+    void testLatestValueWins();
+    void testReadBufferIsKept();
+    void testConcurrentProducer();
+};
+
+void TripleBufferTest::testNothingPublished() {
+    TripleBuffer<int> buffer;
+    QVERIFY(!buffer.consume());
+}
+
+void TripleBufferTest::testLatestValueWins() {
+    TripleBuffer<int> buffer;
+    buffer.publish(1);
+    buffer.publish(2);
+    buffer.writeBuffer() = 3;
+    buffer.publish();
+
+    QVERIFY(buffer.consume());
+    QCOMPARE(buffer.readBuffer(), 3);
+}
+
+void TripleBufferTest::testReadBufferIsKept() {
+    TripleBuffer<int> buffer;
+    buffer.publish(7);
+    QVERIFY(buffer.consume());
+
+    // Nothing new: the consumer keeps reading the same value
+    QVERIFY(!buffer.consume());
+    QCOMPARE(buffer.readBuffer(), 7);
+
+    // The producer never writes into the slot being read
+    buffer.publish(8);
+    QCOMPARE(buffer.readBuffer(), 7);
+    QVERIFY(buffer.consume());
+    QCOMPARE(buffer.readBuffer(), 8);
+}
+
+void TripleBufferTest::testConcurrentProducer() {
+    // Each value carries a checksum, so a torn read shows up as a mismatch
+    struct Snapshot {
+        int value = 0;
+        int check = 0;
+    };
+    const int count = 200000;
+
+    TripleBuffer<Snapshot> buffer;
+    QThread* producer = QThread::create([&buffer, count]() {
+        for (int i = 1; i <= count; ++i) {
+            Snapshot& snapshot = buffer.writeBuffer();
+            snapshot.value = i;
+            snapshot.check = -i;
+            buffer.publish();
+        }
+    });
+    producer->start();
+
+    // Checked after the producer finished, so a failure never leaves it running
+    int last = 0;
+    bool consistent = true;
+    bool increasing = true;
+    while (last < count) {
+        if (!buffer.consume()) {
+            continue;
+        }
+        const Snapshot& snapshot = buffer.readBuffer();
+        consistent = consistent && snapshot.check == -snapshot.value;
+        increasing = increasing && snapshot.value > last;
+        last = snapshot.value;
+    }
+
+    producer->wait();
+    delete producer;
+    QVERIFY(consistent);
+    QVERIFY(increasing);
+}
+
+QTEST_APPLESS_MAIN(TripleBufferTest)
+
+#include "TripleBuffer_test.moc"